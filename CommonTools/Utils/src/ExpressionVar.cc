@@ -28,13 +28,50 @@ ExpressionVar::Objects ExpressionVar::initObjects_() const {
   return objects;
 }
 
+namespace {
+  // storage for the value returned by a method, if it is a fundamental type, an enum or a pointer
+  union StackSlot {
+    long double fundamental;
+    void* pointer;
+  };
+  constexpr unsigned int kMaxStackMethods = 8;
+}  // namespace
+
+void ExpressionVar::initStackTypes_() {
+  if (methods_.size() > kMaxStackMethods) {
+    return;
+  }
+  std::vector<edm::TypeWithDict> types;
+  types.reserve(methods_.size());
+  for (auto const& method : methods_) {
+    if (method.isFunction()) {
+      edm::TypeWithDict retType = method.method().finalReturnType();
+      bool onStack = retType.isPointer() || retType.isReference() ||
+                     ((retType.isFundamental() || retType.isEnum()) && retType.size() <= sizeof(StackSlot));
+      if (!onStack) {
+        return;
+      }
+      types.push_back(retType);
+    } else {
+      types.push_back(edm::TypeWithDict());
+    }
+  }
+  stackTypes_ = std::move(types);
+}
+
 ExpressionVar::ExpressionVar(const vector<MethodInvoker>& methods, method::TypeCode retType)
     : methods_(methods), retType_(retType) {
-  returnObjects(initObjects_());
+  initStackTypes_();
+  if (stackTypes_.empty()) {
+    returnObjects(initObjects_());
+  }
 }
 
-ExpressionVar::ExpressionVar(const ExpressionVar& rhs) : methods_(rhs.methods_), retType_(rhs.retType_) {
-  returnObjects(initObjects_());
+ExpressionVar::ExpressionVar(const ExpressionVar& rhs)
+    : methods_(rhs.methods_), retType_(rhs.retType_), stackTypes_(rhs.stackTypes_) {
+  if (stackTypes_.empty()) {
+    returnObjects(initObjects_());
+  }
 }
 
 ExpressionVar::Objects ExpressionVar::borrowObjects() const {
@@ -136,7 +173,22 @@ bool ExpressionVar::isValidReturnType(method::TypeCode retType) {
   return ret;
 }
 
+double ExpressionVar::valueOnStack(const edm::ObjectWithDict& obj) const {
+  // no destructor to call and nothing shared between threads: the queue of storage objects is not needed
+  StackSlot slots[kMaxStackMethods];
+  edm::ObjectWithDict val(obj);
+  for (unsigned int i = 0; i < methods_.size(); ++i) {
+    edm::ObjectWithDict store =
+        methods_[i].isFunction() ? edm::ObjectWithDict(stackTypes_[i], &slots[i]) : edm::ObjectWithDict();
+    val = methods_[i].invoke(val, store);
+  }
+  return objToDouble(val, retType_);
+}
+
 double ExpressionVar::value(const edm::ObjectWithDict& obj) const {
+  if (!stackTypes_.empty()) {
+    return valueOnStack(obj);
+  }
   edm::ObjectWithDict val(obj);
   auto objects = borrowObjects();
   auto IO = objects.begin();
@@ -17,19 +17,29 @@
 #include <vector>
 #include <oneapi/tbb/concurrent_queue.h>
 
+class testExpressionParser;
+
 namespace reco {
   namespace parser {
 
     /// Evaluate an object's method or datamember (or chain of them) to get a number
     class ExpressionVar : public ExpressionBase {
+      // For tests
+      friend class ::testExpressionParser;
+
     private:  // Private Data Members
       std::vector<MethodInvoker> methods_;
       using Objects = std::vector<std::pair<edm::ObjectWithDict, bool>>;
       mutable oneapi::tbb::concurrent_queue<Objects> objectsCache_;
       method::TypeCode retType_;
+      /// types of the values returned by the methods, if they can all be stored on the stack
+      /// (fundamental types, enums or pointers); empty otherwise
+      std::vector<edm::TypeWithDict> stackTypes_;
 
     private:  // Private Methods
       [[nodiscard]] Objects initObjects_() const;
+      void initStackTypes_();
+      double valueOnStack(const edm::ObjectWithDict&) const;
 
       Objects borrowObjects() const;
       void returnObjects(Objects&&) const;
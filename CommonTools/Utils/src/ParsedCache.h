@@ -0,0 +1,28 @@
+#ifndef CommonTools_Utils_ParsedCache_h
+#define CommonTools_Utils_ParsedCache_h
+#include "FWCore/Utilities/interface/hash_combine.h"
+
+#include "oneapi/tbb/concurrent_unordered_map.h"
+
+#include <string>
+#include <tuple>
+
+namespace reco {
+  namespace parser {
+    /// the name of the type, the lazy flag and the string of a parsed cut or expression
+    using ParsedKey = std::tuple<std::string, bool, std::string>;
+
+    struct ParsedKeyHash {
+      std::size_t operator()(const ParsedKey& key) const {
+        return edm::hash_value(std::get<0>(key), std::get<1>(key), std::get<2>(key));
+      }
+    };
+
+    /// The parsed cuts and expressions are immutable and can be evaluated concurrently,
+    /// so the modules using the same string on the same type can share a single one.
+    template <typename Ptr>
+    using ParsedCache = oneapi::tbb::concurrent_unordered_map<ParsedKey, Ptr, ParsedKeyHash>;
+  }  // namespace parser
+}  // namespace reco
+
+#endif
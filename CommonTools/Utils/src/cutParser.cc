@@ -1,9 +1,17 @@
 #include "CommonTools/Utils/interface/cutParser.h"
 #include "CommonTools/Utils/src/AnyObjSelector.h"
 #include "CommonTools/Utils/interface/parser/Grammar.h"
+#include "CommonTools/Utils/src/ParsedCache.h"
 #include "FWCore/Utilities/interface/EDMException.h"
 
 using namespace reco::parser;
+
+namespace {
+  // shared by the modules using the same cut on the same type (e.g. the many NanoAOD tables)
+  // (never deleted, so that no selector outlives the dictionaries at exit)
+  auto& parsedCuts = *new ParsedCache<SelectorPtr>();
+}  // namespace
+
 bool reco::parser::cutParser(const edm::TypeWithDict& t, const std::string& cut, SelectorPtr& sel, bool lazy = false) {
   bool justBlanks = true;
   for (std::string::const_iterator c = cut.begin(); c != cut.end(); ++c) {
@@ -16,6 +24,12 @@ bool reco::parser::cutParser(const edm::TypeWithDict& t, const std::string& cut,
     sel = SelectorPtr(new AnyObjSelector);
     return true;
   } else {
+    const ParsedKey key(t.name(), lazy, cut);
+    auto found = parsedCuts.find(key);
+    if (found != parsedCuts.end()) {
+      sel = found->second;
+      return true;
+    }
     using namespace boost::spirit::classic;
     Grammar grammar(sel, t, lazy);
     bool returnValue = false;
@@ -27,6 +41,9 @@ bool reco::parser::cutParser(const edm::TypeWithDict& t, const std::string& cut,
           << "Cut parser error:" << baseExceptionWhat(e) << " (char " << e.where - startingFrom << ")\n"
           << "Cut string was " << cut;
     }
+    if (returnValue) {
+      sel = parsedCuts.insert(std::make_pair(key, sel)).first->second;
+    }
     return returnValue;
   }
 }
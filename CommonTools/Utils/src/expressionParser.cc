@@ -1,13 +1,26 @@
 #include "CommonTools/Utils/interface/parser/Grammar.h"
 #include "FWCore/Utilities/interface/EDMException.h"
 #include "CommonTools/Utils/interface/expressionParser.h"
+#include "CommonTools/Utils/src/ParsedCache.h"
 
 using namespace reco::parser;
 
+namespace {
+  // shared by the modules using the same expression on the same type
+  // (never deleted, so that no expression outlives the dictionaries at exit)
+  auto& parsedExpressions = *new ParsedCache<ExpressionPtr>();
+}  // namespace
+
 bool reco::parser::expressionParser(const edm::TypeWithDict& t,
                                     const std::string& value,
                                     ExpressionPtr& expr,
                                     bool lazy) {
+  const ParsedKey key(t.name(), lazy, value);
+  auto found = parsedExpressions.find(key);
+  if (found != parsedExpressions.end()) {
+    expr = found->second;
+    return true;
+  }
   using namespace boost::spirit::classic;
   Grammar grammar(expr, t, lazy);
   bool returnValue = false;
@@ -18,5 +31,8 @@ bool reco::parser::expressionParser(const edm::TypeWithDict& t,
     throw edm::Exception(edm::errors::Configuration)
         << "Expression parser error:" << baseExceptionWhat(e) << " (char " << e.where - startingFrom << ")\n";
   }
+  if (returnValue) {
+    expr = parsedExpressions.insert(std::make_pair(key, expr)).first->second;
+  }
   return returnValue;
 }
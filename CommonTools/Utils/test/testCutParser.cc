@@ -29,12 +29,14 @@ public:
 class testCutParser : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(testCutParser);
   CPPUNIT_TEST(checkAll);
+  CPPUNIT_TEST(checkCache);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void setUp() {}
   void tearDown() {}
   void checkAll();
+  void checkCache();
   void check(const std::string &, bool);
   void checkHit(const std::string &, bool, const SiStripRecHit2D &);
   void checkMuon(const std::string &, bool, const reco::Muon &);
@@ -246,3 +248,36 @@ void testCutParser::checkAll() {
   checkHit("!hasPositionAndError || (localPosition.x = 1)", true, hitOk);
   checkHit("!hasPositionAndError || (localPosition.x = 1)", true, hitThrow);
 }
+
+void testCutParser::checkCache() {
+  reco::TrackBase::CovarianceMatrix cov;
+  trk = reco::Track(20.0, 10, reco::Track::Point(1, 2, 3), reco::Track::Vector(0, 3, 10), -1, cov);
+  o = edm::ObjectWithDict(edm::TypeWithDict(typeid(reco::Track)), &trk);
+
+  // the same cut on the same type is parsed once, and shared by all the selectors
+  reco::parser::SelectorPtr first, second;
+  CPPUNIT_ASSERT(reco::parser::cutParser<reco::Track>("pt > 1 && charge < 0", first, false));
+  CPPUNIT_ASSERT(reco::parser::cutParser<reco::Track>("pt > 1 && charge < 0", second, false));
+  CPPUNIT_ASSERT(first.get() != nullptr);
+  CPPUNIT_ASSERT(first.get() == second.get());
+  CPPUNIT_ASSERT((*first)(o));
+  StringCutObjectSelector<reco::Track> select1("pt > 1 && charge < 0"), select2("pt > 1 && charge < 0");
+  CPPUNIT_ASSERT(select1(trk) && select2(trk));
+
+  // but not across types or parsing modes
+  reco::parser::SelectorPtr lazy, other;
+  CPPUNIT_ASSERT(reco::parser::cutParser<reco::Track>("pt > 1 && charge < 0", lazy, true));
+  CPPUNIT_ASSERT(lazy.get() != first.get());
+  CPPUNIT_ASSERT(reco::parser::cutParser<reco::Muon>("pt > 1 && charge < 0", other, false));
+  CPPUNIT_ASSERT(other.get() != first.get());
+
+  // a cut whose string could be confused with the lazy flag is parsed on its own, and fails
+  reco::parser::SelectorPtr confused;
+  bool parsed = false;
+  try {
+    parsed = reco::parser::cutParser<reco::Track>("lazy|pt > 1 && charge < 0", confused, false);
+  } catch (cms::Exception const &) {
+  }
+  CPPUNIT_ASSERT(not parsed);
+  CPPUNIT_ASSERT(confused.get() != lazy.get());
+}
@@ -8,8 +8,11 @@
 #include "DataFormats/PatCandidates/interface/Jet.h"
 #include "DataFormats/PatCandidates/interface/Muon.h"
 #include "CommonTools/Utils/interface/StringToEnumValue.h"
+#include "CommonTools/Utils/src/ExpressionVar.h"
 
 #include <iostream>
+#include <string>
+#include <vector>
 #include "FWCore/Reflection/interface/ObjectWithDict.h"
 #include "FWCore/Reflection/interface/TypeWithDict.h"
 #include <typeinfo>
@@ -19,6 +22,8 @@ class testExpressionParser : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(testExpressionParser);
   CPPUNIT_TEST(testStringToEnum);
   CPPUNIT_TEST(checkAll);
+  CPPUNIT_TEST(checkCache);
+  CPPUNIT_TEST(checkStackStorage);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -26,6 +31,8 @@ public:
   void tearDown() {}
   void checkAll();
   void testStringToEnum();
+  void checkCache();
+  void checkStackStorage();
   void checkTrack(const std::string &, double);
   void checkCandidate(const std::string &, double, bool lazy = false);
   void checkJet(const std::string &, double);
@@ -280,3 +287,65 @@ void testExpressionParser::checkAll() {
     checkMuon("overlaps('test')[0].pt", muon.overlaps("test")[0]->pt());
   }
 }
+
+void testExpressionParser::checkCache() {
+  // the same expression on the same type is parsed once, and shared
+  reco::parser::ExpressionPtr first, second;
+  CPPUNIT_ASSERT(reco::parser::expressionParser<reco::Track>("pt + charge", first, false));
+  CPPUNIT_ASSERT(reco::parser::expressionParser<reco::Track>("pt + charge", second, false));
+  CPPUNIT_ASSERT(first.get() != nullptr);
+  CPPUNIT_ASSERT(first.get() == second.get());
+  StringObjectFunction<reco::Track> f1("pt + charge"), f2("pt + charge");
+  CPPUNIT_ASSERT(f1(trk) == f2(trk));
+
+  // but not across types or parsing modes
+  reco::parser::ExpressionPtr lazy, other;
+  CPPUNIT_ASSERT(reco::parser::expressionParser<reco::Track>("pt + charge", lazy, true));
+  CPPUNIT_ASSERT(lazy.get() != first.get());
+  CPPUNIT_ASSERT(reco::parser::expressionParser<reco::Candidate>("pt + charge", other, false));
+  CPPUNIT_ASSERT(other.get() != first.get());
+  CPPUNIT_ASSERT(other.get() != lazy.get());
+}
+
+void testExpressionParser::checkStackStorage() {
+  // a chain of candidates, each one the only daughter of the next one, with pt = 1, 2, ... 10
+  reco::LeafCandidate leaf(+1, reco::Candidate::LorentzVector(0.5, 0, 0, 1));
+  std::vector<reco::CompositeCandidate> chain(10);
+  for (unsigned int i = 0; i < chain.size(); ++i) {
+    chain[i].setP4(reco::Candidate::LorentzVector(i + 1, 0, 0, i + 2));
+    if (i == 0)
+      chain[i].addDaughter(leaf);
+    else
+      chain[i].addDaughter(chain[i - 1]);
+  }
+  edm::TypeWithDict t(typeid(reco::Candidate));
+  o = edm::ObjectWithDict(t, &chain.back());
+
+  auto check = [this](const std::string &expression, double x, bool onStack) {
+    std::cerr << "checking expression: \"" << expression << "\"" << std::endl;
+    expr.reset();
+    CPPUNIT_ASSERT(reco::parser::expressionParser<reco::Candidate>(expression, expr, false));
+    auto const *var = dynamic_cast<reco::parser::ExpressionVar const *>(expr.get());
+    CPPUNIT_ASSERT(var != nullptr);
+    CPPUNIT_ASSERT_EQUAL(onStack, not var->stackTypes_.empty());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(x, var->value(o), 1.e-6);
+  };
+  auto daughters = [](unsigned int n) {
+    std::string expression;
+    for (unsigned int i = 0; i < n; ++i)
+      expression += "daughter(0).";
+    return expression;
+  };
+
+  // methods returning fundamental types or pointers keep their values on the stack
+  check("pt", 10, true);
+  check("numberOfDaughters", 1, true);
+  check(daughters(1) + "pt", 9, true);
+  // 8 methods, the most that are kept on the stack
+  check(daughters(7) + "pt", 3, true);
+  // more than 8 methods, or a method returning a class by value, fall back to the allocated storage
+  check(daughters(8) + "pt", 2, false);
+  check(daughters(10) + "pt", leaf.pt(), false);
+  check("momentum.x", 10, false);
+  check(daughters(1) + "momentum.x", 9, false);
+}
@@ -19,6 +19,7 @@
 #include "CondFormats/GBRForest/interface/GBRTree.h"
 
 #include <cmath>
+#include <cstddef>
 #include <vector>
 
 class GBRForest {
@@ -26,6 +27,10 @@ public:
   GBRForest() {}
 
   double GetResponse(const float* vector) const;
+  // Responses for n input vectors stored with the given stride (number of floats between
+  // consecutive vectors); identical to n calls of GetResponse, but evaluated tree by tree
+  // so that each tree is read once for the whole batch
+  void GetResponse(const float* vectors, size_t n, size_t stride, double* out) const;
   double GetGradBoostClassifier(const float* vector) const;
   double GetAdaBoostClassifier(const float* vector) const { return GetResponse(vector); }
 
@@ -53,6 +58,15 @@ inline double GBRForest::GetResponse(const float* vector) const {
   return response;
 }
 
+//_______________________________________________________________________
+inline void GBRForest::GetResponse(const float* vectors, size_t n, size_t stride, double* out) const {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = fInitialResponse;
+  for (auto const& tree : fTrees) {
+    tree.AddResponse(vectors, n, stride, out);
+  }
+}
+
 //_______________________________________________________________________
 inline double GBRForest::GetGradBoostClassifier(const float* vector) const {
   double response = GetResponse(vector);
@@ -24,6 +24,8 @@
 
 #include "CondFormats/Serialization/interface/Serializable.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
 class GBRTree {
@@ -33,6 +35,11 @@ public:
 
   double GetResponse(const float *vector) const;
 
+  // Adds the responses for n input vectors, stored with the given stride, to out[0..n).
+  // Several vectors are walked through the tree in lockstep, which hides the latency
+  // of the dependent node loads of a single traversal.
+  void AddResponse(const float *vectors, size_t n, size_t stride, double *out) const;
+
   std::vector<float> &Responses() { return fResponses; }
   const std::vector<float> &Responses() const { return fResponses; }
 
@@ -70,4 +77,34 @@ inline double GBRTree::GetResponse(const float *vector) const {
   return fResponses[-index];
 }
 
+//_______________________________________________________________________
+inline void GBRTree::AddResponse(const float *vectors, size_t n, size_t stride, double *out) const {
+  constexpr size_t kLanes = 8;
+  auto step = [this](int index, const float *vector) {
+    auto r = fRightIndices[index];
+    auto l = fLeftIndices[index];
+    unsigned int x = vector[fCutIndices[index]] > fCutVals[index] ? ~0 : 0;
+    return int((x & r) | ((~x) & l));
+  };
+  for (size_t i0 = 0; i0 < n; i0 += kLanes) {
+    const size_t m = std::min(kLanes, n - i0);
+    int index[kLanes];
+    for (size_t k = 0; k < m; ++k)
+      index[k] = step(0, vectors + (i0 + k) * stride);
+    bool active;
+    do {
+      active = false;
+      for (size_t k = 0; k < m; ++k) {
+        // lanes that reached a terminal node keep their (non-positive) index
+        int current = index[k];
+        int next = step(current > 0 ? current : 0, vectors + (i0 + k) * stride);
+        index[k] = current > 0 ? next : current;
+        active |= index[k] > 0;
+      }
+    } while (active);
+    for (size_t k = 0; k < m; ++k)
+      out[i0 + k] += fResponses[-index[k]];
+  }
+}
+
 #endif
@@ -67,5 +67,14 @@ int main() {
   ret = aTree.GetResponseOld(val);
   std::cout << "new " << ret << std::endl;
 
+  float vals[4] = {-1, 1, 0.5, -0.5};
+  double rets[4] = {0, 0, 0, 0};
+  aTree.AddResponse(vals, 4, 1, rets);
+  for (int i = 0; i < 4; ++i) {
+    std::cout << "batch " << vals[i] << ' ' << rets[i] << std::endl;
+    if (rets[i] != aTree.GetResponse(vals + i))
+      return 1;
+  }
+
   return 0;
 }
@@ -18,8 +18,12 @@
 #include "TTree.h"
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/task_arena.h>
+
 #include "DQMServices/Core/interface/DQMStore.h"
 #include "DataFormats/Histograms/interface/DQMToken.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
@@ -119,6 +123,16 @@ struct DQMTTreeIO {
         }
       }
     }
+
+    // Scalars are not summed: the value read last replaces the previous one.
+    static void mergeScalar(MonitorElement* existing, MonitorElementData const& toAdd) {
+      if (toAdd.key_.kind_ == MonitorElementData::Kind::INT)
+        existing->Fill(toAdd.value_.scalar_.num);
+      else if (toAdd.key_.kind_ == MonitorElementData::Kind::REAL)
+        existing->Fill(toAdd.value_.scalar_.real);
+      else if (toAdd.key_.kind_ == MonitorElementData::Kind::STRING)
+        existing->Fill(toAdd.value_.scalar_.str);
+    }
   };
 
   // This struct allows to find all MEs belonging to a run-lumi pair
@@ -175,55 +189,113 @@ struct DQMTTreeIO {
       }
       return key;
     }
-    virtual void read(ULong64_t iIndex, DQMStore* dqmstore, int run, int lumi) = 0;
-    virtual void setTree(TTree* iTree) = 0;
-
-  protected:
-    MonitorElementData::Kind m_kind;
-    MonitorElementData::Scope m_rescope;
-  };
-
-  template <class T>
-  class TreeObjectReader : public TreeReaderBase {
-  public:
-    TreeObjectReader(MonitorElementData::Kind kind, MonitorElementData::Scope rescope) : TreeReaderBase(kind, rescope) {
-      assert(m_kind != MonitorElementData::Kind::INT);
-      assert(m_kind != MonitorElementData::Kind::REAL);
-      assert(m_kind != MonitorElementData::Kind::STRING);
-    }
 
-    void read(ULong64_t iIndex, DQMStore* dqmstore, int run, int lumi) override {
-      // This will populate the fields as defined in setTree method
+    // Read the ME stored at iIndex and put it into the DQMStore, or merge it into the ME already there.
+    void read(ULong64_t iIndex, DQMStore* dqmstore, int run, int lumi) {
       try {
-        m_tree->GetEntry(iIndex);
+        // This will populate the fields as defined in setTree method
+        getEntry(iIndex);
 
-        auto key = makeKey(*m_fullName, run, lumi);
+        auto key = makeKey(fullName(), run, lumi);
         auto existing = dqmstore->findOrRecycle(key);
         if (existing) {
           // TODO: make sure there is sufficient locking here.
-          DQMMergeHelper::mergeTogether(existing->getTH1(), m_buffer);
+          mergeInto(existing);
         } else {
           // We make our own MEs here, to avoid a round-trip through the booking API.
-          MonitorElementData meData;
-          meData.key_ = key;
-          meData.value_.object_ = std::unique_ptr<T>((T*)(m_buffer->Clone()));
-          auto me = new MonitorElement(std::move(meData));
+          auto me = new MonitorElement(detach(key));
           dqmstore->putME(me);
         }
       } catch (cms::Exception& iExcept) {
-        using namespace std::string_literals;
-        iExcept.addContext("failed while reading "s + *m_fullName);
+        addContext(iExcept);
+        throw;
+      }
+    }
+
+    // Read the ME stored at iIndex into a copy that does not belong to the DQMStore yet.
+    MonitorElementData read(ULong64_t iIndex, int run, int lumi) {
+      try {
+        getEntry(iIndex);
+        return detach(makeKey(fullName(), run, lumi));
+      } catch (cms::Exception& iExcept) {
+        addContext(iExcept);
         throw;
       }
     }
 
-    void setTree(TTree* iTree) override {
+    void setTree(TTree* iTree) {
+      doSetTree(iTree);
+      m_fullNameBranch = iTree->GetBranch(kFullNameBranch);
+    }
+
+    // True if the ME stored at iIndex is in one of the folders (or if no folders are given).
+    // Only the name is read, so that the values of the MEs that are not needed are never
+    // read or decompressed.
+    bool isSelected(ULong64_t iIndex, std::vector<std::string> const& folders) {
+      if (folders.empty())
+        return true;
+      m_fullNameBranch->GetEntry(iIndex);
+      std::string const& name = fullName();
+      for (auto const& folder : folders) {
+        if (name.size() > folder.size() and name.compare(0, folder.size(), folder) == 0 and
+            (name[folder.size()] == '/' or folder.back() == '/'))
+          return true;
+      }
+      return false;
+    }
+
+  protected:
+    virtual void doSetTree(TTree* iTree) = 0;
+    virtual void getEntry(ULong64_t iIndex) = 0;
+    virtual std::string const* fullNamePtr() const = 0;
+    // Copy the value just read into the data of a new ME.
+    virtual MonitorElementData detach(MonitorElementData::Key const& key) = 0;
+    // Merge the value just read into an existing ME.
+    virtual void mergeInto(MonitorElement* existing) = 0;
+
+    MonitorElementData::Kind m_kind;
+    MonitorElementData::Scope m_rescope;
+
+  private:
+    TBranch* m_fullNameBranch = nullptr;
+
+    std::string const& fullName() const { return *fullNamePtr(); }
+    void addContext(cms::Exception& iExcept) const {
+      using namespace std::string_literals;
+      if (fullNamePtr() != nullptr)
+        iExcept.addContext("failed while reading "s + fullName());
+    }
+  };
+
+  template <class T>
+  class TreeObjectReader : public TreeReaderBase {
+  public:
+    TreeObjectReader(MonitorElementData::Kind kind, MonitorElementData::Scope rescope) : TreeReaderBase(kind, rescope) {
+      assert(m_kind != MonitorElementData::Kind::INT);
+      assert(m_kind != MonitorElementData::Kind::REAL);
+      assert(m_kind != MonitorElementData::Kind::STRING);
+    }
+
+  protected:
+    void doSetTree(TTree* iTree) override {
       m_tree = iTree;
       m_tree->SetBranchAddress(kFullNameBranch, &m_fullName);
       m_tree->SetBranchAddress(kFlagBranch, &m_tag);
       m_tree->SetBranchAddress(kValueBranch, &m_buffer);
     }
 
+    void getEntry(ULong64_t iIndex) override { m_tree->GetEntry(iIndex); }
+    std::string const* fullNamePtr() const override { return m_fullName; }
+
+    MonitorElementData detach(MonitorElementData::Key const& key) override {
+      MonitorElementData meData;
+      meData.key_ = key;
+      meData.value_.object_ = std::unique_ptr<T>((T*)(m_buffer->Clone()));
+      return meData;
+    }
+
+    void mergeInto(MonitorElement* existing) override { DQMMergeHelper::mergeTogether(existing->getTH1(), m_buffer); }
+
   private:
     TTree* m_tree = nullptr;
     std::string* m_fullName = nullptr;
@@ -237,32 +309,26 @@ struct DQMTTreeIO {
       assert(m_kind == MonitorElementData::Kind::STRING);
     }
 
-    void read(ULong64_t iIndex, DQMStore* dqmstore, int run, int lumi) override {
-      // This will populate the fields as defined in setTree method
-      m_tree->GetEntry(iIndex);
-
-      auto key = makeKey(*m_fullName, run, lumi);
-      auto existing = dqmstore->findOrRecycle(key);
-
-      if (existing) {
-        existing->Fill(*m_value);
-      } else {
-        // We make our own MEs here, to avoid a round-trip through the booking API.
-        MonitorElementData meData;
-        meData.key_ = key;
-        meData.value_.scalar_.str = *m_value;
-        auto me = new MonitorElement(std::move(meData));
-        dqmstore->putME(me);
-      }
-    }
-
-    void setTree(TTree* iTree) override {
+  protected:
+    void doSetTree(TTree* iTree) override {
       m_tree = iTree;
       m_tree->SetBranchAddress(kFullNameBranch, &m_fullName);
       m_tree->SetBranchAddress(kFlagBranch, &m_tag);
       m_tree->SetBranchAddress(kValueBranch, &m_value);
     }
 
+    void getEntry(ULong64_t iIndex) override { m_tree->GetEntry(iIndex); }
+    std::string const* fullNamePtr() const override { return m_fullName; }
+
+    MonitorElementData detach(MonitorElementData::Key const& key) override {
+      MonitorElementData meData;
+      meData.key_ = key;
+      meData.value_.scalar_.str = *m_value;
+      return meData;
+    }
+
+    void mergeInto(MonitorElement* existing) override { existing->Fill(*m_value); }
+
   private:
     TTree* m_tree = nullptr;
     std::string* m_fullName = nullptr;
@@ -277,41 +343,55 @@ struct DQMTTreeIO {
       assert(m_kind == MonitorElementData::Kind::INT || m_kind == MonitorElementData::Kind::REAL);
     }
 
-    void read(ULong64_t iIndex, DQMStore* dqmstore, int run, int lumi) override {
-      // This will populate the fields as defined in setTree method
-      m_tree->GetEntry(iIndex);
-
-      auto key = makeKey(*m_fullName, run, lumi);
-      auto existing = dqmstore->findOrRecycle(key);
-
-      if (existing) {
-        existing->Fill(m_buffer);
-      } else {
-        // We make our own MEs here, to avoid a round-trip through the booking API.
-        MonitorElementData meData;
-        meData.key_ = key;
-        if (m_kind == MonitorElementData::Kind::INT)
-          meData.value_.scalar_.num = m_buffer;
-        else if (m_kind == MonitorElementData::Kind::REAL)
-          meData.value_.scalar_.real = m_buffer;
-        auto me = new MonitorElement(std::move(meData));
-        dqmstore->putME(me);
-      }
-    }
-
-    void setTree(TTree* iTree) override {
+  protected:
+    void doSetTree(TTree* iTree) override {
       m_tree = iTree;
       m_tree->SetBranchAddress(kFullNameBranch, &m_fullName);
       m_tree->SetBranchAddress(kFlagBranch, &m_tag);
       m_tree->SetBranchAddress(kValueBranch, &m_buffer);
     }
 
+    void getEntry(ULong64_t iIndex) override { m_tree->GetEntry(iIndex); }
+    std::string const* fullNamePtr() const override { return m_fullName; }
+
+    MonitorElementData detach(MonitorElementData::Key const& key) override {
+      MonitorElementData meData;
+      meData.key_ = key;
+      if (m_kind == MonitorElementData::Kind::INT)
+        meData.value_.scalar_.num = m_buffer;
+      else if (m_kind == MonitorElementData::Kind::REAL)
+        meData.value_.scalar_.real = m_buffer;
+      return meData;
+    }
+
+    void mergeInto(MonitorElement* existing) override { existing->Fill(m_buffer); }
+
   private:
     TTree* m_tree = nullptr;
     std::string* m_fullName = nullptr;
     T m_buffer = 0;
     uint32_t m_tag = 0;
   };
+
+  // One reader for each type of ME; the readers keep the branch buffers of the tree they read.
+  static std::vector<std::shared_ptr<TreeReaderBase>> makeTreeReaders(MonitorElementData::Scope rescope) {
+    std::vector<std::shared_ptr<TreeReaderBase>> readers(kNIndicies);
+    readers[kIntIndex].reset(new TreeSimpleReader<Long64_t>(MonitorElementData::Kind::INT, rescope));
+    readers[kFloatIndex].reset(new TreeSimpleReader<double>(MonitorElementData::Kind::REAL, rescope));
+    readers[kStringIndex].reset(new TreeStringReader(MonitorElementData::Kind::STRING, rescope));
+    readers[kTH1FIndex].reset(new TreeObjectReader<TH1F>(MonitorElementData::Kind::TH1F, rescope));
+    readers[kTH1SIndex].reset(new TreeObjectReader<TH1S>(MonitorElementData::Kind::TH1S, rescope));
+    readers[kTH1DIndex].reset(new TreeObjectReader<TH1D>(MonitorElementData::Kind::TH1D, rescope));
+    readers[kTH1IIndex].reset(new TreeObjectReader<TH1I>(MonitorElementData::Kind::TH1I, rescope));
+    readers[kTH2FIndex].reset(new TreeObjectReader<TH2F>(MonitorElementData::Kind::TH2F, rescope));
+    readers[kTH2SIndex].reset(new TreeObjectReader<TH2S>(MonitorElementData::Kind::TH2S, rescope));
+    readers[kTH2DIndex].reset(new TreeObjectReader<TH2D>(MonitorElementData::Kind::TH2D, rescope));
+    readers[kTH2IIndex].reset(new TreeObjectReader<TH2I>(MonitorElementData::Kind::TH2I, rescope));
+    readers[kTH3FIndex].reset(new TreeObjectReader<TH3F>(MonitorElementData::Kind::TH3F, rescope));
+    readers[kTProfileIndex].reset(new TreeObjectReader<TProfile>(MonitorElementData::Kind::TPROFILE, rescope));
+    readers[kTProfile2DIndex].reset(new TreeObjectReader<TProfile2D>(MonitorElementData::Kind::TPROFILE2D, rescope));
+    return readers;
+  }
 };
 
 class DQMRootSource : public edm::PuttableSourceBase, DQMTTreeIO {
@@ -339,8 +419,15 @@ private:
   void readLuminosityBlock_(edm::LuminosityBlockPrincipal& lbCache) override;
   void readEvent_(edm::EventPrincipal&) override;
 
-  // Read MEs from m_fileMetadatas to DQMStore  till run or lumi transition
-  void readElements();
+  // Read the MEs of the rows [begin, end) of m_fileMetadatas, which belong to the same run and lumi,
+  // to the DQMStore, merging the copies found in different files
+  void readElements(unsigned int begin, unsigned int end);
+  // Read the MEs of one row of m_fileMetadatas, calling `read` with the reader and the index of each of them
+  template <typename F>
+  static void readBlock(FileMetadata const& metadata,
+                        std::vector<std::shared_ptr<TreeReaderBase>>& readers,
+                        std::vector<std::string> const& folders,
+                        F&& read);
   // True if m_currentIndex points to an element that has a different
   // run or lumi than the previous element (a transition needs to happen).
   // False otherwise.
@@ -365,6 +452,8 @@ private:
   // Properties from python config
   bool m_skipBadFiles;
   unsigned int m_filterOnRun;
+  unsigned int m_numberOfConcurrentFiles;
+  std::vector<std::string> m_folders;
   edm::InputFileCatalog m_catalog;
   std::vector<edm::LuminosityBlockRange> m_lumisToProcess;
   MonitorElementData::Scope m_rescope;
@@ -414,6 +503,16 @@ void DQMRootSource::fillDescriptions(edm::ConfigurationDescriptions& description
           " Options: \"\": keep unchanged, \"RUN\": turn LUMI histograms into RUN histograms, \"JOB\": turn everything "
           "into JOB histograms.");
   desc.addUntracked<bool>("skipBadFiles", false)->setComment("Skip the file if it is not valid");
+  desc.addUntracked<unsigned int>("numberOfConcurrentFiles", 0)
+      ->setComment(
+          "Number of files read in parallel before their MEs are merged into the DQMStore; the copies of the MEs "
+          "of these files are kept in memory until they are merged. 0: the number of threads of the job, 1: read "
+          "and merge the files one by one.");
+  desc.addUntracked<std::vector<std::string>>("folders", std::vector<std::string>())
+      ->setComment(
+          "Only read the MEs in these folders (and their subfolders), e.g. [\"Tracking\", \"Muons/MuonRecoAnalyzer\"]; "
+          "the values of the other MEs are not read from the files. Empty: read all the MEs. The folder names "
+          "cannot be empty.");
   desc.addUntracked<std::string>("overrideCatalog", std::string())
       ->setComment("An alternate file catalog to use instead of the standard site one.");
   std::vector<edm::LuminosityBlockRange> defaultLumis;
@@ -431,6 +530,8 @@ DQMRootSource::DQMRootSource(edm::ParameterSet const& iPSet, const edm::InputSou
     : edm::PuttableSourceBase(iPSet, iDesc),
       m_skipBadFiles(iPSet.getUntrackedParameter<bool>("skipBadFiles", false)),
       m_filterOnRun(iPSet.getUntrackedParameter<unsigned int>("filterOnRun", 0)),
+      m_numberOfConcurrentFiles(iPSet.getUntrackedParameter<unsigned int>("numberOfConcurrentFiles")),
+      m_folders(iPSet.getUntrackedParameter<std::vector<std::string>>("folders")),
       m_catalog(iPSet.getUntrackedParameter<std::vector<std::string>>("fileNames"),
                 iPSet.getUntrackedParameter<std::string>("overrideCatalog")),
       m_lumisToProcess(iPSet.getUntrackedParameter<std::vector<edm::LuminosityBlockRange>>(
@@ -447,24 +548,17 @@ DQMRootSource::DQMRootSource(edm::ParameterSet const& iPSet, const edm::InputSou
       m_fileMetadatas(std::vector<FileMetadata>()) {
   edm::sortAndRemoveOverlaps(m_lumisToProcess);
 
+  for (auto const& folder : m_folders) {
+    if (folder.empty())
+      throw cms::Exception("Configuration")
+          << "DQMRootSource: the \"folders\" parameter contains an empty folder name; "
+             "leave the parameter empty to read all the MEs.";
+  }
+
   if (m_catalog.fileNames(0).empty()) {
     m_nextItemType = edm::InputSource::ItemType::IsStop;
   } else {
-    m_treeReaders[kIntIndex].reset(new TreeSimpleReader<Long64_t>(MonitorElementData::Kind::INT, m_rescope));
-    m_treeReaders[kFloatIndex].reset(new TreeSimpleReader<double>(MonitorElementData::Kind::REAL, m_rescope));
-    m_treeReaders[kStringIndex].reset(new TreeStringReader(MonitorElementData::Kind::STRING, m_rescope));
-    m_treeReaders[kTH1FIndex].reset(new TreeObjectReader<TH1F>(MonitorElementData::Kind::TH1F, m_rescope));
-    m_treeReaders[kTH1SIndex].reset(new TreeObjectReader<TH1S>(MonitorElementData::Kind::TH1S, m_rescope));
-    m_treeReaders[kTH1DIndex].reset(new TreeObjectReader<TH1D>(MonitorElementData::Kind::TH1D, m_rescope));
-    m_treeReaders[kTH1IIndex].reset(new TreeObjectReader<TH1I>(MonitorElementData::Kind::TH1I, m_rescope));
-    m_treeReaders[kTH2FIndex].reset(new TreeObjectReader<TH2F>(MonitorElementData::Kind::TH2F, m_rescope));
-    m_treeReaders[kTH2SIndex].reset(new TreeObjectReader<TH2S>(MonitorElementData::Kind::TH2S, m_rescope));
-    m_treeReaders[kTH2DIndex].reset(new TreeObjectReader<TH2D>(MonitorElementData::Kind::TH2D, m_rescope));
-    m_treeReaders[kTH2IIndex].reset(new TreeObjectReader<TH2I>(MonitorElementData::Kind::TH2I, m_rescope));
-    m_treeReaders[kTH3FIndex].reset(new TreeObjectReader<TH3F>(MonitorElementData::Kind::TH3F, m_rescope));
-    m_treeReaders[kTProfileIndex].reset(new TreeObjectReader<TProfile>(MonitorElementData::Kind::TPROFILE, m_rescope));
-    m_treeReaders[kTProfile2DIndex].reset(
-        new TreeObjectReader<TProfile2D>(MonitorElementData::Kind::TPROFILE2D, m_rescope));
+    m_treeReaders = makeTreeReaders(m_rescope);
   }
 
   produces<DQMToken, edm::Transition::BeginRun>("DQMGenerationRecoRun");
@@ -655,13 +749,13 @@ std::shared_ptr<edm::LuminosityBlockAuxiliary> DQMRootSource::readLuminosityBloc
 
 void DQMRootSource::readRun_(edm::RunPrincipal& rpCache) {
   // Read elements of a current run.
+  unsigned int begin = m_currentIndex;
   do {
-    FileMetadata metadata = m_fileMetadatas[m_currentIndex];
-    if (metadata.m_lumi == 0) {
-      readElements();
-    }
     m_currentIndex++;
   } while (!isRunOrLumiTransition());
+  if (m_fileMetadatas[begin].m_lumi == 0) {
+    readElements(begin, m_currentIndex);
+  }
 
   readNextItemType();
 
@@ -672,10 +766,11 @@ void DQMRootSource::readRun_(edm::RunPrincipal& rpCache) {
 
 void DQMRootSource::readLuminosityBlock_(edm::LuminosityBlockPrincipal& lbCache) {
   // Read elements of a current lumi.
+  unsigned int begin = m_currentIndex;
   do {
-    readElements();
     m_currentIndex++;
   } while (!isRunOrLumiTransition());
+  readElements(begin, m_currentIndex);
 
   readNextItemType();
 
@@ -686,27 +781,102 @@ void DQMRootSource::readLuminosityBlock_(edm::LuminosityBlockPrincipal& lbCache)
 
 void DQMRootSource::readEvent_(edm::EventPrincipal&) {}
 
-void DQMRootSource::readElements() {
-  FileMetadata metadata = m_fileMetadatas[m_currentIndex];
+template <typename F>
+void DQMRootSource::readBlock(FileMetadata const& metadata,
+                              std::vector<std::shared_ptr<TreeReaderBase>>& readers,
+                              std::vector<std::string> const& folders,
+                              F&& read) {
+  std::shared_ptr<TreeReaderBase> reader = readers[metadata.m_type];
+  TTree* tree = dynamic_cast<TTree*>(metadata.m_file->Get(kTypeNames[metadata.m_type]));
+  // The Reset() below screws up the tree, so we need to re-read it from file
+  // before use here.
+  tree->Refresh();
+
+  reader->setTree(tree);
+
+  ULong64_t index = metadata.m_firstIndex;
+  ULong64_t endIndex = metadata.m_lastIndex + 1;
+
+  for (; index != endIndex; ++index) {
+    if (reader->isSelected(index, folders))
+      read(*reader, index);
+  }
+  // Drop buffers in the TTree. This reduces memory consuption while the tree
+  // just sits there and waits for the next block to be read.
+  tree->Reset();
+}
 
-  if (metadata.m_type != kNoTypesStored) {
-    std::shared_ptr<TreeReaderBase> reader = m_treeReaders[metadata.m_type];
-    TTree* tree = dynamic_cast<TTree*>(metadata.m_file->Get(kTypeNames[metadata.m_type]));
-    // The Reset() below screws up the tree, so we need to re-read it from file
-    // before use here.
-    tree->Refresh();
+void DQMRootSource::readElements(unsigned int begin, unsigned int end) {
+  DQMStore* store = edm::Service<DQMStore>().operator->();
 
-    reader->setTree(tree);
+  // Group the rows by file, in the order of the files: a file (and its trees) is only ever read
+  // by one thread at a time, while different files can be read concurrently.
+  std::vector<std::vector<FileMetadata const*>> files;
+  std::unordered_map<TFile*, unsigned int> fileIndex;
+  for (unsigned int i = begin; i != end; ++i) {
+    FileMetadata const& metadata = m_fileMetadatas[i];
+    if (metadata.m_type == kNoTypesStored)
+      continue;
+    auto found = fileIndex.try_emplace(metadata.m_file, files.size());
+    if (found.second)
+      files.emplace_back();
+    files[found.first->second].push_back(&metadata);
+  }
 
-    ULong64_t index = metadata.m_firstIndex;
-    ULong64_t endIndex = metadata.m_lastIndex + 1;
+  unsigned int concurrentFiles = m_numberOfConcurrentFiles;
+  if (concurrentFiles == 0)
+    concurrentFiles = oneapi::tbb::this_task_arena::max_concurrency();
+  if (concurrentFiles <= 1 or files.size() <= 1) {
+    for (auto const& blocks : files) {
+      for (auto metadata : blocks) {
+        readBlock(*metadata, m_treeReaders, m_folders, [&](TreeReaderBase& reader, ULong64_t index) {
+          reader.read(index, store, metadata->m_run, metadata->m_lumi);
+        });
+      }
+    }
+    return;
+  }
 
-    for (; index != endIndex; ++index) {
-      reader->read(index, edm::Service<DQMStore>().operator->(), metadata.m_run, metadata.m_lumi);
+  // Read the files by groups of concurrentFiles, keeping at most one copy of the MEs per file of
+  // the group in memory, and merge each group into the DQMStore before reading the next one.
+  for (unsigned int first = 0; first < files.size(); first += concurrentFiles) {
+    unsigned int last = std::min<unsigned int>(first + concurrentFiles, files.size());
+    std::vector<std::vector<MonitorElementData>> detached(last - first);
+    oneapi::tbb::parallel_for(first, last, [&](unsigned int f) {
+      // the readers hold the branch buffers, so each file needs its own
+      auto readers = makeTreeReaders(m_rescope);
+      for (auto metadata : files[f]) {
+        readBlock(*metadata, readers, m_folders, [&](TreeReaderBase& reader, ULong64_t index) {
+          detached[f - first].push_back(reader.read(index, metadata->m_run, metadata->m_lumi));
+        });
+      }
+    });
+
+    // Find or create the MEs in the file order, as the serial reading does; the histograms that
+    // need to be added are collected per ME, so that different MEs are merged in parallel.
+    std::vector<std::pair<MonitorElement*, std::vector<TH1*>>> merges;
+    std::unordered_map<MonitorElement*, unsigned int> mergeIndex;
+    for (auto& fileMEs : detached) {
+      for (auto& meData : fileMEs) {
+        auto existing = store->findOrRecycle(meData.key_);
+        if (not existing) {
+          // We make our own MEs here, to avoid a round-trip through the booking API.
+          store->putME(new MonitorElement(std::move(meData)));
+        } else if (meData.value_.object_.get() != nullptr) {
+          auto found = mergeIndex.try_emplace(existing, merges.size());
+          if (found.second)
+            merges.emplace_back(existing, std::vector<TH1*>());
+          merges[found.first->second].second.push_back(meData.value_.object_.get());
+        } else {
+          DQMMergeHelper::mergeScalar(existing, meData);
+        }
+      }
     }
-    // Drop buffers in the TTree. This reduces memory consuption while the tree
-    // just sits there and waits for the next block to be read.
-    tree->Reset();
+    oneapi::tbb::parallel_for(std::size_t(0), merges.size(), [&](std::size_t i) {
+      TH1* original = merges[i].first->getTH1();
+      for (auto toAdd : merges[i].second)
+        DQMMergeHelper::mergeTogether(original, toAdd);
+    });
   }
 }
 
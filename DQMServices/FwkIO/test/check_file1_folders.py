@@ -0,0 +1,21 @@
+from __future__ import print_function
+import ROOT as R
+import sys
+
+f = R.TFile.Open(sys.argv[1] if len(sys.argv) > 1 else "dqm_file1_folders.root")
+
+th1fs = f.Get("TH1Fs")
+
+names = set()
+for i in range(0, th1fs.GetEntries()):
+    th1fs.GetEntry(i)
+    names.add(str(th1fs.FullName))
+
+expected = set(["A/Bar", "A/Bar_lumi", "A/B/Bar", "A/B/Bar_lumi"])
+if names != expected:
+    print("ERROR: unexpected MEs read from the folder A")
+    print(" expected:", sorted(expected))
+    print(" found:", sorted(names))
+    sys.exit(1)
+
+print("SUCCEEDED")
@@ -3,7 +3,7 @@ from builtins import range
 import ROOT as R
 import sys
 
-f = R.TFile.Open("dqm_merged_file1_file2.root")
+f = R.TFile.Open(sys.argv[1] if len(sys.argv) > 1 else "dqm_merged_file1_file2.root")
 
 th1fs = f.Get("TH1Fs")
 
@@ -0,0 +1,35 @@
+import FWCore.ParameterSet.Config as cms
+process =cms.Process("TEST")
+
+process.source = cms.Source("EmptySource", numberEventsInRun = cms.untracked.uint32(100),
+                            firstLuminosityBlock = cms.untracked.uint32(1),
+                            firstEvent = cms.untracked.uint32(1),
+                            numberEventsInLuminosityBlock = cms.untracked.uint32(1))
+
+# "AB" shares its first letter with the selected folder "A", but is not inside it
+names = ["Bar", "A/Bar", "A/B/Bar", "AB/Bar", "C/Bar"]
+
+elements = list()
+for name in names:
+    elements.append(cms.untracked.PSet(lowX=cms.untracked.double(0),
+                                       highX=cms.untracked.double(11),
+                                       nchX=cms.untracked.int32(11),
+                                       name=cms.untracked.string(name),
+                                       title=cms.untracked.string(name),
+                                       value=cms.untracked.double(1)))
+
+process.filler = cms.EDProducer("DummyFillDQMStore",
+                                elements=cms.untracked.VPSet(*elements),
+                                fillRuns = cms.untracked.bool(True),
+                                fillLumis = cms.untracked.bool(True))
+
+process.out = cms.OutputModule("DQMRootOutputModule",
+                               fileName = cms.untracked.string("dqm_file_folders.root"))
+
+process.p = cms.Path(process.filler)
+
+process.o = cms.EndPath(process.out)
+
+process.maxEvents = cms.untracked.PSet(input = cms.untracked.int32(10))
+
+process.add_(cms.Service("DQMStore"))
@@ -0,0 +1,17 @@
+import FWCore.ParameterSet.Config as cms
+
+process = cms.Process("READ")
+
+process.source = cms.Source("DQMRootSource",
+                            reScope = cms.untracked.string(""),
+                            numberOfConcurrentFiles = cms.untracked.uint32(2),
+                            fileNames = cms.untracked.vstring("file:dqm_file1.root","file:dqm_file2.root"))
+
+process.options.numberOfThreads = 4
+process.options.numberOfStreams = 1
+
+process.out = cms.OutputModule("DQMRootOutputModule",
+                               fileName = cms.untracked.string("dqm_merged_file1_file2_parallel.root"))
+process.e = cms.EndPath(process.out)
+
+process.add_(cms.Service("DQMStore"))
@@ -0,0 +1,26 @@
+import FWCore.ParameterSet.Config as cms
+
+import argparse
+import sys
+
+parser = argparse.ArgumentParser(prog=sys.argv[0], description='Read only the MEs of some folders.')
+
+parser.add_argument("--emptyFolder", help="Add an empty folder name, which is rejected", action="store_true")
+
+args = parser.parse_args()
+
+process = cms.Process("READ")
+
+# dqm_file1.root has only MEs at the top level, none of which must be read
+process.source = cms.Source("DQMRootSource",
+                            reScope = cms.untracked.string(""),
+                            folders = cms.untracked.vstring("A"),
+                            fileNames = cms.untracked.vstring("file:dqm_file1.root","file:dqm_file_folders.root"))
+if args.emptyFolder:
+    process.source.folders.append("")
+
+process.out = cms.OutputModule("DQMRootOutputModule",
+                               fileName = cms.untracked.string("dqm_file1_folders.root"))
+process.e = cms.EndPath(process.out)
+
+process.add_(cms.Service("DQMStore"))
@@ -116,6 +116,17 @@ LOCAL_TEST_DIR=${SCRAM_TEST_PATH}
   echo ${testConfig} ------------------------------------------------------------
   cmsRun ${LOCAL_TEST_DIR}/${testConfig} || die "cmsRun ${testConfig}" $?
 
+  # same merge, reading the files in parallel
+  testConfig=merge_file1_file2_parallel_cfg.py
+  rm -f dqm_merged_file1_file2_parallel.root
+  echo ${testConfig} ------------------------------------------------------------
+  cmsRun ${LOCAL_TEST_DIR}/${testConfig} || die "cmsRun ${testConfig}" $?
+
+  checkFile=check_merged_file1_file2.py
+  fileToCheck=dqm_merged_file1_file2_parallel.root
+  echo ${checkFile} ${fileToCheck} ------------------------------------------------------------
+  python3 ${LOCAL_TEST_DIR}/${checkFile} ${fileToCheck} || die "python3 ${checkFile} ${fileToCheck}" $?
+
   testConfig=merge_file1_file3_file2_cfg.py
   rm -f dqm_merged_file1_file3_file2.root
   echo ${testConfig} ------------------------------------------------------------
@@ -169,6 +180,24 @@ LOCAL_TEST_DIR=${SCRAM_TEST_PATH}
   echo ${testConfig} ------------------------------------------------------------
   cmsRun ${LOCAL_TEST_DIR}/${testConfig} || die "cmsRun ${testConfig}" $?
 
+  # read only the MEs of a folder
+  testConfig=create_file_folders_cfg.py
+  rm -f dqm_file_folders.root
+  echo ${testConfig} ------------------------------------------------------------
+  cmsRun ${LOCAL_TEST_DIR}/${testConfig} || die "cmsRun ${testConfig}" $?
+
+  testConfig=read_file1_folders_cfg.py
+  rm -f dqm_file1_folders.root
+  echo ${testConfig} ------------------------------------------------------------
+  cmsRun ${LOCAL_TEST_DIR}/${testConfig} || die "cmsRun ${testConfig}" $?
+
+  checkFile=check_file1_folders.py
+  echo ${checkFile} ------------------------------------------------------------
+  python3 ${LOCAL_TEST_DIR}/${checkFile} || die "python3 ${checkFile}" $?
+
+  echo ${testConfig} --emptyFolder ------------------------------------------------------------
+  cmsRun ${LOCAL_TEST_DIR}/${testConfig} --emptyFolder && die "cmsRun ${testConfig} --emptyFolder" 1
+
 # empty
   testConfig=create_empty_file_cfg.py
   rm -f dqm_empty.root
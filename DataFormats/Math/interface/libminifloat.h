@@ -52,27 +52,24 @@ public:
   class ReduceMantissaToNbitsRounding {
   public:
     ReduceMantissaToNbitsRounding(int bits)
-        : shift(23 - bits), mask((0xFFFFFFFF >> (shift)) << (shift)), test(1 << (shift - 1)), maxn((1 << bits) - 2) {
+        : shift(23 - bits), test(1 << (shift - 1)), maxn((1 << bits) - 2) {
       assert(bits <= 23);  // "max mantissa size is 23 bits"
     }
     float operator()(float f) const {
       constexpr uint32_t low23 = (0x007FFFFF);  // mask to keep lowest 23 bits = mantissa
       constexpr uint32_t hi9 = (0xFF800000);    // mask to keep highest 9 bits = the rest
       uint32_t i32 = edm::bit_cast<uint32_t>(f);
-      if (i32 & test) {  // need to round
-        uint32_t mantissa = (i32 & low23) >> shift;
-        if (mantissa < maxn)
-          mantissa++;
-        i32 = (i32 & hi9) | (mantissa << shift);
-      } else {
-        i32 &= mask;
-      }
+      // round up if the first dropped bit is set, unless the mantissa would overflow;
+      // written without branches so that loops over many values can be vectorized
+      uint32_t mantissa = (i32 & low23) >> shift;
+      mantissa += ((i32 & test) != 0) & (mantissa < maxn);
+      i32 = (i32 & hi9) | (mantissa << shift);
       return edm::bit_cast<float>(i32);
     }
 
   private:
     const int shift;
-    const uint32_t mask, test, maxn;
+    const uint32_t test, maxn;
   };
 
   template <int bits>
@@ -90,6 +87,22 @@ public:
     std::transform(begin, end, out, ReduceMantissaToNbitsRounding(bits));
   }
 
+  /// Same rounding as above, in place, with a number of bits for each value (values with bits <= 0 or
+  /// bits >= 23 are left unchanged). It has no branches, so that the loop can be vectorized.
+  static void reduceMantissaToNbitsRounding(const int *bits, float *values, unsigned int n) {
+    constexpr uint32_t low23 = (0x007FFFFF);
+    constexpr uint32_t hi9 = (0xFF800000);
+    for (unsigned int i = 0; i < n; ++i) {
+      const uint32_t shift = (bits[i] > 0 && bits[i] < 23) ? 23 - bits[i] : 0;
+      const uint32_t test = shift > 0 ? (1u << (shift - 1)) : 0;
+      const uint32_t maxn = (low23 >> shift) - 1;
+      uint32_t i32 = edm::bit_cast<uint32_t>(values[i]);
+      uint32_t mantissa = (i32 & low23) >> shift;
+      mantissa += ((i32 & test) != 0) & (mantissa < maxn);
+      values[i] = edm::bit_cast<float>((i32 & hi9) | (mantissa << shift));
+    }
+  }
+
   inline static float max() {
     constexpr uint32_t i32 = 0x477fe000;  // = mantissatable[offsettable[0x1e]+0x3ff]+exponenttable[0x1e]
     return edm::bit_cast<float>(i32);
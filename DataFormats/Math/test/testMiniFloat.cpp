@@ -1,5 +1,6 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <iostream>
+#include <vector>
 
 #include "DataFormats/Math/interface/libminifloat.h"
 #include "FWCore/Utilities/interface/isFinite.h"
@@ -13,6 +14,7 @@ class testMiniFloat : public CppUnit::TestFixture {
   CPPUNIT_TEST(testMin);
   CPPUNIT_TEST(testMin32RoundedToMin16);
   CPPUNIT_TEST(testDenormMin);
+  CPPUNIT_TEST(testReduceMantissaPerValue);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -26,6 +28,7 @@ public:
   void testMin();
   void testMin32RoundedToMin16();
   void testDenormMin();
+  void testReduceMantissaPerValue();
 
 private:
 };
@@ -131,3 +134,20 @@ void testMiniFloat::testDenormMin() {
       MiniFloatConverter::float16to32(MiniFloatConverter::float32to16crop(conv.flt));
   CPPUNIT_ASSERT(min32MinusUlp32CroppedTo16 == 0.f);
 }
+
+void testMiniFloat::testReduceMantissaPerValue() {
+  // the per-value bulk rounding must give the same results as the single value one, including
+  // mantissas with all bits set (no overflow into the exponent), and leave bits <= 0 or >= 23 alone
+  const std::vector<float> values = {
+      0.f, 1.f, -1.f, 3.14159265f, -2.71828183e-3f, 1.2345678e10f, 1.9999999f, -0.99999994f};
+  for (int bits = -1; bits <= 24; ++bits) {
+    std::vector<float> reduced = values;
+    std::vector<int> allBits(values.size(), bits);
+    MiniFloatConverter::reduceMantissaToNbitsRounding(allBits.data(), reduced.data(), reduced.size());
+    for (unsigned int i = 0; i < values.size(); ++i) {
+      const float expected =
+          (bits > 0 && bits < 23) ? MiniFloatConverter::reduceMantissaToNbitsRounding(values[i], bits) : values[i];
+      CPPUNIT_ASSERT(edm::bit_cast<uint32_t>(reduced[i]) == edm::bit_cast<uint32_t>(expected));
+    }
+  }
+}
@@ -127,6 +127,23 @@ namespace nanoaod {
       flatTableHelper::MaybeMantissaReduce<T>(mantissaBits).bulk(columnData<T>(columns_.size() - 1));
     }
 
+    /// add a column of nValues values and let `fill` write them in place: it is called once with the
+    /// (non-const) span of the new column, so no temporary vector is needed to build it
+    template <typename T, typename F>
+    void fillColumn(
+        const std::string &name, unsigned int nValues, F &&fill, const std::string &docString, int mantissaBits = -1) {
+      if (columnIndex(name) != -1)
+        throw cms::Exception("LogicError", "Duplicated column: " + name);
+      if (nValues != size())
+        throw cms::Exception("LogicError", "Mismatched size for " + name);
+      auto &vec = bigVector<T>();
+      columns_.emplace_back(name, docString, defaultColumnType<T>(), vec.size());
+      vec.resize(vec.size() + size());
+      auto data = columnData<T>(columns_.size() - 1);
+      fill(data);
+      flatTableHelper::MaybeMantissaReduce<T>(mantissaBits).bulk(data);
+    }
+
     template <typename T, typename C>
     void addColumnValue(const std::string &name, const C &value, const std::string &docString, int mantissaBits = -1) {
       if (!singleton())
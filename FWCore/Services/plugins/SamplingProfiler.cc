@@ -0,0 +1,457 @@
+// -*- C++ -*-
+//
+// Package: FWCore/Services
+// Class  : SamplingProfiler
+//
+// Implementation:
+//   Every thread that runs a module arms a timer on its own cpu clock, that delivers SIGPROF to that thread
+//   at the requested frequency. The signal handler records the call stack and the id of the module that
+//   is running on the thread into a per-thread buffer; the thread itself moves the samples from the buffer
+//   to a per-thread table of unique stacks after each module has run. At the end of the job the tables of
+//   all threads are merged, symbolised, and written in the "folded stacks" format used by flamegraph.pl,
+//   with the module label as the outermost frame.
+//
+//   The call stack is unwound with libunwind, restricted to the local address space and with a per-thread
+//   cache, instead of glibc's backtrace(), which is not async-signal-safe. libunwind is initialised on each
+//   thread before its timer is armed, so that the handler itself does not allocate memory. Samples are
+//   skipped while an exception is being propagated on the thread, since the interrupted code may then be
+//   inside the unwinder itself. The unwinder may still need to look up the unwind tables of a library with
+//   dl_iterate_phdr, so a sample that interrupts dlopen/dlclose or the registration of JIT-compiled code on
+//   the same thread may see the list of loaded objects in an inconsistent state; these are not expected
+//   while modules are running, once the job has started.
+//
+
+#include "DataFormats/Provenance/interface/ModuleDescription.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ParameterSet/interface/ConfigurationDescriptions.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
+#include "FWCore/ServiceRegistry/interface/ActivityRegistry.h"
+#include "FWCore/ServiceRegistry/interface/GlobalContext.h"
+#include "FWCore/ServiceRegistry/interface/ModuleCallingContext.h"
+#include "FWCore/ServiceRegistry/interface/ServiceMaker.h"
+#include "FWCore/ServiceRegistry/interface/StreamContext.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace {
+
+  constexpr int kNoModule = -1;
+  constexpr unsigned int kMaxStackDepth = 128;
+  constexpr unsigned int kBufferSize = 512;  // samples per thread, between two consecutive modules
+  // the signal handler and the signal trampoline
+  constexpr int kSkipFrames = 2;
+
+  // initialise libunwind and its per-thread cache on the calling thread, so that unwinding from the signal
+  // handler does not allocate memory (e.g. for the thread local storage of libunwind itself)
+  void initUnwinder() {
+    void* frames[1];
+    unw_backtrace(frames, 1);
+  }
+
+  struct Sample {
+    int module;
+    int depth;
+    void* frames[kMaxStackDepth];
+  };
+
+  // the call stack of a sample, prefixed by the id of the module that was running
+  using Stack = std::vector<void*>;
+
+  struct StackHash {
+    std::size_t operator()(Stack const& stack) const {
+      std::size_t hash = stack.size();
+      for (void* frame : stack)
+        hash ^= std::hash<void*>()(frame) + 0x9e3779b97f4a7c15ul + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  // the samples of a single thread
+  struct ThreadSamples {
+    // written by the signal handler, read by the thread itself; only atomic with respect to the signal handler
+    std::array<Sample, kBufferSize> buffer;
+    std::atomic<unsigned int> head = 0;
+    std::atomic<unsigned int> tail = 0;
+    std::atomic<unsigned long> dropped = 0;
+    std::atomic<int> module = kNoModule;
+    int depth = 0;
+
+    // accessed only by the thread itself, or at the end of the job
+    std::unordered_map<Stack, unsigned long, StackHash> stacks;
+    timer_t timer;
+    bool armed = false;
+
+    // move the samples from the buffer to the table of unique stacks
+    void drain() {
+      unsigned int last = head.load(std::memory_order_relaxed);
+      std::atomic_signal_fence(std::memory_order_acquire);
+      for (unsigned int i = tail.load(std::memory_order_relaxed); i != last; ++i) {
+        Sample const& sample = buffer[i % kBufferSize];
+        Stack stack;
+        stack.reserve(std::max(sample.depth - kSkipFrames, 0) + 1);
+        stack.push_back(reinterpret_cast<void*>(static_cast<intptr_t>(sample.module)));
+        // store the frames from the outermost to the innermost one
+        for (int f = sample.depth - 1; f >= kSkipFrames; --f)
+          stack.push_back(sample.frames[f]);
+        ++stacks[stack];
+      }
+      std::atomic_signal_fence(std::memory_order_release);
+      tail.store(last, std::memory_order_relaxed);
+    }
+  };
+
+  // the samples of each thread are owned by the service, which is destroyed at the end of the job: the
+  // thread local pointer is valid only for the instance that set it, so that a later job in the same process
+  // does not use the buffers of a previous one; 0 is never the number of an instance
+  std::atomic<unsigned int> instanceCounter = 0;
+  // trivially initialised, so they can be read by the signal handler once they have been set by the thread
+  thread_local unsigned int tl_instance = 0;
+  thread_local ThreadSamples* tl_samples = nullptr;
+  // the instance that is sampling, if any
+  std::atomic<unsigned int> sampling = 0;
+
+  void sampleHandler(int, siginfo_t*, void*) {
+    if (tl_instance == 0 or tl_instance != sampling.load(std::memory_order_relaxed))
+      return;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    ThreadSamples* samples = tl_samples;
+
+    unsigned int index = samples->head.load(std::memory_order_relaxed);
+    if (index - samples->tail.load(std::memory_order_relaxed) >= kBufferSize) {
+      samples->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    // an exception is being thrown: the interrupted code may hold the locks of the unwinder
+    if (std::uncaught_exceptions() > 0) {
+      samples->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    int saved_errno = errno;
+    Sample& sample = samples->buffer[index % kBufferSize];
+    sample.module = samples->module.load(std::memory_order_relaxed);
+    sample.depth = unw_backtrace(sample.frames, samples->depth);
+    errno = saved_errno;
+
+    std::atomic_signal_fence(std::memory_order_release);
+    samples->head.store(index + 1, std::memory_order_relaxed);
+  }
+
+  std::string symbolName(void* address) {
+    Dl_info info;
+    // the return address points to the instruction after the call
+    void* call = static_cast<char*>(address) - 1;
+    if (dladdr(call, &info) == 0 or info.dli_fname == nullptr)
+      return "[unknown]";
+    if (info.dli_sname == nullptr) {
+      // no symbol (e.g. a function with internal linkage), use the library name and offset
+      std::string library = info.dli_fname;
+      library = library.substr(library.rfind('/') + 1);
+      char offset[32];
+      snprintf(offset, sizeof(offset), "+0x%lx", static_cast<char*>(call) - static_cast<char*>(info.dli_fbase));
+      return library + offset;
+    }
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled(
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+    std::string name = (status == 0 and demangled) ? demangled.get() : info.dli_sname;
+    // ';' separates the frames in the folded format
+    std::replace(name.begin(), name.end(), ';', ':');
+    return name;
+  }
+
+}  // namespace
+
+namespace edm {
+  namespace service {
+
+    class SamplingProfiler {
+    public:
+      SamplingProfiler(ParameterSet const&, ActivityRegistry&);
+      ~SamplingProfiler();
+      static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
+
+    private:
+      void preModuleConstruction(ModuleDescription const&);
+      void postBeginJob();
+      void preModule(ModuleCallingContext const&);
+      void postModule(ModuleCallingContext const&);
+      void postEndJob();
+
+      ThreadSamples& threadSamples();
+      void stop();
+      void write();
+
+      unsigned int const instance_;
+      std::string const fileName_;
+      unsigned int const depth_;
+      long const period_;  // ns of cpu time
+
+      std::vector<std::string> moduleLabels_;
+
+      // the samples of all the threads that have run a module; owned here, so they can be merged at the end of the job
+      std::mutex mutex_;
+      std::vector<std::unique_ptr<ThreadSamples>> threads_;
+
+      struct sigaction oldAction_;
+      bool installed_ = false;
+    };
+
+    inline bool isProcessWideService(SamplingProfiler const*) { return true; }
+
+  }  // namespace service
+}  // namespace edm
+
+using edm::service::SamplingProfiler;
+
+SamplingProfiler::SamplingProfiler(ParameterSet const& iPS, ActivityRegistry& iRegistry)
+    : instance_(++instanceCounter),
+      fileName_(iPS.getUntrackedParameter<std::string>("fileName")),
+      depth_(std::min(iPS.getUntrackedParameter<unsigned int>("maxStackDepth") + kSkipFrames, kMaxStackDepth)),
+      period_(1000000000l / std::max(iPS.getUntrackedParameter<unsigned int>("samplingFrequency"), 1u)) {
+  iRegistry.watchPreModuleConstruction(this, &SamplingProfiler::preModuleConstruction);
+  iRegistry.watchPostBeginJob(this, &SamplingProfiler::postBeginJob);
+  iRegistry.watchPostEndJob(this, &SamplingProfiler::postEndJob);
+
+  iRegistry.watchPreModuleEventAcquire(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleEventAcquire(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleEvent([this](StreamContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleEvent([this](StreamContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+
+  iRegistry.watchPreModuleStreamBeginRun(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleStreamBeginRun(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleStreamEndRun(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleStreamEndRun(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleStreamBeginLumi(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleStreamBeginLumi(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleStreamEndLumi(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleStreamEndLumi(
+      [this](StreamContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+
+  iRegistry.watchPreModuleGlobalBeginRun(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleGlobalBeginRun(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleGlobalEndRun(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleGlobalEndRun(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleGlobalBeginLumi(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleGlobalBeginLumi(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleGlobalEndLumi(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleGlobalEndLumi(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleWriteRun([this](GlobalContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleWriteRun([this](GlobalContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+  iRegistry.watchPreModuleWriteLumi([this](GlobalContext const&, ModuleCallingContext const& mcc) { preModule(mcc); });
+  iRegistry.watchPostModuleWriteLumi(
+      [this](GlobalContext const&, ModuleCallingContext const& mcc) { postModule(mcc); });
+
+  // cache the unwind information per thread, so that the unwinder does not take a global lock
+  unw_set_caching_policy(unw_local_addr_space, UNW_CACHE_PER_THREAD);
+
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_sigaction = sampleHandler;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, &oldAction_) != 0)
+    throw cms::Exception("SamplingProfiler") << "Failed to install the SIGPROF handler, errno " << errno;
+  installed_ = true;
+}
+
+SamplingProfiler::~SamplingProfiler() { stop(); }
+
+void SamplingProfiler::fillDescriptions(ConfigurationDescriptions& descriptions) {
+  ParameterSetDescription desc;
+  desc.addUntracked<std::string>("fileName", "profile.folded")
+      ->setComment(
+          "Name of the file where the folded stacks are written at the end of the job,\n"
+          "one unique stack per line with the module label as the outermost frame, followed by the number of samples.\n"
+          "The file can be passed directly to flamegraph.pl; grep '^<label>;' selects a single module.");
+  desc.addUntracked<unsigned int>("samplingFrequency", 100)
+      ->setComment("Number of samples per second of cpu time, for each thread.");
+  desc.addUntracked<unsigned int>("maxStackDepth", 100)
+      ->setComment("Maximum number of frames recorded for each sample, up to 126.");
+  descriptions.add("SamplingProfiler", desc);
+  descriptions.setComment(
+      "This service periodically samples the call stacks of the threads running modules, "
+      "and attributes each sample to the module running on the thread.");
+}
+
+void SamplingProfiler::preModuleConstruction(ModuleDescription const& md) {
+  auto const mid = md.id();
+  if (mid >= moduleLabels_.size())
+    moduleLabels_.resize(mid + 1);
+  moduleLabels_[mid] = md.moduleLabel();
+}
+
+void SamplingProfiler::postBeginJob() { sampling = instance_; }
+
+ThreadSamples& SamplingProfiler::threadSamples() {
+  if (tl_instance == instance_)
+    return *tl_samples;
+
+  // first module on this thread: allocate the buffer, set the thread local pointer and initialise the unwinder
+  // before arming the timer, so the signal handler never triggers the allocation of the thread local storage
+  ThreadSamples* samples;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    samples = threads_.emplace_back(std::make_unique<ThreadSamples>()).get();
+  }
+  samples->depth = depth_;
+  tl_samples = samples;
+  std::atomic_signal_fence(std::memory_order_release);
+  tl_instance = instance_;
+  initUnwinder();
+
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGPROF);
+  pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+
+  struct sigevent event;
+  std::memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = syscall(SYS_gettid);
+  if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &samples->timer) == 0) {
+    struct itimerspec interval;
+    interval.it_interval.tv_sec = period_ / 1000000000l;
+    interval.it_interval.tv_nsec = period_ % 1000000000l;
+    interval.it_value = interval.it_interval;
+    samples->armed = (timer_settime(samples->timer, 0, &interval, nullptr) == 0);
+    if (not samples->armed)
+      timer_delete(samples->timer);
+  }
+  if (not samples->armed)
+    edm::LogWarning("SamplingProfiler") << "Failed to create the sampling timer for a thread, errno " << errno;
+  return *samples;
+}
+
+void SamplingProfiler::preModule(ModuleCallingContext const& mcc) {
+  threadSamples().module.store(static_cast<int>(mcc.moduleDescription()->id()), std::memory_order_relaxed);
+}
+
+void SamplingProfiler::postModule(ModuleCallingContext const& mcc) {
+  ThreadSamples& samples = threadSamples();
+  // resume the module that was running on this thread before this one, if any (e.g. an unscheduled producer)
+  auto const* previous = mcc.previousModuleOnThread();
+  samples.module.store(previous ? static_cast<int>(previous->moduleDescription()->id()) : kNoModule,
+                       std::memory_order_relaxed);
+  samples.drain();
+}
+
+void SamplingProfiler::stop() {
+  sampling = 0;
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto& samples : threads_) {
+    if (samples->armed)
+      timer_delete(samples->timer);
+    samples->armed = false;
+  }
+  if (installed_)
+    sigaction(SIGPROF, &oldAction_, nullptr);
+  installed_ = false;
+}
+
+void SamplingProfiler::postEndJob() {
+  stop();
+  write();
+}
+
+void SamplingProfiler::write() {
+  // merge the samples from all threads
+  std::unordered_map<Stack, unsigned long, StackHash> stacks;
+  std::vector<unsigned long> perModule(moduleLabels_.size(), 0);
+  unsigned long total = 0;
+  unsigned long dropped = 0;
+  for (auto& samples : threads_) {
+    samples->drain();
+    dropped += samples->dropped;
+    for (auto const& [stack, count] : samples->stacks) {
+      stacks[stack] += count;
+      int module = static_cast<int>(reinterpret_cast<intptr_t>(stack.front()));
+      if (module >= 0 and static_cast<unsigned int>(module) < perModule.size())
+        perModule[module] += count;
+      total += count;
+    }
+    samples->stacks.clear();
+  }
+
+  // symbolise each address only once
+  std::unordered_map<void*, std::string> symbols;
+  std::ofstream out(fileName_);
+  for (auto const& [stack, count] : stacks) {
+    int module = static_cast<int>(reinterpret_cast<intptr_t>(stack.front()));
+    if (module >= 0 and static_cast<unsigned int>(module) < moduleLabels_.size())
+      out << moduleLabels_[module];
+    else
+      out << "[framework]";
+    for (auto it = stack.begin() + 1; it != stack.end(); ++it) {
+      auto symbol = symbols.find(*it);
+      if (symbol == symbols.end())
+        symbol = symbols.emplace(*it, symbolName(*it)).first;
+      out << ';' << symbol->second;
+    }
+    out << ' ' << count << '\n';
+  }
+  out.close();
+
+  std::vector<unsigned int> order;
+  for (unsigned int i = 0; i < perModule.size(); ++i)
+    if (perModule[i] > 0)
+      order.push_back(i);
+  std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return perModule[a] > perModule[b]; });
+
+  LogAbsolute out_log{"SamplingProfiler"};
+  out_log << "SamplingProfiler> " << total << " samples from " << threads_.size() << " threads written to "
+          << fileName_ << ", " << dropped << " dropped\n";
+  for (unsigned int i : order)
+    out_log << "SamplingProfiler> " << perModule[i] << " " << moduleLabels_[i] << '\n';
+}
+
+DEFINE_FWK_SERVICE(SamplingProfiler);
@@ -0,0 +1,13 @@
+#!/bin/bash
+
+function die { echo Failure $1: status $2 ; exit $2 ; }
+
+rm -f test_SamplingProfiler.folded
+cmsRun ${SCRAM_TEST_PATH}/test_SamplingProfiler_cfg.py &> test_SamplingProfiler.log || die "cmsRun test_SamplingProfiler_cfg.py" $?
+
+grep "SamplingProfiler>" test_SamplingProfiler.log || die "Check for the SamplingProfiler summary" $?
+# the samples are attributed to the modules, and written as "label;frame;...;frame count"
+for LABEL in busy1 busy2; do
+  grep -E "^${LABEL};.* [0-9]+$" test_SamplingProfiler.folded > /dev/null || die "Check for samples of ${LABEL}" $?
+done
+exit 0
@@ -0,0 +1,20 @@
+import FWCore.ParameterSet.Config as cms
+
+process = cms.Process("Test")
+
+process.source = cms.Source("EmptySource")
+
+process.maxEvents.input = 20
+
+process.options.numberOfThreads = 2
+process.options.numberOfStreams = 2
+
+process.busy1 = cms.EDProducer("BusyWaitIntProducer", ivalue = cms.int32(1), iterations = cms.uint32(10*1000*1000))
+process.busy2 = cms.EDProducer("BusyWaitIntProducer", ivalue = cms.int32(2), iterations = cms.uint32(10*1000*1000))
+
+process.p = cms.Path(process.busy1 + process.busy2)
+
+process.add_(cms.Service("SamplingProfiler",
+    fileName = cms.untracked.string("test_SamplingProfiler.folded"),
+    samplingFrequency = cms.untracked.uint32(1000)
+))
@@ -0,0 +1,37 @@
+#ifndef perf_counters_h
+#define perf_counters_h
+
+#include <array>
+#include <cstdint>
+
+// Per-thread hardware performance counters, read as a single perf_event_open group:
+// instructions, cycles, last level cache misses and branch mispredictions.
+// The counters are opened lazily by each thread the first time it reads them, after enable() has been called.
+class perf_counters {
+public:
+  enum counter : unsigned int { instructions, cycles, cache_misses, branch_misses };
+  static constexpr unsigned int size = 4;
+  static constexpr std::array<const char*, size> names = {
+      {"instructions", "cycles", "cache_misses", "branch_misses"}};
+
+  using values = std::array<uint64_t, size>;
+
+  // a reading of the counters of a thread: the raw counts, and how long the counters have been enabled and
+  // actually running; the raw counts never decrease, while their estimate scaled for multiplexing might
+  struct reading {
+    values counts;
+    uint64_t time_enabled;
+    uint64_t time_running;
+  };
+
+  // try to open the counters for the current thread, and enable them for all threads if successful
+  static bool enable();
+  static bool is_enabled();
+  // read the counters for the current thread; all zeros if they are not enabled or not available
+  static void read(reading& counters);
+  // the counts between two readings of the same thread, scaled if the kernel had to multiplex the hardware
+  // counters in that interval
+  static values difference(reading const& start, reading const& stop);
+};
+
+#endif  // perf_counters_h
@@ -84,13 +84,15 @@ FastTimerService::Resources::Resources()
     : time_thread(boost::chrono::nanoseconds::zero()),
       time_real(boost::chrono::nanoseconds::zero()),
       allocated(0ul),
-      deallocated(0ul) {}
+      deallocated(0ul),
+      counters() {}
 
 void FastTimerService::Resources::reset() {
   time_thread = boost::chrono::nanoseconds::zero();
   time_real = boost::chrono::nanoseconds::zero();
   allocated = 0ul;
   deallocated = 0ul;
+  counters.fill(0ul);
 }
 
 FastTimerService::Resources& FastTimerService::Resources::operator+=(Resources const& other) {
@@ -98,6 +100,8 @@ FastTimerService::Resources& FastTimerService::Resources::operator+=(Resources c
   time_real += other.time_real;
   allocated += other.allocated;
   deallocated += other.deallocated;
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    counters[i] += other.counters[i];
   return *this;
 }
 
@@ -106,6 +110,8 @@ FastTimerService::Resources& FastTimerService::Resources::operator+=(AtomicResou
   time_real += boost::chrono::nanoseconds(other.time_real.load());
   allocated += other.allocated.load();
   deallocated += other.deallocated.load();
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    counters[i] += other.counters[i].load();
   return *this;
 }
 
@@ -127,19 +133,27 @@ FastTimerService::Resources FastTimerService::Resources::operator+(AtomicResourc
 // of results should yield the correct result.
 
 FastTimerService::AtomicResources::AtomicResources()
-    : time_thread(0ul), time_real(0ul), allocated(0ul), deallocated(0ul) {}
+    : time_thread(0ul), time_real(0ul), allocated(0ul), deallocated(0ul) {
+  for (auto& counter : counters)
+    counter = 0ul;
+}
 
 FastTimerService::AtomicResources::AtomicResources(AtomicResources const& other)
     : time_thread(other.time_thread.load()),
       time_real(other.time_real.load()),
       allocated(other.allocated.load()),
-      deallocated(other.deallocated.load()) {}
+      deallocated(other.deallocated.load()) {
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    counters[i] = other.counters[i].load();
+}
 
 void FastTimerService::AtomicResources::reset() {
   time_thread = 0ul;
   time_real = 0ul;
   allocated = 0ul;
   deallocated = 0ul;
+  for (auto& counter : counters)
+    counter = 0ul;
 }
 
 FastTimerService::AtomicResources& FastTimerService::AtomicResources::operator=(AtomicResources const& other) {
@@ -147,6 +161,8 @@ FastTimerService::AtomicResources& FastTimerService::AtomicResources::operator=(
   time_real = other.time_real.load();
   allocated = other.allocated.load();
   deallocated = other.deallocated.load();
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    counters[i] = other.counters[i].load();
   return *this;
 }
 
@@ -155,6 +171,8 @@ FastTimerService::AtomicResources& FastTimerService::AtomicResources::operator+=
   time_real += other.time_real.load();
   allocated += other.allocated.load();
   deallocated += other.deallocated.load();
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    counters[i] += other.counters[i].load();
   return *this;
 }
 
@@ -163,6 +181,8 @@ FastTimerService::AtomicResources& FastTimerService::AtomicResources::operator+=
   time_real += other.time_real.count();
   allocated += other.allocated;
   deallocated += other.deallocated;
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    counters[i] += other.counters[i];
   return *this;
 }
 
@@ -319,6 +339,7 @@ void FastTimerService::Measurement::measure() noexcept {
   time_real = boost::chrono::high_resolution_clock::now();
   allocated = memory_usage::allocated();
   deallocated = memory_usage::deallocated();
+  perf_counters::read(counters);
 }
 
 void FastTimerService::Measurement::measure_and_store(Resources& store) noexcept {
@@ -329,14 +350,18 @@ void FastTimerService::Measurement::measure_and_store(Resources& store) noexcept
   auto new_time_real = boost::chrono::high_resolution_clock::now();
   auto new_allocated = memory_usage::allocated();
   auto new_deallocated = memory_usage::deallocated();
+  perf_counters::reading new_counters;
+  perf_counters::read(new_counters);
   store.time_thread = new_time_thread - time_thread;
   store.time_real = new_time_real - time_real;
   store.allocated = new_allocated - allocated;
   store.deallocated = new_deallocated - deallocated;
+  store.counters = perf_counters::difference(counters, new_counters);
   time_thread = new_time_thread;
   time_real = new_time_real;
   allocated = new_allocated;
   deallocated = new_deallocated;
+  counters = new_counters;
 }
 
 void FastTimerService::Measurement::measure_and_accumulate(Resources& store) noexcept {
@@ -347,14 +372,20 @@ void FastTimerService::Measurement::measure_and_accumulate(Resources& store) noe
   auto new_time_real = boost::chrono::high_resolution_clock::now();
   auto new_allocated = memory_usage::allocated();
   auto new_deallocated = memory_usage::deallocated();
+  perf_counters::reading new_counters;
+  perf_counters::read(new_counters);
   store.time_thread += new_time_thread - time_thread;
   store.time_real += new_time_real - time_real;
   store.allocated += new_allocated - allocated;
   store.deallocated += new_deallocated - deallocated;
+  auto delta_counters = perf_counters::difference(counters, new_counters);
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    store.counters[i] += delta_counters[i];
   time_thread = new_time_thread;
   time_real = new_time_real;
   allocated = new_allocated;
   deallocated = new_deallocated;
+  counters = new_counters;
 }
 
 void FastTimerService::Measurement::measure_and_accumulate(AtomicResources& store) noexcept {
@@ -365,14 +396,20 @@ void FastTimerService::Measurement::measure_and_accumulate(AtomicResources& stor
   auto new_time_real = boost::chrono::high_resolution_clock::now();
   auto new_allocated = memory_usage::allocated();
   auto new_deallocated = memory_usage::deallocated();
+  perf_counters::reading new_counters;
+  perf_counters::read(new_counters);
   store.time_thread += boost::chrono::duration_cast<boost::chrono::nanoseconds>(new_time_thread - time_thread).count();
   store.time_real += boost::chrono::duration_cast<boost::chrono::nanoseconds>(new_time_real - time_real).count();
   store.allocated += new_allocated - allocated;
   store.deallocated += new_deallocated - deallocated;
+  auto delta_counters = perf_counters::difference(counters, new_counters);
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    store.counters[i] += delta_counters[i];
   time_thread = new_time_thread;
   time_real = new_time_real;
   allocated = new_allocated;
   deallocated = new_deallocated;
+  counters = new_counters;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -599,6 +636,15 @@ void FastTimerService::PlotsPerPath::book(dqm::reco::DQMStore::IBooker& booker,
     module_deallocated_total_->setYTitle("memory [kB]");
     module_deallocated_total_->setStatOverflows(kTRUE);
   }
+  if (perf_counters::is_enabled()) {
+    for (unsigned int i = 0; i < perf_counters::size; ++i) {
+      std::string name = perf_counters::names[i];
+      module_counters_total_[i] =
+          booker.book1DD("module_" + name + "_total", "total " + name, bins, -0.5, bins - 0.5);
+      module_counters_total_[i]->setYTitle(name);
+      module_counters_total_[i]->setStatOverflows(kTRUE);
+    }
+  }
   for (unsigned int bin : boost::irange(0u, bins)) {
     auto const& module = job[path.modules_and_dependencies_[bin]];
     std::string const& label =
@@ -610,6 +656,9 @@ void FastTimerService::PlotsPerPath::book(dqm::reco::DQMStore::IBooker& booker,
       module_allocated_total_->setBinLabel(bin + 1, label);
       module_deallocated_total_->setBinLabel(bin + 1, label);
     }
+    for (auto* counter_total : module_counters_total_)
+      if (counter_total)
+        counter_total->setBinLabel(bin + 1, label);
   }
   module_counter_->setBinLabel(bins + 1, "");
 
@@ -640,6 +689,10 @@ void FastTimerService::PlotsPerPath::fill(ProcessCallGraph::PathType const& desc
 
     if (module_deallocated_total_)
       module_deallocated_total_->Fill(i, kB(module.total.deallocated));
+
+    for (unsigned int c = 0; c < perf_counters::size; ++c)
+      if (module_counters_total_[c])
+        module_counters_total_[c]->Fill(i, static_cast<double>(module.total.counters[c]));
   }
   if (module_counter_ and path.status)
     module_counter_->Fill(path.last);
@@ -817,6 +870,11 @@ FastTimerService::FastTimerService(const edm::ParameterSet& config, edm::Activit
       highlight_module_psets_(config.getUntrackedParameter<std::vector<edm::ParameterSet>>("highlightModules")),
       highlight_modules_(highlight_module_psets_.size())  // filled in postBeginJob()
 {
+  // open the hardware counters before the per-thread measurements are created
+  if (config.getUntrackedParameter<bool>("enableHardwareCounters") and not perf_counters::enable())
+    edm::LogWarning("FastTimerService")
+        << "The hardware performance counters are not available, they will not be measured";
+
   // start observing when a thread enters or leaves the TBB global thread arena
   tbb::task_scheduler_observer::observe();
 
@@ -1390,13 +1448,18 @@ json FastTimerService::encodeToJSON(std::string const& type,
                                     std::string const& label,
                                     unsigned int events,
                                     T const& data) const {
-  return json{{"type", type},
-              {"label", label},
-              {"events", events},
-              {"time_thread", ms(data.time_thread)},
-              {"time_real", ms(data.time_real)},
-              {"mem_alloc", kB(data.allocated)},
-              {"mem_free", kB(data.deallocated)}};
+  json j{{"type", type},
+         {"label", label},
+         {"events", events},
+         {"time_thread", ms(data.time_thread)},
+         {"time_real", ms(data.time_real)},
+         {"mem_alloc", kB(data.allocated)},
+         {"mem_free", kB(data.deallocated)}};
+  if (perf_counters::is_enabled()) {
+    for (unsigned int i = 0; i < perf_counters::size; ++i)
+      j[perf_counters::names[i]] = static_cast<uint64_t>(data.counters[i]);
+  }
+  return j;
 }
 
 json FastTimerService::encodeToJSON(edm::ModuleDescription const& module, ResourcesPerModule const& data) const {
@@ -1411,6 +1474,12 @@ void FastTimerService::writeSummaryJSON(ResourcesPerJob const& data, std::string
                                 json{{"time_thread", "cpu time"}},
                                 json{{"mem_alloc", "allocated memory"}},
                                 json{{"mem_free", "deallocated memory"}}});
+  if (perf_counters::is_enabled()) {
+    j["resources"].push_back(json{{"instructions", "instructions"}});
+    j["resources"].push_back(json{{"cycles", "cpu cycles"}});
+    j["resources"].push_back(json{{"cache_misses", "last level cache misses"}});
+    j["resources"].push_back(json{{"branch_misses", "branch mispredictions"}});
+  }
 
   // write the resources used by the job
   j["total"] = encodeToJSON("Job",
@@ -1811,6 +1880,8 @@ void FastTimerService::fillDescriptions(edm::ConfigurationDescriptions& descript
   //desc.addUntracked<bool>("writeJSONByRun", false);
   desc.addUntracked<bool>("writeJSONSummary", false);
   desc.addUntracked<std::string>("jsonFileName", "resources.json");
+  // hardware performance counters (instructions, cycles, cache misses, branch mispredictions), if available
+  desc.addUntracked<bool>("enableHardwareCounters", false);
   // DQM configuration
   desc.addUntracked<bool>("enableDQM", true);
   desc.addUntracked<bool>("enableDQMbyModule", false);
@@ -6,6 +6,7 @@
 #include <pthread.h>
 
 // C++ headers
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <map>
@@ -45,6 +46,7 @@ using json = nlohmann::json;
 #include "DataFormats/Provenance/interface/ModuleDescription.h"
 #include "DQMServices/Core/interface/DQMStore.h"
 #include "HLTrigger/Timer/interface/ProcessCallGraph.h"
+#include "HLTrigger/Timer/interface/perf_counters.h"
 
 /*
 procesing time is divided into
@@ -210,6 +212,7 @@ private:
     boost::chrono::high_resolution_clock::time_point time_real;
     uint64_t allocated;
     uint64_t deallocated;
+    perf_counters::reading counters;
   };
 
   // highlight a group of modules
@@ -235,6 +238,7 @@ private:
     boost::chrono::nanoseconds time_real;
     uint64_t allocated;
     uint64_t deallocated;
+    perf_counters::values counters;  // hardware counters, all zeros unless enabled
   };
 
   // atomic version of Resources
@@ -256,6 +260,7 @@ private:
     std::atomic<boost::chrono::nanoseconds::rep> time_real;
     std::atomic<uint64_t> allocated;
     std::atomic<uint64_t> deallocated;
+    std::array<std::atomic<uint64_t>, perf_counters::size> counters;
   };
 
   // resources associated to each module, path, process and job
@@ -387,6 +392,8 @@ private:
     dqm::reco::MonitorElement* module_time_real_total_ = nullptr;    // TH1D
     dqm::reco::MonitorElement* module_allocated_total_ = nullptr;    // TH1D
     dqm::reco::MonitorElement* module_deallocated_total_ = nullptr;  // TH1D
+    // hardware counters for each module and their dependencies, if enabled
+    std::array<dqm::reco::MonitorElement*, perf_counters::size> module_counters_total_ = {};  // TH1D
   };
 
   class PlotsPerProcess {
@@ -0,0 +1,133 @@
+#include <array>
+#include <atomic>
+#include <cstring>
+
+#include <boost/predef/os.h>
+
+#if BOOST_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "HLTrigger/Timer/interface/perf_counters.h"
+
+namespace {
+  std::atomic<bool> enabled = false;
+
+#if BOOST_OS_LINUX
+  // the generic hardware events, in the order of perf_counters::counter;
+  // on most processors PERF_COUNT_HW_CACHE_MISSES counts the last level cache misses
+  constexpr std::array<uint64_t, perf_counters::size> events = {
+      {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES}};
+
+  int open_counter(uint64_t event, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(perf_event_attr));
+    attr.size = sizeof(perf_event_attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = event;
+    // count only the user space activity, so that no special privileges are needed
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // measure the calling thread, on any cpu
+    return ::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+  }
+
+  // the counters of a single thread, opened as a group so they can be read with a single system call
+  class thread_counters {
+  public:
+    thread_counters() {
+      fds_.fill(-1);
+      for (unsigned int i = 0; i < perf_counters::size; ++i) {
+        // the first counter is the group leader
+        fds_[i] = open_counter(events[i], fds_[0]);
+        if (fds_[i] < 0) {
+          close();
+          return;
+        }
+      }
+    }
+
+    ~thread_counters() { close(); }
+
+    thread_counters(thread_counters const&) = delete;
+    thread_counters& operator=(thread_counters const&) = delete;
+
+    bool valid() const { return fds_[0] >= 0; }
+
+    bool read(perf_counters::reading& counters) const {
+      struct {
+        uint64_t nr;
+        uint64_t time_enabled;
+        uint64_t time_running;
+        uint64_t values[perf_counters::size];
+      } data;
+
+      if (not valid() or ::read(fds_[0], &data, sizeof(data)) != sizeof(data))
+        return false;
+
+      for (unsigned int i = 0; i < perf_counters::size; ++i)
+        counters.counts[i] = data.values[i];
+      counters.time_enabled = data.time_enabled;
+      counters.time_running = data.time_running;
+      return true;
+    }
+
+  private:
+    void close() {
+      for (int& fd : fds_) {
+        if (fd >= 0)
+          ::close(fd);
+        fd = -1;
+      }
+    }
+
+    std::array<int, perf_counters::size> fds_;
+  };
+
+  // opened the first time it is used by each thread, closed when the thread exits
+  thread_counters& this_thread_counters() {
+    thread_local thread_counters counters;
+    return counters;
+  }
+#endif  // BOOST_OS_LINUX
+
+}  // namespace
+
+bool perf_counters::enable() {
+#if BOOST_OS_LINUX
+  if (this_thread_counters().valid())
+    enabled = true;
+#endif  // BOOST_OS_LINUX
+  return enabled;
+}
+
+bool perf_counters::is_enabled() { return enabled; }
+
+void perf_counters::read(reading& counters) {
+#if BOOST_OS_LINUX
+  if (enabled and this_thread_counters().read(counters))
+    return;
+#endif  // BOOST_OS_LINUX
+  counters.counts.fill(0);
+  counters.time_enabled = 0;
+  counters.time_running = 0;
+}
+
+perf_counters::values perf_counters::difference(reading const& start, reading const& stop) {
+  values result;
+  for (unsigned int i = 0; i < size; ++i)
+    result[i] = stop.counts[i] - start.counts[i];
+
+  // scale the counts if the kernel had to multiplex the hardware counters during the interval
+  uint64_t enabled = stop.time_enabled - start.time_enabled;
+  uint64_t running = stop.time_running - start.time_running;
+  if (running > 0 and running < enabled) {
+    double scale = static_cast<double>(enabled) / running;
+    for (auto& value : result)
+      value = static_cast<uint64_t>(value * scale);
+  }
+  return result;
+}
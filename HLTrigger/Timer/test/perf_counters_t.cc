@@ -0,0 +1,62 @@
+#include <cmath>
+#include <iostream>
+
+#include "HLTrigger/Timer/interface/perf_counters.h"
+
+void print_counters(perf_counters::values const& counters) {
+  for (unsigned int i = 0; i < perf_counters::size; ++i)
+    std::cout << "\t" << perf_counters::names[i] << ": " << counters[i] << std::endl;
+}
+
+int main(void) {
+  // the difference is scaled by the fraction of the interval during which the counters were running
+  {
+    perf_counters::reading start{{{1000, 2000, 30, 40}}, 100, 100};
+    perf_counters::reading stop{{{1500, 3000, 30, 50}}, 300, 200};
+    perf_counters::values expected{{1000, 2000, 0, 20}};
+    if (perf_counters::difference(start, stop) != expected) {
+      std::cerr << "error: wrong scaling of the difference between two readings" << std::endl;
+      return 1;
+    }
+  }
+
+  if (not perf_counters::enable()) {
+    // perf_event_open may be forbidden by the kernel settings, or not supported by a virtual machine
+    std::cout << "hardware performance counters are not available, skipping the test" << std::endl;
+    return 0;
+  }
+
+  perf_counters::reading start, stop;
+  volatile double sum = 0.;
+
+  std::cout << "hardware performance counters for 10^6 square roots:" << std::endl;
+  perf_counters::read(start);
+  for (int i = 0; i < 1000000; ++i)
+    sum = sum + std::sqrt(static_cast<double>(i));
+  perf_counters::read(stop);
+
+  if (stop.time_running == start.time_running) {
+    // the counters were never scheduled on the cpu, e.g. because they are all used by other processes
+    std::cout << "hardware performance counters were not scheduled, skipping the test" << std::endl;
+    return 0;
+  }
+
+  // the raw counts must never decrease, so the difference between two readings cannot wrap around
+  for (unsigned int i = 0; i < perf_counters::size; ++i) {
+    if (stop.counts[i] < start.counts[i]) {
+      std::cerr << "error: the raw " << perf_counters::names[i] << " count decreased" << std::endl;
+      return 1;
+    }
+  }
+
+  auto counters = perf_counters::difference(start, stop);
+  print_counters(counters);
+
+  // each iteration executes several instructions
+  if (counters[perf_counters::instructions] < 1000000 or counters[perf_counters::cycles] == 0) {
+    std::cerr << "error: too few instructions or cycles counted" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
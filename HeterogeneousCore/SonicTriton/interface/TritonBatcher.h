@@ -0,0 +1,89 @@
+#ifndef HeterogeneousCore_SonicTriton_TritonBatcher
+#define HeterogeneousCore_SonicTriton_TritonBatcher
+
+#include "HeterogeneousCore/SonicTriton/interface/TritonService.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "grpc_client.h"
+
+//combines the requests sent for the same model by the clients of different streams into requests with larger batches:
+//pending requests are sent together once maxRequests of them are waiting, once they fill the model max batch size,
+//or once the oldest one has waited for the timeout (in microseconds)
+//up to maxInFlight combined requests are sent to the server at the same time; new requests wait while all are in flight
+class TritonBatcher {
+public:
+  //one input of a request with a rectangular batch: shape includes the outer dimension (batch size),
+  //and each batch entry is a contiguous block of byteSizePerBatch bytes
+  struct Input {
+    std::string name;
+    std::string dname;
+    std::vector<int64_t> shape;
+    size_t byteSizePerBatch;
+    std::vector<const uint8_t*> batches;
+  };
+  //called with the result of the combined request and the position of the first batch entry of this request in it
+  using Callback =
+      std::function<void(std::shared_ptr<triton::client::InferResult>, unsigned, const triton::client::Error&)>;
+
+  TritonBatcher(const TritonService::Server& server,
+                const triton::client::InferOptions& options,
+                const std::vector<std::string>& outputs,
+                unsigned maxBatchSize,
+                unsigned maxRequests,
+                unsigned timeout,
+                unsigned maxInFlight,
+                grpc_compression_algorithm compressionAlgo,
+                bool verbose);
+  ~TritonBatcher();
+
+  //the input data must stay valid until the callback is called
+  void submit(std::vector<Input> inputs, Callback callback);
+
+private:
+  struct Request {
+    std::vector<Input> inputs;
+    unsigned batchSize;
+    Callback callback;
+    std::chrono::steady_clock::time_point time;
+  };
+
+  //helpers
+  void run();
+  unsigned next(bool& complete) const;
+  void send(std::shared_ptr<std::vector<Request>> requests);
+  void release();
+  static bool compatible(const Request& a, const Request& b);
+  static void distribute(const std::vector<Request>& requests,
+                         std::shared_ptr<triton::client::InferResult> result,
+                         const triton::client::Error& err);
+
+  //members
+  triton::client::InferOptions options_;
+  unsigned maxBatchSize_;
+  unsigned maxRequests_;
+  std::chrono::microseconds timeout_;
+  unsigned maxInFlight_;
+  grpc_compression_algorithm compressionAlgo_;
+  bool verbose_;
+  std::unique_ptr<triton::client::InferenceServerGrpcClient> client_;
+  std::vector<std::unique_ptr<triton::client::InferRequestedOutput>> outputs_;
+  std::vector<const triton::client::InferRequestedOutput*> outputsTriton_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::vector<Request> pending_;
+  unsigned inFlight_;
+  bool stop_;
+  std::thread thread_;
+};
+
+#endif
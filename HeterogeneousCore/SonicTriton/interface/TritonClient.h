@@ -6,11 +6,14 @@
 #include "HeterogeneousCore/SonicCore/interface/SonicClient.h"
 #include "HeterogeneousCore/SonicTriton/interface/TritonData.h"
 #include "HeterogeneousCore/SonicTriton/interface/TritonService.h"
+#include "HeterogeneousCore/SonicTriton/interface/TritonBatcher.h"
 
 #include <map>
 #include <vector>
 #include <string>
 #include <exception>
+#include <memory>
+#include <optional>
 #include <unordered_map>
 
 #include "grpc_client.h"
@@ -58,7 +61,8 @@ protected:
   bool noOuterDim() const { return noOuterDim_; }
   unsigned outerDim() const { return outerDim_; }
   unsigned nEntries() const;
-  void getResults(const std::vector<std::shared_ptr<triton::client::InferResult>>& results);
+  void getResults(const std::vector<std::shared_ptr<triton::client::InferResult>>& results,
+                  std::optional<unsigned> batchOffset = std::nullopt);
   void evaluate() override;
   template <typename F>
   bool handle_exception(F&& call);
@@ -86,6 +90,8 @@ protected:
   std::unique_ptr<triton::client::InferenceServerGrpcClient> client_;
   //stores timeout, model name and version
   std::vector<triton::client::InferOptions> options_;
+  //combines rectangular requests with the ones of other streams, if enabled
+  std::shared_ptr<TritonBatcher> batcher_;
 
 private:
   friend TritonInputData;
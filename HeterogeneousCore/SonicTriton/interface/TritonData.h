@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <memory>
 #include <atomic>
+#include <optional>
 #include <typeinfo>
 
 #include "grpc_client.h"
@@ -138,13 +139,22 @@ private:
     std::shared_ptr<Result> result_;
     unsigned offset_;
     const uint8_t* output_;
+    //input batch entries in heap memory, kept to combine them with other requests (see TritonBatcher)
+    std::vector<const uint8_t*> batches_;
+    //set if result_ combines several requests: position of the first batch entry of this request
+    std::optional<unsigned> batchOffset_;
   };
 
   //private accessors only used internally or by client
   void checkShm() {}
   unsigned fullLoc(unsigned loc) const;
   void reset();
-  void setResult(std::shared_ptr<Result> result, unsigned entry = 0) { entries_[entry].result_ = result; }
+  void setResult(std::shared_ptr<Result> result,
+                 unsigned entry = 0,
+                 std::optional<unsigned> batchOffset = std::nullopt) {
+    entries_[entry].result_ = result;
+    entries_[entry].batchOffset_ = batchOffset;
+  }
   IO* data(unsigned entry = 0) { return entries_[entry].data_.get(); }
   void updateMem(size_t size);
   void computeSizes();
@@ -11,6 +11,8 @@
 #include <functional>
 #include <utility>
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 #include "grpc_client.h"
 
@@ -26,6 +28,8 @@ namespace edm {
   }
 }  // namespace edm
 
+class TritonBatcher;
+
 enum class TritonServerType { Remote = 0, LocalCPU = 1, LocalGPU = 2 };
 
 class TritonService {
@@ -70,6 +74,7 @@ public:
               std::to_string(pset.getUntrackedParameter<unsigned>("port"))),
           isFallback(pset.getUntrackedParameter<std::string>("name") == fallbackName),
           useSsl(pset.getUntrackedParameter<bool>("useSsl")),
+          sharedMemory(pset.getUntrackedParameter<bool>("sharedMemory")),
           type(TritonServerType::Remote) {
       if (useSsl) {
         sslOptions.root_certificates = pset.getUntrackedParameter<std::string>("rootCertificates");
@@ -78,12 +83,18 @@ public:
       }
     }
     Server(const std::string& name_, const std::string& url_, TritonServerType type_)
-        : url(url_), isFallback(name_ == fallbackName), useSsl(false), type(type_) {}
+        : url(url_),
+          isFallback(name_ == fallbackName),
+          useSsl(false),
+          sharedMemory(type_ != TritonServerType::Remote),
+          type(type_) {}
 
     //members
     std::string url;
     bool isFallback;
     bool useSsl;
+    //the server can map the shared memory regions of this process (same host and IPC namespace)
+    bool sharedMemory;
     TritonServerType type;
     triton::client::SslOptions sslOptions;
     std::unordered_set<std::string> models;
@@ -114,6 +125,9 @@ public:
   Server serverInfo(const std::string& model, const std::string& preferred = "") const;
   const std::string& pid() const { return pid_; }
   void notifyCallStatus(bool status) const;
+  //clients of different streams that aggregate their requests for the same model share a batcher, identified by key
+  std::shared_ptr<TritonBatcher> batcher(const std::string& key,
+                                         const std::function<std::shared_ptr<TritonBatcher>()>& create);
 
   static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
 
@@ -142,6 +156,9 @@ private:
   std::unordered_map<std::string, Model> models_;
   std::unordered_map<unsigned, Module> modules_;
   int numberOfThreads_;
+  //batchers are owned by the clients that use them
+  std::mutex batcherMutex_;
+  std::unordered_map<std::string, std::weak_ptr<TritonBatcher>> batchers_;
 };
 
 #endif
@@ -0,0 +1,198 @@
+#include "HeterogeneousCore/SonicTriton/interface/TritonBatcher.h"
+#include "HeterogeneousCore/SonicTriton/interface/triton_utils.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace tc = triton::client;
+
+TritonBatcher::TritonBatcher(const TritonService::Server& server,
+                             const tc::InferOptions& options,
+                             const std::vector<std::string>& outputs,
+                             unsigned maxBatchSize,
+                             unsigned maxRequests,
+                             unsigned timeout,
+                             unsigned maxInFlight,
+                             grpc_compression_algorithm compressionAlgo,
+                             bool verbose)
+    : options_(options),
+      maxBatchSize_(maxBatchSize),
+      maxRequests_(maxRequests),
+      timeout_(timeout),
+      maxInFlight_(std::max(1u, maxInFlight)),
+      compressionAlgo_(compressionAlgo),
+      verbose_(verbose),
+      inFlight_(0),
+      stop_(false) {
+  //separate connection: the combined requests are sent from the thread of the batcher
+  TRITON_THROW_IF_ERROR(
+      tc::InferenceServerGrpcClient::Create(&client_, server.url, false, server.useSsl, server.sslOptions),
+      "TritonBatcher(): unable to create inference context",
+      server.isFallback);
+
+  for (const auto& oname : outputs) {
+    tc::InferRequestedOutput* output;
+    TRITON_THROW_IF_ERROR(tc::InferRequestedOutput::Create(&output, oname),
+                          "TritonBatcher(): unable to create output " + oname,
+                          false);
+    outputs_.emplace_back(output);
+    outputsTriton_.push_back(output);
+  }
+
+  thread_ = std::thread([this]() { run(); });
+}
+
+TritonBatcher::~TritonBatcher() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  thread_.join();
+  //the client must outlive the combined requests in flight
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this]() { return inFlight_ == 0; });
+}
+
+void TritonBatcher::submit(std::vector<Input> inputs, Callback callback) {
+  unsigned batchSize = inputs.empty() ? 0 : inputs.front().shape.front();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    pending_.push_back({std::move(inputs), batchSize, std::move(callback), std::chrono::steady_clock::now()});
+  }
+  cond_.notify_all();
+}
+
+void TritonBatcher::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this]() { return stop_ or !pending_.empty(); });
+    //remaining requests are sent right away when stopping
+    if (pending_.empty())
+      break;
+
+    //wait for more requests, until the oldest one has waited for the timeout
+    bool complete(false);
+    auto deadline = pending_.front().time + timeout_;
+    cond_.wait_until(lock, deadline, [&]() {
+      next(complete);
+      return stop_ or complete;
+    });
+
+    //wait for a combined request to finish if too many are in flight; meanwhile, more requests can be added
+    cond_.wait(lock, [this]() { return inFlight_ < maxInFlight_; });
+
+    auto nRequests = next(complete);
+    auto requests = std::make_shared<std::vector<Request>>(std::make_move_iterator(pending_.begin()),
+                                                           std::make_move_iterator(pending_.begin() + nRequests));
+    pending_.erase(pending_.begin(), pending_.begin() + nRequests);
+    ++inFlight_;
+
+    lock.unlock();
+    send(std::move(requests));
+    lock.lock();
+  }
+}
+
+//number of pending requests that go in the next combined request (always at least one),
+//and whether the combined request is complete (no other request can be added to it)
+unsigned TritonBatcher::next(bool& complete) const {
+  unsigned nRequests = 0;
+  unsigned batchSize = 0;
+  for (const auto& request : pending_) {
+    if (nRequests > 0 and (nRequests == maxRequests_ or batchSize + request.batchSize > maxBatchSize_ or
+                           !compatible(pending_.front(), request))) {
+      complete = true;
+      return nRequests;
+    }
+    ++nRequests;
+    batchSize += request.batchSize;
+  }
+  complete = nRequests >= maxRequests_ or batchSize >= maxBatchSize_;
+  return nRequests;
+}
+
+//the requests can be concatenated along the outer dimension
+bool TritonBatcher::compatible(const Request& a, const Request& b) {
+  if (a.inputs.size() != b.inputs.size())
+    return false;
+  for (unsigned i = 0; i < a.inputs.size(); ++i) {
+    const auto& ia = a.inputs[i];
+    const auto& ib = b.inputs[i];
+    if (ia.name != ib.name or ia.dname != ib.dname or ia.byteSizePerBatch != ib.byteSizePerBatch or
+        !std::equal(ia.shape.begin() + 1, ia.shape.end(), ib.shape.begin() + 1, ib.shape.end()))
+      return false;
+  }
+  return true;
+}
+
+void TritonBatcher::send(std::shared_ptr<std::vector<Request>> requests) {
+  unsigned batchSize = 0;
+  for (const auto& request : *requests)
+    batchSize += request.batchSize;
+  if (verbose_)
+    edm::LogInfo("TritonBatcher") << options_.model_name_ << ": sending " << requests->size()
+                                  << " request(s) with combined batch size " << batchSize;
+
+  //the input data are copied into the request when it is launched
+  tc::Error err;
+  std::vector<std::unique_ptr<tc::InferInput>> inputs;
+  std::vector<tc::InferInput*> inputsTriton;
+  const auto& first = requests->front().inputs;
+  for (unsigned i = 0; i < first.size() and err.IsOk(); ++i) {
+    auto shape = first[i].shape;
+    shape[0] = batchSize;
+    tc::InferInput* input;
+    err = tc::InferInput::Create(&input, first[i].name, shape, first[i].dname);
+    if (!err.IsOk())
+      break;
+    inputs.emplace_back(input);
+    inputsTriton.push_back(input);
+    for (const auto& request : *requests) {
+      const auto& requestInput = request.inputs[i];
+      //avoid copying empty input
+      if (requestInput.byteSizePerBatch == 0)
+        continue;
+      for (const auto* batch : requestInput.batches) {
+        if (err.IsOk())
+          err = input->AppendRaw(batch, requestInput.byteSizePerBatch);
+      }
+    }
+  }
+
+  if (err.IsOk())
+    err = client_->AsyncInfer(
+        [this, requests](tc::InferResult* resultTmp) {
+          //immediately convert to shared_ptr
+          std::shared_ptr<tc::InferResult> result(resultTmp);
+          release();
+          distribute(*requests, result, result->RequestStatus());
+        },
+        options_,
+        inputsTriton,
+        outputsTriton_,
+        tc::Headers(),
+        compressionAlgo_);
+
+  if (!err.IsOk()) {
+    release();
+    distribute(*requests, nullptr, err);
+  }
+}
+
+void TritonBatcher::release() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  --inFlight_;
+  cond_.notify_all();
+}
+
+void TritonBatcher::distribute(const std::vector<Request>& requests,
+                               std::shared_ptr<tc::InferResult> result,
+                               const tc::Error& err) {
+  unsigned offset = 0;
+  for (const auto& request : requests) {
+    request.callback(result, offset, err);
+    offset += request.batchSize;
+  }
+}
@@ -68,9 +68,12 @@ TritonClient::TritonClient(const edm::ParameterSet& params, const std::string& d
   serverType_ = server.type;
   if (verbose_)
     edm::LogInfo(fullDebugName_) << "Using server: " << server.url;
-  //enforce sync mode for fallback CPU server to avoid contention
+  //shared memory regions can only be used if the server can map them
+  useSharedMemory_ &= server.sharedMemory;
+  const unsigned aggregateRequests = params.getUntrackedParameter<unsigned>("aggregateRequests");
+  //enforce sync mode for fallback CPU server to avoid contention, unless requests are combined across streams
   //todo: could enforce async mode otherwise (unless mode was specified by user?)
-  if (serverType_ == TritonServerType::LocalCPU)
+  if (serverType_ == TritonServerType::LocalCPU and aggregateRequests <= 1)
     setMode(SonicMode::Sync);
   isLocal_ = serverType_ == TritonServerType::LocalCPU or serverType_ == TritonServerType::LocalGPU;
 
@@ -121,6 +124,19 @@ TritonClient::TritonClient(const edm::ParameterSet& params, const std::string& d
   //propagate batch size
   setBatchSize(1);
 
+  //requests of different streams are combined along the outer dimension, in heap memory
+  bool aggregate = aggregateRequests > 1;
+  if (aggregate and noOuterDim_) {
+    edm::LogWarning(fullDebugName_) << "Model " << options_[0].model_name_
+                                    << " does not support batching: requests will not be aggregated";
+    aggregate = false;
+  }
+  if (aggregate) {
+    if (mode_ != SonicMode::Async)
+      throw cms::Exception("Configuration") << "TritonClient(): aggregateRequests requires Async mode";
+    useSharedMemory_ = false;
+  }
+
   //compare model checksums to remote config to enforce versioning
   inference::ModelConfigResponse modelConfigResponse;
   TRITON_THROW_IF_ERROR(client_->ModelConfig(&modelConfigResponse, options_[0].model_name_, options_[0].model_version_),
@@ -224,12 +240,38 @@ TritonClient::TritonClient(const edm::ParameterSet& params, const std::string& d
     throw cms::Exception("MissingOutput")
         << "Some requested outputs were not available on the server: " << triton_utils::printColl(s_outputs);
 
+  //share a batcher with the clients of other streams that send the same requests to the same server
+  if (aggregate) {
+    std::vector<std::string> outputNames;
+    for (const auto& element : output_)
+      outputNames.push_back(element.first);
+    std::sort(outputNames.begin(), outputNames.end());
+    const unsigned aggregateTimeout = params.getUntrackedParameter<unsigned>("aggregateTimeout");
+    const unsigned maxRequestsInFlight = params.getUntrackedParameter<unsigned>("maxRequestsInFlight");
+    std::stringstream key;
+    key << server.url << " " << options_[0].model_name_ << " " << options_[0].model_version_ << " "
+        << triton_utils::printColl(outputNames, ",") << " " << options_[0].client_timeout_ << " " << compressionAlgo_
+        << " " << aggregateRequests << " " << aggregateTimeout << " " << maxRequestsInFlight;
+    batcher_ = ts->batcher(key.str(), [&]() {
+      return std::make_shared<TritonBatcher>(server,
+                                             options_[0],
+                                             outputNames,
+                                             maxOuterDim_,
+                                             aggregateRequests,
+                                             aggregateTimeout,
+                                             maxRequestsInFlight,
+                                             compressionAlgo_,
+                                             verbose_);
+    });
+  }
+
   //print model info
   std::stringstream model_msg;
   if (verbose_) {
     model_msg << "Model name: " << options_[0].model_name_ << "\n"
               << "Model version: " << options_[0].model_version_ << "\n"
-              << "Model max outer dim: " << (noOuterDim_ ? 0 : maxOuterDim_) << "\n";
+              << "Model max outer dim: " << (noOuterDim_ ? 0 : maxOuterDim_) << "\n"
+              << "Aggregated requests: " << (batcher_ ? aggregateRequests : 0) << "\n";
     edm::LogInfo(fullDebugName_) << model_msg.str() << io_msg.str();
   }
 }
@@ -338,7 +380,8 @@ bool TritonClient::handle_exception(F&& call) {
   }
 }
 
-void TritonClient::getResults(const std::vector<std::shared_ptr<tc::InferResult>>& results) {
+void TritonClient::getResults(const std::vector<std::shared_ptr<tc::InferResult>>& results,
+                              std::optional<unsigned> batchOffset) {
   for (unsigned i = 0; i < results.size(); ++i) {
     const auto& result = results[i];
     for (auto& [oname, output] : output_) {
@@ -352,7 +395,7 @@ void TritonClient::getResults(const std::vector<std::shared_ptr<tc::InferResult>
         output.setShape(tmp_shape, i);
       }
       //extend lifetime
-      output.setResult(result, i);
+      output.setResult(result, i, batchOffset);
       //compute size after getting all result entries
       if (i == results.size() - 1)
         output.computeSizes();
@@ -377,6 +420,42 @@ void TritonClient::evaluate() {
     return;
   }
 
+  //combine the request with the ones of other streams (ragged batches are sent on their own)
+  if (batcher_ and batchMode_ == TritonBatchMode::Rectangular) {
+    std::vector<TritonBatcher::Input> inputs;
+    inputs.reserve(input_.size());
+    for (auto& [iname, input] : input_) {
+      const auto& entry = input.entries_[0];
+      inputs.push_back({iname, input.dname(), entry.fullShape_, entry.byteSizePerBatch_, entry.batches_});
+    }
+
+    auto success = handle_exception([&]() {
+      for (auto& element : output_) {
+        element.second.prepare();
+      }
+    });
+    if (!success)
+      return;
+
+    //server-side statistics are not reported: the combined request includes other streams
+    batcher_->submit(std::move(inputs),
+                     [this](std::shared_ptr<tc::InferResult> result, unsigned batchOffset, const tc::Error& err) {
+                       auto success = handle_exception([&]() {
+                         TRITON_THROW_IF_ERROR(err, "evaluate(): unable to get combined result", isLocal_);
+                       });
+                       if (!success)
+                         return;
+
+                       //this request is a slice of the combined result
+                       success = handle_exception([&]() { getResults({result}, batchOffset); });
+                       if (!success)
+                         return;
+
+                       finish(true);
+                     });
+    return;
+  }
+
   //set up input pointers for triton (generalized for multi-request ragged batching case)
   //one vector<InferInput*> per request
   unsigned nEntriesVal = nEntries();
@@ -578,6 +657,11 @@ void TritonClient::fillPSetDescription(edm::ParameterSetDescription& iDesc) {
   descClient.ifValue(edm::ParameterDescription<std::string>("timeoutUnit", "seconds", false),
                      edm::allowedValues<std::string>("seconds", "milliseconds", "microseconds"));
   descClient.addUntracked<bool>("useSharedMemory", true);
+  //combine the requests of up to this number of streams into one request (Async mode only, 0 or 1 to disable)
+  descClient.addUntracked<unsigned>("aggregateRequests", 0);
+  //maximum time (in microseconds) that a request waits for others to be combined with
+  descClient.addUntracked<unsigned>("aggregateTimeout", 500);
+  descClient.addUntracked<unsigned>("maxRequestsInFlight", 2);
   descClient.addUntracked<std::string>("compression", "");
   descClient.addUntracked<std::vector<std::string>>("outputs", {});
   iDesc.add<edm::ParameterSetDescription>("Client", descClient);
@@ -140,7 +140,8 @@ void TritonData<IO>::computeSizes() {
 template <typename IO>
 void TritonData<IO>::updateMem(size_t size) {
   if (!memResource_ or size > memResource_->size()) {
-    if (useShm_ and client_->serverType() == TritonServerType::LocalCPU) {
+    //system shared memory for any server that can map it, except for the fallback GPU server (below)
+    if (useShm_ and client_->serverType() != TritonServerType::LocalGPU) {
       //avoid unnecessarily throwing in destructor
       if (memResource_)
         memResource_->close();
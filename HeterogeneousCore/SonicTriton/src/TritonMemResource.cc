@@ -43,6 +43,7 @@ TritonHeapResource<IO>::TritonHeapResource(TritonData<IO>* data, const std::stri
 
 template <>
 void TritonInputHeapResource::copyInput(const void* values, size_t offset, unsigned entry) {
+  data_->entries_[entry].batches_.push_back(reinterpret_cast<const uint8_t*>(values));
   TRITON_THROW_IF_ERROR(data_->entries_[entry].data_->AppendRaw(reinterpret_cast<const uint8_t*>(values),
                                                                 data_->entries_[entry].byteSizePerBatch_),
                         data_->name_ + " toServer(): unable to set data for batch entry " +
@@ -58,10 +59,21 @@ void TritonOutputHeapResource::copyOutput() {
   size_t contentByteSize = 0;
   for (auto& entry : data_->entries_) {
     size_t contentByteSizeEntry(0);
-    if (entry.totalByteSize_ > 0)
+    if (entry.totalByteSize_ > 0) {
       TRITON_THROW_IF_ERROR(entry.result_->RawData(data_->name_, &entry.output_, &contentByteSizeEntry),
                             data_->name_ + " fromServer(): unable to get raw",
                             false);
+      //combined result (see TritonBatcher): only keep the batch entries of this request
+      if (entry.batchOffset_) {
+        size_t begin = *entry.batchOffset_ * entry.byteSizePerBatch_;
+        if (begin + entry.totalByteSize_ > contentByteSizeEntry)
+          throw cms::Exception("TritonDataError")
+              << data_->name_ << " fromServer(): combined content byte size " << contentByteSizeEntry
+              << " too small for batch offset " << *entry.batchOffset_;
+        entry.output_ += begin;
+        contentByteSizeEntry = entry.totalByteSize_;
+      }
+    }
     contentByteSize += contentByteSizeEntry;
   }
   if (contentByteSize != data_->totalByteSize_) {
@@ -212,6 +212,19 @@ TritonService::Server TritonService::serverInfo(const std::string& model, const
   return server;
 }
 
+std::shared_ptr<TritonBatcher> TritonService::batcher(const std::string& key,
+                                                     const std::function<std::shared_ptr<TritonBatcher>()>& create) {
+  //clients are created in beginStream, which can run concurrently for different streams
+  std::lock_guard<std::mutex> guard(batcherMutex_);
+  auto& entry = batchers_[key];
+  auto batcher = entry.lock();
+  if (!batcher) {
+    batcher = create();
+    entry = batcher;
+  }
+  return batcher;
+}
+
 void TritonService::preBeginJob(edm::PathsAndConsumesOfModulesBase const&, edm::ProcessContext const&) {
   //only need fallback if there are unserved models
   if (!fallbackOpts_.enable or unservedModels_.empty())
@@ -371,6 +384,8 @@ void TritonService::fillDescriptions(edm::ConfigurationDescriptions& description
   validator.addUntracked<std::string>("rootCertificates", "");
   validator.addUntracked<std::string>("privateKey", "");
   validator.addUntracked<std::string>("certificateChain", "");
+  //enable only if the server shares the host and IPC namespace (/dev/shm) with this process
+  validator.addUntracked<bool>("sharedMemory", false);
 
   desc.addVPSetUntracked("servers", validator, {});
 
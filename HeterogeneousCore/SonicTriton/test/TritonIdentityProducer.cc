@@ -5,6 +5,7 @@
 #include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -14,7 +15,7 @@
 class TritonIdentityProducer : public TritonEDProducer<> {
 public:
   explicit TritonIdentityProducer(edm::ParameterSet const& cfg)
-      : TritonEDProducer<>(cfg), batchSizes_{1, 2, 0}, batchCounter_(0) {}
+      : TritonEDProducer<>(cfg), batchSizes_{1, 2, 0}, batchCounter_(0), ragged_(cfg.getParameter<bool>("ragged")) {}
   void acquire(edm::Event const& iEvent, edm::EventSetup const& iSetup, Input& iInput) override {
     //follow Triton QA tests for ragged input
     std::vector<std::vector<float>> value_lists{{2, 2}, {4, 4, 4, 4}, {1}, {3, 3, 3}};
@@ -23,13 +24,23 @@ public:
     batchCounter_ = (batchCounter_ + 1) % batchSizes_.size();
     auto& input1 = iInput.at("INPUT0");
     auto data1 = input1.allocate<float>();
-    for (unsigned i = 0; i < client_->batchSize(); ++i) {
-      (*data1)[i] = value_lists[i];
-      input1.setShape(0, (*data1)[i].size(), i);
+    if (ragged_) {
+      for (unsigned i = 0; i < client_->batchSize(); ++i) {
+        (*data1)[i] = value_lists[i];
+        input1.setShape(0, (*data1)[i].size(), i);
+      }
+    } else {
+      //same length for all batch entries, with values specific to the event (e.g. to check combined requests)
+      input1.setShape(0, 4);
+      float event = iEvent.id().event();
+      for (unsigned i = 0; i < client_->batchSize(); ++i) {
+        (*data1)[i] = {event, float(i), event, float(i)};
+      }
     }
 
     // convert to server format
     input1.toServer(data1);
+    input_ = data1;
   }
   void produce(edm::Event& iEvent, edm::EventSetup const& iSetup, Output const& iOutput) override {
     // check the results
@@ -43,13 +54,20 @@ public:
         msg << tmp[i][j] << " ";
       }
       msg << "\n";
+      //the model returns its input
+      const auto& expected = (*input_)[i];
+      if (!std::equal(tmp[i].begin(), tmp[i].end(), expected.begin(), expected.end()))
+        throw cms::Exception("TritonIdentityProducer")
+            << "output " << i << " differs from input " << triton_utils::printColl(expected);
     }
+    input_.reset();
   }
   ~TritonIdentityProducer() override = default;
 
   static void fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
     edm::ParameterSetDescription desc;
     TritonClient::fillPSetDescription(desc);
+    desc.add<bool>("ragged", true);
     //to ensure distinct cfi names
     descriptions.addWithDefaultLabel(desc);
   }
@@ -57,6 +75,8 @@ public:
 private:
   std::vector<unsigned> batchSizes_;
   unsigned batchCounter_;
+  bool ragged_;
+  TritonInputContainer<float> input_;
 };
 
 DEFINE_FWK_MODULE(TritonIdentityProducer);
@@ -38,6 +38,11 @@ parser.add_argument("--fallbackName", default="", type=str, help="name for fallb
 parser.add_argument("--unittest", default=False, action="store_true", help="unit test mode: reduce input sizes")
 parser.add_argument("--testother", default=False, action="store_true", help="also test gRPC communication if shared memory enabled, or vice versa")
 parser.add_argument("--noShm", default=False, action="store_true", help="disable shared memory")
+parser.add_argument("--serverShm", default=False, action="store_true", help="server (from address) can map the shared memory of this process")
+parser.add_argument("--aggregate", default=0, type=int, help="combine requests from up to this many streams (Async mode only)")
+parser.add_argument("--aggregateTimeout", default=500, type=int, help="maximum wait for requests to combine (microseconds)")
+parser.add_argument("--inFlight", default=2, type=int, help="maximum number of combined requests in flight")
+parser.add_argument("--rectangular", default=False, action="store_true", help="use rectangular instead of ragged batches for identity model")
 parser.add_argument("--compression", default="", type=str, choices=allowed_compression, help="enable I/O compression")
 parser.add_argument("--ssl", default=False, action="store_true", help="enable SSL authentication for server communication")
 parser.add_argument("--device", default="auto", type=str.lower, choices=allowed_devices, help="specify device for fallback server")
@@ -88,6 +93,7 @@ if len(options.address)>0:
             rootCertificates = cms.untracked.string(""),
             privateKey = cms.untracked.string(""),
             certificateChain = cms.untracked.string(""),
+            sharedMemory = cms.untracked.bool(options.serverShm),
         )
     )
 
@@ -100,7 +106,7 @@ modules = {
     "Analyzer": cms.EDAnalyzer,
 }
 
-keepMsgs = ['TritonClient','TritonService']
+keepMsgs = ['TritonClient','TritonService','TritonBatcher']
 
 for im,module in enumerate(options.modules):
     model = options.models[im]
@@ -119,6 +125,9 @@ for im,module in enumerate(options.modules):
                 allowedTries = cms.untracked.uint32(options.tries),
                 useSharedMemory = cms.untracked.bool(not options.noShm),
                 compression = cms.untracked.string(options.compression),
+                aggregateRequests = cms.untracked.uint32(options.aggregate),
+                aggregateTimeout = cms.untracked.uint32(options.aggregateTimeout),
+                maxRequestsInFlight = cms.untracked.uint32(options.inFlight),
             )
         )
     )
@@ -140,6 +149,8 @@ for im,module in enumerate(options.modules):
             processModule.edgeMin = cms.uint32(8000)
             processModule.edgeMax = cms.uint32(15000)
         processModule.brief = cms.bool(options.brief)
+    elif module=="TritonIdentityProducer":
+        processModule.ragged = cms.bool(not options.rectangular)
     process.p += processModule
     keepMsgs.extend([module,module+':TritonClient'])
     if options.testother:
@@ -2,6 +2,12 @@
 
 LOCALTOP=$1
 DEVICE=$2
+shift 2
+# modules to test and their options (default: graph modules with gRPC and shared memory)
+TESTARGS="$@"
+if [ -z "$TESTARGS" ]; then
+	TESTARGS="--modules TritonGraphProducer TritonGraphFilter TritonGraphAnalyzer --maxEvents 2 --testother"
+fi
 
 # the test is not possible if:
 
@@ -50,7 +56,7 @@ fi
 
 fallbackName=triton_server_instance_${DEVICE}
 tmpFile=$(mktemp -p ${LOCALTOP} SonicTritonTestXXXXXXXX.log)
-cmsRun ${LOCALTOP}/src/HeterogeneousCore/SonicTriton/test/tritonTest_cfg.py --modules TritonGraphProducer TritonGraphFilter TritonGraphAnalyzer --maxEvents 2 --unittest --verbose --device ${DEVICE} --testother --fallbackName ${fallbackName} >& $tmpFile
+cmsRun ${LOCALTOP}/src/HeterogeneousCore/SonicTriton/test/tritonTest_cfg.py ${TESTARGS} --unittest --verbose --device ${DEVICE} --fallbackName ${fallbackName} >& $tmpFile
 CMSEXIT=$?
 
 cat $tmpFile
@@ -45,6 +45,10 @@ public:
     return inTesla(gp);  // default dummy implementation
   }
 
+  /// Field values at n global points, in Tesla. Equivalent to calling inTesla for each point;
+  /// derived classes can override it to amortize the volume lookup over the batch.
+  virtual void inTeslaBatch(const GlobalPoint* gp, GlobalVector* result, unsigned int n) const;
+
   /// The nominal field value for this map in kGauss
   int nominalValue() const { return theNominalValue; }
 
@@ -11,6 +11,11 @@ MagneticField::MagneticField(const MagneticField& orig) = default;
 
 MagneticField::~MagneticField() = default;
 
+void MagneticField::inTeslaBatch(const GlobalPoint* gp, GlobalVector* result, unsigned int n) const {
+  for (unsigned int i = 0; i < n; ++i)
+    result[i] = inTesla(gp[i]);
+}
+
 void MagneticField::setNominalValue() {
   auto const at0z = inTesla(GlobalPoint(0.f, 0.f, 0.f)).z();
   theNominalValue = int(at0z * 10.f + 0.5f);
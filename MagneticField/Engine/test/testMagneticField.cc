@@ -9,6 +9,7 @@
  *  xyz = cartesian coordinates in cm (default)
  *  rpz_m = r, phi, Z in m
  *  xyz_m = cartesian in m 
+ *  For these types, the tested points are also evaluated in one call to inTeslaBatch, which must agree with inTesla.
  *  TOSCA = input test tables, searches for the corresponding volume/sector determined from the file name and path.
  *  TOSCAFileList = file with a list of TOSCA tables
  *  TOSCASecorComparison: compare each if the listed TOSCA txt tables with those of the other sectors
@@ -118,6 +119,7 @@ public:
 
   void writeValidationTable(int npoints, string filename);
   void validate(string filename, string type = "xyz");
+  void validateBatch(const vector<GlobalPoint>& points, const vector<GlobalVector>& values);
   void validateVsTOSCATable(string filename);
 
   const MagVolume6Faces* findVolume(GlobalPoint& gp);
@@ -205,6 +207,10 @@ void testMagneticField::validate(string filename, string type) {
   float bx, by, bz;
   GlobalPoint gp;
 
+  // tested points and values from inTesla, to be compared with inTeslaBatch
+  vector<GlobalPoint> points;
+  vector<GlobalVector> values;
+
   do {
     if (binary) {
       if (!(file.read((char*)&px, sizeof(float)) && file.read((char*)&py, sizeof(float)) &&
@@ -234,6 +240,8 @@ void testMagneticField::validate(string filename, string type) {
 
     GlobalVector oldB(bx, by, bz);
     GlobalVector newB = field->inTesla(gp);
+    points.push_back(gp);
+    values.push_back(newB);
     if ((newB - oldB).mag() > reso) {
       ++fail;
       float delta = (newB - oldB).mag();
@@ -263,7 +271,37 @@ void testMagneticField::validate(string filename, string type) {
     if (fail != 0)
       throw cms::Exception("RegressionFailure") << "MF regression found: " << fail << " failures";
     ;
+    validateBatch(points, values);
+  }
+}
+
+void testMagneticField::validateBatch(const vector<GlobalPoint>& points, const vector<GlobalVector>& values) {
+  // The same points in one batch, spanning the parametrized field and several volumes of the map
+  vector<GlobalVector> batch(points.size());
+  field->inTeslaBatch(points.data(), batch.data(), points.size());
+
+  int fail = 0;
+  float maxdelta = 0.;
+  for (unsigned int i = 0; i < points.size(); ++i) {
+    float delta = (batch[i] - values[i]).mag();
+    if (delta > maxdelta)
+      maxdelta = delta;
+    if (delta > reso) {
+      ++fail;
+      if (fail < 10) {
+        cout << " Batch discrepancy at: # " << i + 1 << " " << points[i] << " inTesla: " << values[i]
+             << " inTeslaBatch: " << batch[i] << endl;
+      } else if (fail == 10) {
+        cout << "..." << endl;
+      }
+    }
   }
+
+  cout << " testMagneticField::validateBatch: tested " << points.size() << " points " << fail
+       << " failures; max delta = " << maxdelta << endl
+       << endl;
+  if (fail != 0)
+    throw cms::Exception("RegressionFailure") << "MF batch evaluation differs from inTesla at " << fail << " points";
 }
 
 void testMagneticField::parseTOSCATablePath(string filename, int& volNo, int& sector, string& type) {
@@ -58,6 +58,7 @@ namespace magfieldparam {
     }
 
     inline double myExp(double x) { return std::exp(x); }
+    inline float myExp(float x) __attribute__((always_inline));
     inline float myExp(float x) { return unsafe_expf<3>(x); }
 
   }  // namespace bcylDetails
@@ -93,6 +94,14 @@ namespace magfieldparam {
       Bz += corBz;
     }
 
+    // batch version on SoA input: flatten inlines the whole body into the loop, which is then branch-free
+    // and can be vectorized (with -fno-math-errno and -fno-trapping-math, for std::sqrt and std::floor)
+    __attribute__((flatten)) void compute(
+        T const* __restrict__ r2, T const* __restrict__ z, T* __restrict__ Br, T* __restrict__ Bz, int n) const {
+      for (int i = 0; i < n; ++i)
+        compute(r2[i], z[i], Br[i], Bz[i]);
+    }
+
   private:
     BCylParam<T> pars;
   };
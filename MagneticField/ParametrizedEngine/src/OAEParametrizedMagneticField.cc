@@ -9,6 +9,8 @@
 
 #include "TkBfield.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace magfieldparam;
 
@@ -44,6 +46,34 @@ GlobalVector OAEParametrizedMagneticField::inTeslaUnchecked(const GlobalPoint& g
   return GlobalVector(B[0], B[1], B[2]);
 }
 
+void OAEParametrizedMagneticField::inTeslaBatch(const GlobalPoint* gp, GlobalVector* result, unsigned int n) const {
+  // Points are transposed to SoA in fixed-size chunks on the stack and evaluated with the SoA TkBfield
+  constexpr unsigned int chunk = 64;
+  alignas(64) float x[chunk], y[chunk], z[chunk], bx[chunk], by[chunk], bz[chunk];
+  bool defined[chunk];
+  for (unsigned int i0 = 0; i0 < n; i0 += chunk) {
+    unsigned int m = std::min(chunk, n - i0);
+    for (unsigned int i = 0; i < m; ++i) {
+      auto const& p = gp[i0 + i];
+      defined[i] = isDefined(p);
+      // undefined points are evaluated at the origin and zeroed afterwards
+      x[i] = defined[i] ? p.x() * ooh : 0.f;
+      y[i] = defined[i] ? p.y() * ooh : 0.f;
+      z[i] = defined[i] ? p.z() * ooh : 0.f;
+    }
+    theParam.getBxyz(x, y, z, bx, by, bz, m);
+    for (unsigned int i = 0; i < m; ++i) {
+      if (defined[i])
+        result[i0 + i] = GlobalVector(bx[i], by[i], bz[i]);
+      else {
+        edm::LogWarning("MagneticField") << " Point " << gp[i0 + i]
+                                         << " is outside the validity region of OAEParametrizedMagneticField";
+        result[i0 + i] = GlobalVector();
+      }
+    }
+  }
+}
+
 bool OAEParametrizedMagneticField::isDefined(const GlobalPoint& gp) const {
   return (gp.perp2() < (115.f * 115.f) && fabs(gp.z()) < 280.f);
 }
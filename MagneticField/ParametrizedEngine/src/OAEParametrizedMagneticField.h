@@ -40,6 +40,8 @@ public:
 
   GlobalVector inTeslaUnchecked(const GlobalPoint& gp) const override;
 
+  void inTeslaBatch(const GlobalPoint* gp, GlobalVector* result, unsigned int n) const override;
+
   bool isDefined(const GlobalPoint& gp) const override;
 
 private:
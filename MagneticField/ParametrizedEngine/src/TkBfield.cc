@@ -67,3 +67,21 @@ void TkBfield::getBxyz(float const* __restrict__ x, float* __restrict__ Bxyz) co
   Bxyz[1] = br * x[1];
   Bxyz[2] = bz;
 }
+
+void TkBfield::getBxyz(float const* __restrict__ x,
+                       float const* __restrict__ y,
+                       float const* __restrict__ z,
+                       float* __restrict__ Bx,
+                       float* __restrict__ By,
+                       float* __restrict__ Bz,
+                       int n) const {
+  // Bx is used as scratch for r2 and By for br, both overwritten below
+  for (int i = 0; i < n; ++i)
+    Bx[i] = x[i] * x[i] + y[i] * y[i];
+  bcyl.compute(Bx, z, By, Bz, n);
+  for (int i = 0; i < n; ++i) {
+    float br = By[i];
+    Bx[i] = br * x[i];
+    By[i] = br * y[i];
+  }
+}
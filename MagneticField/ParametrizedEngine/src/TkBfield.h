@@ -34,6 +34,15 @@ namespace magfieldparam {
     /// B out in cylindrical
     void getBrfz(float const* __restrict__ x, float* __restrict__ Brfz) const;
 
+    /// B out in cartesian for n points given as SoA (coordinates in m), in loops that can be vectorized
+    void getBxyz(float const* __restrict__ x,
+                 float const* __restrict__ y,
+                 float const* __restrict__ z,
+                 float* __restrict__ Bx,
+                 float* __restrict__ By,
+                 float* __restrict__ Bz,
+                 int n) const;
+
   private:
     BCycl<float> bcyl;
   };
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "MagneticField/ParametrizedEngine/src/OAEParametrizedMagneticField.h"
+#include "MagneticField/ParametrizedEngine/src/TkBfield.h"
+
+namespace {
+  // the scalar and the batch evaluations may differ in the contraction of the floating point operations
+  bool close(float a, float b) { return std::abs(a - b) <= 1.e-5f * std::max(1.f, std::abs(a)); }
+}  // namespace
+
+int main() {
+  // points in the validity region r < 1.15 m, |z| < 2.8 m; not a multiple of the chunks used by inTeslaBatch
+  constexpr int n = 1000;
+  std::vector<float> x(n), y(n), z(n);
+  for (int i = 0; i < n; ++i) {
+    float r = 1.14f * (i % 10) / 9.f;
+    float phi = 0.0628f * i;
+    x[i] = r * std::cos(phi);
+    y[i] = r * std::sin(phi);
+    z[i] = -2.79f + 5.58f * (i / 10) / 99.f;
+  }
+
+  // the SoA evaluation must give the same field as the scalar one
+  magfieldparam::TkBfield field(3.8f);
+  std::vector<float> bx(n), by(n), bz(n);
+  field.getBxyz(x.data(), y.data(), z.data(), bx.data(), by.data(), bz.data(), n);
+  for (int i = 0; i < n; ++i) {
+    float point[3] = {x[i], y[i], z[i]};
+    float b[3];
+    field.getBxyz(point, b);
+    if (not(close(b[0], bx[i]) and close(b[1], by[i]) and close(b[2], bz[i]))) {
+      std::cerr << "error: TkBfield at (" << x[i] << ", " << y[i] << ", " << z[i] << ") m: scalar (" << b[0] << ", "
+                << b[1] << ", " << b[2] << "), batch (" << bx[i] << ", " << by[i] << ", " << bz[i] << ")" << std::endl;
+      return 1;
+    }
+  }
+
+  // inTeslaBatch of the OAE parametrization, in cm, with some points outside the validity region
+  OAEParametrizedMagneticField oae(3.8f);
+  std::vector<GlobalPoint> points;
+  for (int i = 0; i < n; ++i)
+    points.emplace_back(100.f * x[i], 100.f * y[i], 100.f * z[i]);
+  points.emplace_back(0.f, 120.f, 0.f);
+  points.emplace_back(10.f, 10.f, -300.f);
+  std::vector<GlobalVector> batch(points.size());
+  oae.inTeslaBatch(points.data(), batch.data(), points.size());
+  for (unsigned int i = 0; i < points.size(); ++i) {
+    GlobalVector b = oae.inTesla(points[i]);
+    if (not(close(b.x(), batch[i].x()) and close(b.y(), batch[i].y()) and close(b.z(), batch[i].z()))) {
+      std::cerr << "error: OAEParametrizedMagneticField at " << points[i] << " cm: inTesla " << b << ", inTeslaBatch "
+                << batch[i] << std::endl;
+      return 1;
+    }
+  }
+  if (batch[n].mag2() != 0.f or batch[n + 1].mag2() != 0.f) {
+    std::cerr << "error: the field outside the validity region is not zero" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -12,6 +12,7 @@
 
 #include <vector>
 #include <atomic>
+#include <memory>
 
 class MagBLayer;
 class MagESector;
@@ -43,6 +44,9 @@ public:
   /// Return field vector at the specified global point
   GlobalVector fieldInTesla(const GlobalPoint& gp) const;
 
+  /// Return field vectors at n global points
+  void fieldInTesla(const GlobalPoint* gp, GlobalVector* result, unsigned int n) const;
+
   /// Find a volume
   MagVolume const* findVolume(const GlobalPoint& gp, double tolerance = 0.) const;
 
@@ -58,6 +62,9 @@ private:
 
   bool inBarrel(const GlobalPoint& gp) const;
 
+  // Index of the acceleration grid cell containing gp, -1 if outside the grid
+  int gridIndex(const GlobalPoint& gp) const;
+
   const int me_;  // Instance ID, to trigger cache invalidation at IOV boundaries
 
   std::vector<MagBLayer const*> theBLayers;
@@ -70,6 +77,10 @@ private:
   MagBinFinders::GeneralBinFinderInR<double> const* theBarrelBinFinder;
   PeriodicBinFinderInPhi<float> const* theEndcapBinFinder;
 
+  // Uniform 3D grid of volume hints, filled lazily with the last volume found in each cell.
+  // A hint is only used after checking that the point is inside it, so stale entries are harmless.
+  std::unique_ptr<std::atomic<MagVolume const*>[]> theVolumeGrid;
+
   bool cacheLastVolume;
   int geometryVersion;
 
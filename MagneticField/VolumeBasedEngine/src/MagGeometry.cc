@@ -27,6 +27,14 @@ namespace {
   std::atomic<int> instanceCounter(0);
   thread_local int localInstance = 0;
   thread_local MagVolume const* lastVolume = nullptr;
+
+  // Acceleration grid: cubic cells of 40 cm covering |x|,|y| < 10 m and |z| < 20 m (~2 MB of hints).
+  constexpr float gridHalfXY = 1000.f;
+  constexpr float gridHalfZ = 2000.f;
+  constexpr float gridInvCell = 1.f / 40.f;
+  constexpr int gridNXY = 50;
+  constexpr int gridNZ = 100;
+  constexpr int gridSize = gridNXY * gridNXY * gridNZ;
 }  // namespace
 
 MagGeometry::MagGeometry(int geomVersion,
@@ -50,6 +58,7 @@ MagGeometry::MagGeometry(int geomVersion,
       theESectors(tes),
       theBVolumes(tbv),
       theEVolumes(tev),
+      theVolumeGrid(std::make_unique<std::atomic<MagVolume const*>[]>(gridSize)),
       cacheLastVolume(true),
       geometryVersion(geomVersion) {
   vector<double> rBorders;
@@ -139,6 +148,11 @@ GlobalVector MagGeometry::fieldInTesla(const GlobalPoint& gp) const {
   return GlobalVector();
 }
 
+void MagGeometry::fieldInTesla(const GlobalPoint* gp, GlobalVector* result, unsigned int n) const {
+  for (unsigned int i = 0; i < n; ++i)
+    result[i] = fieldInTesla(gp[i]);
+}
+
 // Linear search implementation (just for testing)
 MagVolume const* MagGeometry::findVolume1(const GlobalPoint& gp, double tolerance) const {
   MagVolume6Faces const* found = nullptr;
@@ -194,6 +208,17 @@ MagVolume const* MagGeometry::findVolume(const GlobalPoint& gp, double tolerance
     return lastVolume;
   }
 
+  // Try the volume last found in the same grid cell before the hierarchical search
+  int cell = gridIndex(gp);
+  if (cell >= 0) {
+    MagVolume const* hint = theVolumeGrid[cell].load(std::memory_order_relaxed);
+    if (hint != nullptr && hint != lastVolume && hint->inside(gp)) {
+      if (cacheLastVolume)
+        lastVolume = hint;
+      return hint;
+    }
+  }
+
   MagVolume const* result = nullptr;
   if (inBarrel(gp)) {  // Barrel
     double aRsq = gp.perp2();
@@ -228,12 +253,25 @@ MagVolume const* MagGeometry::findVolume(const GlobalPoint& gp, double tolerance
     result = findVolume(gp, 0.03);
   }
 
+  if (cell >= 0 && result != nullptr)
+    theVolumeGrid[cell].store(result, std::memory_order_relaxed);
+
   if (cacheLastVolume)
     lastVolume = result;
 
   return result;
 }
 
+int MagGeometry::gridIndex(const GlobalPoint& gp) const {
+  float fx = (gp.x() + gridHalfXY) * gridInvCell;
+  float fy = (gp.y() + gridHalfXY) * gridInvCell;
+  float fz = (gp.z() + gridHalfZ) * gridInvCell;
+  // Written so that NaN coordinates fall outside the grid
+  if (!(fx >= 0.f && fx < gridNXY && fy >= 0.f && fy < gridNXY && fz >= 0.f && fz < gridNZ))
+    return -1;
+  return (int(fz) * gridNXY + int(fy)) * gridNXY + int(fx);
+}
+
 bool MagGeometry::inBarrel(const GlobalPoint& gp) const {
   double aZ = fabs(gp.z());
   double aRsq = gp.perp2();
@@ -59,6 +59,29 @@ GlobalVector VolumeBasedMagneticField::inTeslaUnchecked(const GlobalPoint& gp) c
   return field->fieldInTesla(gp);
 }
 
+void VolumeBasedMagneticField::inTeslaBatch(const GlobalPoint* gp, GlobalVector* result, unsigned int n) const {
+  // Consecutive points handled by the same engine are passed on as one batch
+  unsigned int i = 0;
+  while (i < n) {
+    unsigned int j = i;
+    if (paramField && paramField->isDefined(gp[i])) {
+      while (j < n && paramField->isDefined(gp[j]))
+        ++j;
+      paramField->inTeslaBatch(gp + i, result + i, j - i);
+    } else {
+      while (j < n && !(paramField && paramField->isDefined(gp[j])) && isDefined(gp[j]))
+        ++j;
+      if (j == i) {
+        // Outside magfield map: 0 field (not an error)
+        result[i] = GlobalVector();
+        ++j;
+      } else
+        field->fieldInTesla(gp + i, result + i, j - i);
+    }
+    i = j;
+  }
+}
+
 const MagVolume* VolumeBasedMagneticField::findVolume(const GlobalPoint& gp) const { return field->findVolume(gp); }
 
 bool VolumeBasedMagneticField::isDefined(const GlobalPoint& gp) const {
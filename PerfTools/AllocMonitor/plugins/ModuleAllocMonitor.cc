@@ -0,0 +1,464 @@
+// -*- C++ -*-
+//
+// Package:     PerfTools/AllocMonitor
+// Class  :     ModuleAllocMonitor
+//
+// Implementation:
+//     The allocations and deallocations are accumulated in counters private to each thread, and attributed
+//     to the module running on that thread; the per-module totals are updated only at the end of each module
+//     transition. A module that runs inside another one on the same thread suspends the counters of the outer
+//     one, which are resumed when the inner module finishes.
+//     Optionally, the call stack is recorded each time a thread has allocated a given number of bytes,
+//     so the stacks are sampled proportionally to the memory they allocate.
+//
+//     The bytes still allocated when a module finishes processing an event are those held by its data
+//     products (and by any cache the module keeps). A product that is consumed only by modules on Paths
+//     can be deleted once they have run, instead of at the end of the event, using
+//     process.options.canDeleteEarly; such products are flagged in the report.
+//
+
+// system include files
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+
+// user include files
+#include "PerfTools/AllocMonitor/interface/AllocMonitorBase.h"
+#include "PerfTools/AllocMonitor/interface/AllocMonitorRegistry.h"
+#include "DataFormats/Provenance/interface/BranchDescription.h"
+#include "DataFormats/Provenance/interface/ModuleDescription.h"
+#include "FWCore/Framework/interface/ConstProductRegistry.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ParameterSet/interface/ConfigurationDescriptions.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
+#include "FWCore/ServiceRegistry/interface/ActivityRegistry.h"
+#include "FWCore/ServiceRegistry/interface/ModuleCallingContext.h"
+#include "FWCore/ServiceRegistry/interface/PathsAndConsumesOfModulesBase.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/ServiceRegistry/interface/ServiceMaker.h"
+#include "FWCore/ServiceRegistry/interface/ServiceRegistry.h"
+
+namespace {
+  constexpr int kNoModule = -1;
+
+  // the call stack of an allocation, prefixed by the id of the module that was running
+  using Stack = std::vector<void*>;
+
+  struct StackHash {
+    std::size_t operator()(Stack const& stack) const {
+      std::size_t hash = stack.size();
+      for (void* frame : stack)
+        hash ^= std::hash<void*>()(frame) + 0x9e3779b97f4a7c15ul + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  // counters for a single transition of a module on a thread
+  struct ModuleCounters {
+    int module = kNoModule;
+    int64_t live = 0;  // bytes allocated minus bytes deallocated since the module started
+    int64_t peak = 0;  // maximum of live since the module started
+    size_t allocated = 0;
+    size_t deallocated = 0;
+    size_t nAllocations = 0;
+    size_t nDeallocations = 0;
+
+    void reset(int iModule) { *this = ModuleCounters{iModule}; }
+  };
+
+  // counters private to a thread
+  struct ThreadCounters {
+    // the module currently running on the thread
+    ModuleCounters current;
+    // the modules suspended while another module runs inside them on the same thread (e.g. an unscheduled producer)
+    std::vector<ModuleCounters> outer;
+    int64_t untilSample = 0;                              // bytes left to allocate before the next stack sample
+    std::unordered_map<Stack, size_t, StackHash> stacks;  // sampled bytes per call stack
+  };
+
+  template <typename T>
+  void updateMax(std::atomic<T>& iMax, T iValue) {
+    auto max = iMax.load(std::memory_order_relaxed);
+    while (iValue > max) {
+      if (iMax.compare_exchange_strong(max, iValue, std::memory_order_acq_rel)) {
+        break;
+      }
+    }
+  }
+
+  // totals for each module, updated at the end of each module transition
+  struct ModuleTotals {
+    std::atomic<size_t> calls = 0;  // number of events processed; acquire and produce of ExternalWork count once
+    std::atomic<size_t> allocated = 0;
+    std::atomic<size_t> deallocated = 0;
+    std::atomic<size_t> nAllocations = 0;
+    std::atomic<size_t> nDeallocations = 0;
+    std::atomic<int64_t> maxPeak = 0;      // peak of the live bytes during a single call
+    std::atomic<int64_t> retained = 0;     // sum over the calls of the bytes still allocated at the end of the call
+    std::atomic<int64_t> maxRetained = 0;  // maximum over the calls of the bytes still allocated at the end of the call
+  };
+
+  // the counters of each thread are owned by the MonitorAdaptor, which is destroyed at the end of the job:
+  // the thread-local pointer is valid only for the instance that set it, so that a later job in the same
+  // process does not use the counters of a previous one
+  std::atomic<unsigned int> instanceCounter = 0;
+  thread_local unsigned int tl_instance = 0;
+  thread_local ThreadCounters* tl_counters = nullptr;
+
+  std::string symbolName(void* iAddress) {
+    Dl_info info;
+    // the return address points to the instruction after the call
+    void* call = static_cast<char*>(iAddress) - 1;
+    if (dladdr(call, &info) == 0 or info.dli_fname == nullptr)
+      return "[unknown]";
+    if (info.dli_sname == nullptr) {
+      std::string library = info.dli_fname;
+      library = library.substr(library.rfind('/') + 1);
+      char offset[32];
+      snprintf(offset, sizeof(offset), "+0x%lx", static_cast<char*>(call) - static_cast<char*>(info.dli_fbase));
+      return library + offset;
+    }
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled(
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+    std::string name = (status == 0 and demangled) ? demangled.get() : info.dli_sname;
+    std::replace(name.begin(), name.end(), ';', ':');
+    return name;
+  }
+
+  class MonitorAdaptor : public cms::perftools::AllocMonitorBase {
+  public:
+    MonitorAdaptor(size_t iSamplingBytes, unsigned int iStackDepth)
+        : instance_(++instanceCounter), samplingBytes_(iSamplingBytes), stackDepth_(iStackDepth) {}
+
+    // not thread safe, called before the monitoring starts
+    void setNumberOfModules(unsigned int iSize) { modules_ = std::vector<ModuleTotals>(iSize); }
+    void start() { started_.store(true, std::memory_order_release); }
+    void stop() { started_.store(false, std::memory_order_release); }
+
+    void moduleStarted(int iModule) {
+      auto& counters = threadCounters();
+      if (counters.current.module != kNoModule) {
+        // a module running inside another one on the same thread: suspend the counters of the outer one,
+        // so that its live and peak memory are resumed when the inner module finishes
+        counters.outer.push_back(counters.current);
+      }
+      counters.current.reset(iModule);
+    }
+
+    // iFinal: the end of the event transition, as opposed to the end of the acquire of an ExternalWork module
+    void moduleFinished(int iPrevious, bool iFinal) {
+      auto& counters = threadCounters();
+      if (counters.current.module != kNoModule) {
+        flush(counters.current, iFinal);
+      }
+      if (not counters.outer.empty() and counters.outer.back().module == iPrevious) {
+        counters.current = counters.outer.back();
+        counters.outer.pop_back();
+      } else {
+        counters.current.reset(iPrevious);
+      }
+    }
+
+    std::vector<ModuleTotals> const& modules() const { return modules_; }
+
+    // not thread safe, called after the monitoring has stopped
+    std::unordered_map<Stack, size_t, StackHash> stacks() {
+      std::unordered_map<Stack, size_t, StackHash> stacks;
+      std::lock_guard<std::mutex> guard(mutex_);
+      for (auto& counters : threads_) {
+        for (auto const& [stack, bytes] : counters->stacks)
+          stacks[stack] += bytes;
+      }
+      return stacks;
+    }
+
+  private:
+    void allocCalled(size_t iRequested, size_t iActual) final {
+      if (not started_.load(std::memory_order_acquire)) {
+        return;
+      }
+      auto& counters = threadCounters();
+      auto& current = counters.current;
+      current.live += iActual;
+      current.peak = std::max(current.peak, current.live);
+      current.allocated += iActual;
+      ++current.nAllocations;
+      if (samplingBytes_ > 0) {
+        counters.untilSample -= iActual;
+        if (counters.untilSample <= 0) {
+          sampleStack(counters);
+        }
+      }
+    }
+
+    void deallocCalled(size_t iActual) final {
+      if (not started_.load(std::memory_order_acquire)) {
+        return;
+      }
+      auto& current = threadCounters().current;
+      current.live -= iActual;
+      current.deallocated += iActual;
+      ++current.nDeallocations;
+    }
+
+    ThreadCounters& threadCounters() {
+      if (tl_instance != instance_) {
+        // when called from a module transition the allocations made here are monitored,
+        // and accounted to a scratch object until the counters of the thread are ready
+        thread_local ThreadCounters scratch;
+        tl_instance = instance_;
+        tl_counters = &scratch;
+        auto counters = std::make_unique<ThreadCounters>();
+        counters->untilSample = samplingBytes_;
+        counters->outer.reserve(16);
+        auto pointer = counters.get();
+        {
+          std::lock_guard<std::mutex> guard(mutex_);
+          threads_.push_back(std::move(counters));
+        }
+        tl_counters = pointer;
+      }
+      return *tl_counters;
+    }
+
+    void flush(ModuleCounters const& iCounters, bool iFinal) {
+      if (iCounters.module < 0 or static_cast<unsigned int>(iCounters.module) >= modules_.size())
+        return;
+      auto& totals = modules_[iCounters.module];
+      totals.allocated.fetch_add(iCounters.allocated, std::memory_order_relaxed);
+      totals.deallocated.fetch_add(iCounters.deallocated, std::memory_order_relaxed);
+      totals.nAllocations.fetch_add(iCounters.nAllocations, std::memory_order_relaxed);
+      totals.nDeallocations.fetch_add(iCounters.nDeallocations, std::memory_order_relaxed);
+      updateMax(totals.maxPeak, iCounters.peak);
+      if (iFinal) {
+        // the products are put into the event by the end of the event transition
+        totals.calls.fetch_add(1, std::memory_order_relaxed);
+        totals.retained.fetch_add(iCounters.live, std::memory_order_relaxed);
+        updateMax(totals.maxRetained, iCounters.live);
+      }
+    }
+
+    void sampleStack(ThreadCounters& iCounters) {
+      // attribute the sampling interval to the stack once for each time it has been crossed
+      size_t bytes = 0;
+      while (iCounters.untilSample <= 0) {
+        iCounters.untilSample += samplingBytes_;
+        bytes += samplingBytes_;
+      }
+      std::vector<void*> frames(stackDepth_);
+      int depth = backtrace(frames.data(), stackDepth_);
+      Stack stack;
+      stack.reserve(depth + 1);
+      stack.push_back(reinterpret_cast<void*>(static_cast<intptr_t>(iCounters.current.module)));
+      // skip this function, allocCalled and the registry; store the frames from the outermost to the innermost
+      for (int i = depth - 1; i >= kSkipFrames; --i)
+        stack.push_back(frames[i]);
+      iCounters.stacks[stack] += bytes;
+    }
+
+    static constexpr int kSkipFrames = 3;
+
+    const unsigned int instance_;
+    const int64_t samplingBytes_;
+    const unsigned int stackDepth_;
+    std::vector<ModuleTotals> modules_;
+    std::atomic<bool> started_ = false;
+
+    // the counters of all threads, owned here so they can be merged at the end of the job
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadCounters>> threads_;
+  };
+
+  struct ModuleInfo {
+    std::string label;
+    std::vector<std::string> products;
+    std::vector<unsigned int> consumers;
+    bool consumedOnEndPath = false;
+  };
+
+}  // namespace
+
+class ModuleAllocMonitor {
+public:
+  ModuleAllocMonitor(edm::ParameterSet const& iPS, edm::ActivityRegistry& iAR)
+      : stackFileName_(iPS.getUntrackedParameter<std::string>("stackFileName")),
+        nModulesToReport_(iPS.getUntrackedParameter<unsigned int>("nModulesToReport")),
+        adaptor_(cms::perftools::AllocMonitorRegistry::instance().createAndRegisterMonitor<MonitorAdaptor>(
+            iPS.getUntrackedParameter<unsigned long long>("stackSamplingBytes"),
+            iPS.getUntrackedParameter<unsigned int>("maxStackDepth"))) {
+    iAR.watchPreBeginJob([this](edm::PathsAndConsumesOfModulesBase const& iPnC, edm::ProcessContext const&) {
+      preBeginJob(iPnC);
+    });
+    iAR.watchPostBeginJob([this]() {
+      collectProducts();
+      adaptor_->start();
+    });
+
+    iAR.watchPreModuleEventAcquire([this](edm::StreamContext const&, edm::ModuleCallingContext const& iMCC) {
+      adaptor_->moduleStarted(iMCC.moduleDescription()->id());
+    });
+    iAR.watchPostModuleEventAcquire([this](edm::StreamContext const&, edm::ModuleCallingContext const& iMCC) {
+      adaptor_->moduleFinished(previousModule(iMCC), false);
+    });
+    iAR.watchPreModuleEvent([this](edm::StreamContext const&, edm::ModuleCallingContext const& iMCC) {
+      adaptor_->moduleStarted(iMCC.moduleDescription()->id());
+    });
+    iAR.watchPostModuleEvent([this](edm::StreamContext const&, edm::ModuleCallingContext const& iMCC) {
+      adaptor_->moduleFinished(previousModule(iMCC), true);
+    });
+
+    iAR.watchPreEndJob([this]() {
+      adaptor_->stop();
+      performanceReport();
+      cms::perftools::AllocMonitorRegistry::instance().deregisterMonitor(adaptor_);
+    });
+  }
+
+  static void fillDescriptions(edm::ConfigurationDescriptions& iDesc) {
+    edm::ParameterSetDescription ps;
+    ps.addUntracked<unsigned long long>("stackSamplingBytes", 0)
+        ->setComment(
+            "Record the call stack each time a thread has allocated this number of bytes. 0 disables the sampling.");
+    ps.addUntracked<unsigned int>("maxStackDepth", 32)->setComment("Maximum number of frames of each sampled stack.");
+    ps.addUntracked<std::string>("stackFileName", "moduleAllocStacks.folded")
+        ->setComment(
+            "File where the sampled stacks are written, in the folded format used by flamegraph.pl,\n"
+            "with the module label as the outermost frame and the sampled bytes as the count.");
+    ps.addUntracked<unsigned int>("nModulesToReport", 20)
+        ->setComment("Number of modules with the largest memory peaks, and of products, listed in the report.");
+    iDesc.addDefault(ps);
+  }
+
+private:
+  static int previousModule(edm::ModuleCallingContext const& iMCC) {
+    auto const* previous = iMCC.previousModuleOnThread();
+    return previous ? static_cast<int>(previous->moduleDescription()->id()) : kNoModule;
+  }
+
+  void preBeginJob(edm::PathsAndConsumesOfModulesBase const& iPnC) {
+    modules_.resize(iPnC.largestModuleID() + 1);
+    adaptor_->setNumberOfModules(modules_.size());
+
+    std::vector<bool> onEndPath(modules_.size(), false);
+    for (unsigned int i = 0; i < iPnC.endPaths().size(); ++i) {
+      for (auto const* module : iPnC.modulesOnEndPath(i))
+        onEndPath[module->id()] = true;
+    }
+
+    for (auto const* module : iPnC.allModules()) {
+      modules_[module->id()].label = module->moduleLabel();
+      for (auto const* producer : iPnC.modulesWhoseProductsAreConsumedBy(module->id())) {
+        auto& info = modules_[producer->id()];
+        info.consumers.push_back(module->id());
+        info.consumedOnEndPath = info.consumedOnEndPath or onEndPath[module->id()];
+      }
+    }
+  }
+
+  void collectProducts() {
+    edm::Service<edm::ConstProductRegistry> registry;
+    std::unordered_map<std::string, unsigned int> ids;
+    for (unsigned int i = 0; i < modules_.size(); ++i) {
+      if (not modules_[i].label.empty())
+        ids.emplace(modules_[i].label, i);
+    }
+    for (auto const* branch : registry->allBranchDescriptions()) {
+      if (branch == nullptr or not branch->produced() or branch->isAlias() or branch->branchType() != edm::InEvent)
+        continue;
+      auto id = ids.find(branch->moduleLabel());
+      if (id != ids.end())
+        modules_[id->second].products.push_back(branch->branchName());
+    }
+  }
+
+  void performanceReport() {
+    auto const& totals = adaptor_->modules();
+
+    std::vector<unsigned int> order;
+    for (unsigned int i = 0; i < totals.size(); ++i) {
+      if (totals[i].calls.load() > 0)
+        order.push_back(i);
+    }
+    unsigned int size = std::min<unsigned int>(nModulesToReport_, order.size());
+
+    {
+      std::sort(order.begin(), order.end(), [&totals](unsigned int a, unsigned int b) {
+        return totals[a].maxPeak.load() > totals[b].maxPeak.load();
+      });
+      edm::LogSystem out("ModuleAllocMonitor");
+      out << "Module Memory Report: modules with the largest peak of live memory in a single call"
+          << "\n  peak [kB]  average added [kB]  average retained [kB]  max retained [kB]  # allocations  label";
+      for (unsigned int i = 0; i < size; ++i) {
+        auto const& module = totals[order[i]];
+        auto calls = module.calls.load();
+        out << "\n  " << module.maxPeak.load() / 1024 << "  " << module.allocated.load() / calls / 1024 << "  "
+            << module.retained.load() / static_cast<int64_t>(calls) / 1024 << "  " << module.maxRetained.load() / 1024
+            << "  " << module.nAllocations.load() / calls << "  " << modules_[order[i]].label;
+      }
+    }
+
+    {
+      std::sort(order.begin(), order.end(), [&totals](unsigned int a, unsigned int b) {
+        return totals[a].maxRetained.load() > totals[b].maxRetained.load();
+      });
+      edm::LogSystem out("ModuleAllocMonitor");
+      out << "Product Memory Report: memory still allocated when the producer finishes, attributed to its products"
+          << "\n  max retained [kB]  average retained [kB]  # consumers  products";
+      for (unsigned int i = 0; i < size; ++i) {
+        auto const& module = totals[order[i]];
+        auto const& info = modules_[order[i]];
+        if (info.products.empty() or module.maxRetained.load() <= 0)
+          continue;
+        out << "\n  " << module.maxRetained.load() / 1024 << "  "
+            << module.retained.load() / static_cast<int64_t>(module.calls.load()) / 1024 << "  "
+            << info.consumers.size() << "  ";
+        for (auto const& product : info.products)
+          out << product << " ";
+        if (not info.consumedOnEndPath)
+          out << (info.consumers.empty() ? "[not consumed]" : "[consumed only on Paths: can be deleted early]");
+      }
+    }
+
+    if (not stackFileName_.empty()) {
+      auto stacks = adaptor_->stacks();
+      if (stacks.empty())
+        return;
+      std::unordered_map<void*, std::string> symbols;
+      std::ofstream file(stackFileName_);
+      for (auto const& [stack, bytes] : stacks) {
+        int module = static_cast<int>(reinterpret_cast<intptr_t>(stack.front()));
+        file << ((module >= 0 and static_cast<unsigned int>(module) < modules_.size()) ? modules_[module].label
+                                                                                        : "[framework]");
+        for (auto it = stack.begin() + 1; it != stack.end(); ++it) {
+          auto symbol = symbols.find(*it);
+          if (symbol == symbols.end())
+            symbol = symbols.emplace(*it, symbolName(*it)).first;
+          file << ';' << symbol->second;
+        }
+        file << ' ' << bytes << '\n';
+      }
+    }
+  }
+
+  std::string const stackFileName_;
+  unsigned int const nModulesToReport_;
+  MonitorAdaptor* adaptor_;
+  std::vector<ModuleInfo> modules_;
+};
+
+DEFINE_FWK_SERVICE(ModuleAllocMonitor);
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+function die { echo Failure $1: status $2 ; exit $2 ; }
+
+# the allocations are seen by the monitors only when the preload library replaces malloc and free
+export LD_PRELOAD=libPerfToolsAllocMonitorPreload.so
+
+rm -f test_ModuleAllocMonitor.folded
+cmsRun ${SCRAM_TEST_PATH}/test_ModuleAllocMonitor_cfg.py &> test_ModuleAllocMonitor.log || die "cmsRun test_ModuleAllocMonitor_cfg.py" $?
+
+grep "Module Memory Report" test_ModuleAllocMonitor.log > /dev/null || die "Check for the Module Memory Report" $?
+for LABEL in small large; do
+  grep -E "^  [0-9]+ .* ${LABEL}$" test_ModuleAllocMonitor.log > /dev/null || die "Check for ${LABEL} in the report" $?
+done
+# no stacks are sampled by default
+[ ! -e test_ModuleAllocMonitor.folded ] || die "Check that no stacks file is written without sampling" 1
+
+cmsRun ${SCRAM_TEST_PATH}/test_ModuleAllocMonitor_cfg.py --stackSamplingBytes 65536 &> test_ModuleAllocMonitor_stacks.log || die "cmsRun test_ModuleAllocMonitor_cfg.py --stackSamplingBytes 65536" $?
+
+grep "Module Memory Report" test_ModuleAllocMonitor_stacks.log > /dev/null || die "Check for the Module Memory Report with sampling" $?
+# the stacks are written as "label;frame;...;frame bytes"
+[ -s test_ModuleAllocMonitor.folded ] || die "Check that the stacks file is written" 1
+grep -v -E "^[^;]+(;[^;]+)* [0-9]+$" test_ModuleAllocMonitor.folded && die "Check that all the stacks are well formed" 1
+grep -E "^large;.* [0-9]+$" test_ModuleAllocMonitor.folded > /dev/null || die "Check for stacks of large" $?
+exit 0
@@ -0,0 +1,29 @@
+import FWCore.ParameterSet.Config as cms
+
+import argparse
+import sys
+
+parser = argparse.ArgumentParser(prog=sys.argv[0], description='Test the ModuleAllocMonitor service.')
+
+parser.add_argument("--stackSamplingBytes", help="Sample the allocation stacks every this number of bytes", type=int, default=0)
+
+args = parser.parse_args()
+
+process = cms.Process("Test")
+
+process.source = cms.Source("EmptySource")
+
+process.maxEvents.input = 10
+
+process.options.numberOfThreads = 2
+process.options.numberOfStreams = 2
+
+process.small = cms.EDProducer("IntVectorProducer", ivalue = cms.int32(1), count = cms.int32(1000), delta = cms.int32(0))
+process.large = cms.EDProducer("IntVectorProducer", ivalue = cms.int32(2), count = cms.int32(1000*1000), delta = cms.int32(1))
+
+process.p = cms.Path(process.small + process.large)
+
+process.add_(cms.Service("ModuleAllocMonitor",
+    stackSamplingBytes = cms.untracked.uint64(args.stackSamplingBytes),
+    stackFileName = cms.untracked.string("test_ModuleAllocMonitor.folded")
+))
@@ -53,19 +53,23 @@ public:
   ~FuncVariable() override {}
 
   void fill(std::vector<const ObjType *> &selobjs, nanoaod::FlatTable &out) const override {
-    std::vector<ValType> vals(selobjs.size());
-    for (unsigned int i = 0, n = vals.size(); i < n; ++i) {
-      vals[i] = func_(*selobjs[i]);
+    // evaluate the expression directly into the column, then round the whole column at once
+    auto fillValues = [&](auto const &data) {
+      auto vals = data.begin();
+      for (unsigned int i = 0, n = selobjs.size(); i < n; ++i)
+        vals[i] = ValType(func_(*selobjs[i]));
       if constexpr (std::is_same<ValType, float>()) {
-        if (this->precision_ == -2) {
-          auto prec = precisionFunc_(*selobjs[i]);
-          if (prec > 0) {
-            vals[i] = MiniFloatConverter::reduceMantissaToNbitsRounding(vals[i], prec);
+        if (this->precision_ == -2 && !selobjs.empty()) {
+          std::vector<int> bits(selobjs.size());
+          for (unsigned int i = 0, n = selobjs.size(); i < n; ++i) {
+            auto prec = precisionFunc_(*selobjs[i]);
+            bits[i] = prec > 0 ? int(prec) : 0;
           }
+          MiniFloatConverter::reduceMantissaToNbitsRounding(bits.data(), &*vals, bits.size());
         }
       }
-    }
-    out.template addColumn<ValType>(this->name_, vals, this->doc_, this->precision_);
+    };
+    out.template fillColumn<ValType>(this->name_, selobjs.size(), fillValues, this->doc_, this->precision_);
   }
 
 protected:
@@ -15,14 +15,19 @@
 
 #include <ROOT/RNTuple.hxx>
 #include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RPageSinkBuf.hxx>
 #include <ROOT/RPageStorageFile.hxx>
 using ROOT::Experimental::RNTupleModel;
 #if ROOT_VERSION_CODE < ROOT_VERSION(6, 31, 0)
 using ROOT::Experimental::RNTupleWriter;
+using ROOT::Experimental::Detail::RPageSink;
+using ROOT::Experimental::Detail::RPageSinkBuf;
 using ROOT::Experimental::Detail::RPageSinkFile;
 #define MakeRNTupleWriter std::make_unique<RNTupleWriter>
 #include <ROOT/RNTupleOptions.hxx>
 #else
+using ROOT::Experimental::Internal::RPageSink;
+using ROOT::Experimental::Internal::RPageSinkBuf;
 using ROOT::Experimental::Internal::RPageSinkFile;
 #define MakeRNTupleWriter ROOT::Experimental::Internal::CreateRNTupleWriter
 #include <ROOT/RNTupleWriteOptions.hxx>
@@ -69,6 +74,9 @@ private:
   std::string m_compressionAlgorithm;
   int m_compressionLevel;
   bool m_writeProvenance;
+  bool m_useBufferedWrite;
+  unsigned long long m_approxZippedClusterSize;
+  unsigned long long m_maxUnzippedClusterSize;
   edm::ProcessHistoryRegistry m_processHistoryRegistry;
   edm::JobReport::Token m_jrToken;
 
@@ -111,6 +119,9 @@ NanoAODRNTupleOutputModule::NanoAODRNTupleOutputModule(edm::ParameterSet const&
       m_compressionAlgorithm(pset.getUntrackedParameter<std::string>("compressionAlgorithm")),
       m_compressionLevel(pset.getUntrackedParameter<int>("compressionLevel")),
       m_writeProvenance(pset.getUntrackedParameter<bool>("saveProvenance", true)),
+      m_useBufferedWrite(pset.getUntrackedParameter<bool>("useBufferedWrite")),
+      m_approxZippedClusterSize(pset.getUntrackedParameter<unsigned long long>("approxZippedClusterSize")),
+      m_maxUnzippedClusterSize(pset.getUntrackedParameter<unsigned long long>("maxUnzippedClusterSize")),
       m_processHistoryRegistry() {}
 
 NanoAODRNTupleOutputModule::~NanoAODRNTupleOutputModule() {}
@@ -213,7 +224,22 @@ void NanoAODRNTupleOutputModule::initializeNTuple(edm::EventForOutput const& iEv
   // TODO use Append
   RNTupleWriteOptions options;
   options.SetCompression(m_file->GetCompressionSettings());
-  m_ntuple = MakeRNTupleWriter(std::move(model), std::make_unique<RPageSinkFile>("Events", *m_file, options));
+  options.SetUseBufferedWrite(m_useBufferedWrite);
+  if (m_approxZippedClusterSize > 0) {
+    options.SetApproxZippedClusterSize(m_approxZippedClusterSize);
+  }
+  if (m_maxUnzippedClusterSize > 0) {
+    options.SetMaxUnzippedClusterSize(m_maxUnzippedClusterSize);
+  }
+  std::unique_ptr<RPageSink> sink = std::make_unique<RPageSinkFile>("Events", *m_file, options);
+  // The buffered sink keeps the pages of the current cluster in memory and compresses them in
+  // parallel, on the ROOT implicit MT task scheduler that the writer sets when IMT is enabled,
+  // instead of compressing every page serially in the thread calling Fill(). Creating the writer
+  // from a sink skips the wrapping that RNTupleWriter::Append would do, so do it here.
+  if (m_useBufferedWrite) {
+    sink = std::make_unique<RPageSinkBuf>(std::move(sink));
+  }
+  m_ntuple = MakeRNTupleWriter(std::move(model), std::move(sink));
 }
 
 void NanoAODRNTupleOutputModule::write(edm::EventForOutput const& iEvent) {
@@ -271,6 +297,16 @@ void NanoAODRNTupleOutputModule::fillDescriptions(edm::ConfigurationDescriptions
           "compress data in the ROOT output file, allowed values are ZLIB and LZMA");
   desc.addUntracked<bool>("saveProvenance", true)
       ->setComment("Save process provenance information, e.g. for edmProvDump");
+  desc.addUntracked<bool>("useBufferedWrite", true)
+      ->setComment(
+          "Buffer the pages of each cluster and compress them in parallel (requires ROOT implicit MT) instead of "
+          "compressing them one by one when each event is filled");
+  desc.addUntracked<unsigned long long>("approxZippedClusterSize", 0)
+      ->setComment("Target compressed size of the Events clusters, in bytes (0 = ROOT default)");
+  desc.addUntracked<unsigned long long>("maxUnzippedClusterSize", 0)
+      ->setComment(
+          "Maximum uncompressed size of the Events clusters, in bytes, i.e. the memory used to buffer them "
+          "(0 = ROOT default)");
   const std::vector<std::string> keep = {"drop *",
                                          "keep nanoaodFlatTable_*Table_*_*",
                                          "keep edmTriggerResults_*_*_*",
@@ -0,0 +1,94 @@
+# Compare the throughput of the TTree (NanoAODOutputModule) and RNTuple (NanoAODRNTupleOutputModule)
+# NanoAOD output modules, writing the same tables produced from MiniAOD in the same job:
+#
+#   cmsRun testNanoAODOutputThroughput_cfg.py inputFiles=file:miniaod.root threads=8
+#
+# The time spent in each output module is reported by the FastTimerService at the end of the job,
+# the file sizes can be compared with ls or compare_sizes_json.py.
+import FWCore.ParameterSet.Config as cms
+from Configuration.Eras.Era_Run3_cff import Run3
+
+from FWCore.ParameterSet.VarParsing import VarParsing
+options = VarParsing('analysis')
+options.register('threads',
+                 1,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.int,
+                 "Number of threads (and streams)")
+options.register('globalTag',
+                 'auto:phase1_2022_realistic',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "Global tag")
+options.register('formats',
+                 'TTree,RNTuple',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "Comma separated list of the output formats to write (TTree, RNTuple)")
+options.register('bufferedWrite',
+                 True,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.bool,
+                 "Compress the RNTuple pages in parallel")
+options.parseArguments()
+
+process = cms.Process('NANO', Run3)
+
+process.load('Configuration.StandardSequences.Services_cff')
+process.load('FWCore.MessageService.MessageLogger_cfi')
+process.load('Configuration.EventContent.EventContent_cff')
+process.load('Configuration.StandardSequences.GeometryRecoDB_cff')
+process.load('Configuration.StandardSequences.MagneticField_cff')
+process.load('PhysicsTools.NanoAOD.nano_cff')
+process.load('Configuration.StandardSequences.FrontierConditions_GlobalTag_cff')
+
+from Configuration.AlCa.GlobalTag import GlobalTag
+process.GlobalTag = GlobalTag(process.GlobalTag, options.globalTag, '')
+
+process.source = cms.Source("PoolSource",
+    fileNames = cms.untracked.vstring(options.inputFiles)
+)
+
+process.maxEvents = cms.untracked.PSet(
+    input = cms.untracked.int32(options.maxEvents)
+)
+
+process.options = cms.untracked.PSet(
+    numberOfThreads = cms.untracked.uint32(options.threads),
+    numberOfStreams = cms.untracked.uint32(0),
+    wantSummary = cms.untracked.bool(False)
+)
+
+process.load('HLTrigger.Timer.FastTimerService_cfi')
+process.FastTimerService.enableDQM = False
+process.FastTimerService.printRunSummary = False
+process.FastTimerService.printJobSummary = True
+process.FastTimerService.writeJSONSummary = True
+process.FastTimerService.jsonFileName = 'resources.json'
+process.MessageLogger.FastReport = cms.untracked.PSet()
+
+process.nanoAOD_step = cms.Path(process.nanoSequenceMC)
+
+# the same event content, compression and selection for both formats
+formats = options.formats.split(',')
+process.output_step = cms.EndPath()
+if 'TTree' in formats:
+    process.NANOAODSIMoutput = cms.OutputModule("NanoAODOutputModule",
+        compressionAlgorithm = cms.untracked.string('LZMA'),
+        compressionLevel = cms.untracked.int32(9),
+        fileName = cms.untracked.string('nano_ttree.root'),
+        outputCommands = process.NANOAODSIMEventContent.outputCommands
+    )
+    process.output_step += process.NANOAODSIMoutput
+if 'RNTuple' in formats:
+    process.NANOAODSIMRNTupleoutput = cms.OutputModule("NanoAODRNTupleOutputModule",
+        compressionAlgorithm = cms.untracked.string('LZMA'),
+        compressionLevel = cms.untracked.int32(9),
+        fileName = cms.untracked.string('nano_rntuple.root'),
+        useBufferedWrite = cms.untracked.bool(options.bufferedWrite),
+        outputCommands = process.NANOAODSIMEventContent.outputCommands
+    )
+    process.output_step += process.NANOAODSIMRNTupleoutput
+
+from PhysicsTools.NanoAOD.nano_cff import nanoAOD_customizeCommon
+process = nanoAOD_customizeCommon(process)
@@ -0,0 +1,61 @@
+#include "catch.hpp"
+#include "DataFormats/NanoAOD/interface/FlatTable.h"
+#include "DataFormats/Math/interface/libminifloat.h"
+
+#include <algorithm>
+#include <vector>
+
+static constexpr auto s_tag = "[FlatTable]";
+
+TEST_CASE("FlatTable::fillColumn", s_tag) {
+  nanoaod::FlatTable table(4, "Test", false);
+
+  SECTION("values are written in place") {
+    table.fillColumn<int>(
+        "idx",
+        4,
+        [](auto const& data) {
+          int i = 0;
+          for (auto& value : data)
+            value = 10 * i++;
+        },
+        "index");
+    REQUIRE(table.nColumns() == 1);
+    REQUIRE(table.columnIndex("idx") == 0);
+    REQUIRE(table.columnType(0) == nanoaod::FlatTable::ColumnType::Int32);
+    REQUIRE(table.columnDoc(0) == "index");
+    auto data = table.columnData<int>(0);
+    REQUIRE(std::vector<int>(data.begin(), data.end()) == std::vector<int>{0, 10, 20, 30});
+  }
+
+  SECTION("same result as addColumn, including the mantissa reduction") {
+    const std::vector<float> values{1.2345678f, -2.3456789f, 345.67891f, 0.f};
+    table.addColumn<float>("added", values, "", 10);
+    auto copy = [&](auto const& data) { std::copy(values.begin(), values.end(), data.begin()); };
+    table.fillColumn<float>("filled", values.size(), copy, "", 10);
+    auto added = table.columnData<float>(0);
+    auto filled = table.columnData<float>(1);
+    REQUIRE(std::vector<float>(added.begin(), added.end()) == std::vector<float>(filled.begin(), filled.end()));
+    REQUIRE(filled.begin()[0] == MiniFloatConverter::reduceMantissaToNbitsRounding(values[0], 10));
+    REQUIRE(filled.begin()[0] != values[0]);
+  }
+
+  SECTION("a number of values different from the size of the table is rejected") {
+    bool called = false;
+    auto fill = [&](auto const&) { called = true; };
+    REQUIRE_THROWS_AS(table.fillColumn<float>("short", 3, fill, ""), cms::Exception);
+    REQUIRE_THROWS_AS(table.fillColumn<float>("long", 5, fill, ""), cms::Exception);
+    REQUIRE(not called);
+    REQUIRE(table.nColumns() == 0);
+  }
+
+  SECTION("duplicated columns are rejected") {
+    auto fill = [](auto const& data) {
+      for (auto& value : data)
+        value = 1;
+    };
+    table.fillColumn<uint8_t>("flag", 4, fill, "");
+    REQUIRE_THROWS_AS(table.fillColumn<uint8_t>("flag", 4, fill, ""), cms::Exception);
+    REQUIRE(table.nColumns() == 1);
+  }
+}
@@ -0,0 +1,78 @@
+/*
+ * ONNXRuntimeBatcher.h
+ *
+ * Gathers inference requests submitted concurrently (e.g. from the acquire() of an
+ * ExternalWork module in several streams) and runs them as a single batched call
+ * of a shared ONNXRuntime session.
+ *
+ * The first request submitted while no batch is running runs a batch inline with all
+ * pending requests. Requests arriving meanwhile are queued and run as the next batch,
+ * in a task spawned in the task group and arena of one of them, so no request waits for a timer
+ * and the batch size adapts to the load.
+ *
+ * Only models whose inputs have a fixed shape apart from the batch dimension can be
+ * batched this way, since the inputs of all requests are concatenated along dim 0.
+ */
+
+#ifndef PHYSICSTOOLS_ONNXRUNTIME_INTERFACE_ONNXRUNTIMEBATCHER_H_
+#define PHYSICSTOOLS_ONNXRUNTIME_INTERFACE_ONNXRUNTIMEBATCHER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "oneapi/tbb/task_arena.h"
+
+#include "FWCore/Concurrency/interface/WaitingTaskWithArenaHolder.h"
+#include "PhysicsTools/ONNXRuntime/interface/ONNXRuntime.h"
+
+class testONNXRuntime;
+
+namespace cms::Ort {
+
+  class ONNXRuntimeBatcher {
+    friend class ::testONNXRuntime;
+
+  public:
+    // max_batch_size: upper limit on the number of samples in one session call
+    // (a single request larger than that is run alone)
+    ONNXRuntimeBatcher(const ONNXRuntime& model,
+                       std::vector<std::string> input_names,
+                       std::vector<std::string> output_names,
+                       unsigned int max_batch_size);
+    ONNXRuntimeBatcher(const ONNXRuntimeBatcher&) = delete;
+    ONNXRuntimeBatcher& operator=(const ONNXRuntimeBatcher&) = delete;
+
+    // Queue `batch_size` (> 0) samples for inference. `input_values` must stay valid and `outputs`
+    // must not be accessed until `holder` is signaled; `outputs` is then filled as by ONNXRuntime::run.
+    void submit(FloatArrays& input_values,
+                int64_t batch_size,
+                FloatArrays& outputs,
+                edm::WaitingTaskWithArenaHolder holder);
+
+  private:
+    struct Request {
+      FloatArrays* inputs;
+      int64_t batch_size;
+      FloatArrays* outputs;
+      edm::WaitingTaskWithArenaHolder holder;
+      std::shared_ptr<oneapi::tbb::task_arena> arena;
+    };
+
+    // Run one batch of pending requests, then hand the rest (if any) to a new task
+    void runBatch();
+
+    const ONNXRuntime& model_;
+    const std::vector<std::string> input_names_;
+    const std::vector<std::string> output_names_;
+    const unsigned int max_batch_size_;
+
+    std::mutex mutex_;
+    std::vector<Request> pending_;
+    bool running_ = false;
+  };
+
+}  // namespace cms::Ort
+
+#endif /* PHYSICSTOOLS_ONNXRUNTIME_INTERFACE_ONNXRUNTIMEBATCHER_H_ */
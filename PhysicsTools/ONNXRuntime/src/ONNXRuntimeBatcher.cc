@@ -0,0 +1,122 @@
+/*
+ * ONNXRuntimeBatcher.cc
+ */
+
+#include "PhysicsTools/ONNXRuntime/interface/ONNXRuntimeBatcher.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <exception>
+#include <memory>
+#include <utility>
+
+namespace cms::Ort {
+
+  ONNXRuntimeBatcher::ONNXRuntimeBatcher(const ONNXRuntime& model,
+                                         std::vector<std::string> input_names,
+                                         std::vector<std::string> output_names,
+                                         unsigned int max_batch_size)
+      : model_(model),
+        input_names_(std::move(input_names)),
+        output_names_(std::move(output_names)),
+        max_batch_size_(max_batch_size) {
+    if (max_batch_size_ == 0) {
+      throw cms::Exception("InvalidConfiguration") << "ONNXRuntimeBatcher: max_batch_size must be positive";
+    }
+  }
+
+  void ONNXRuntimeBatcher::submit(FloatArrays& input_values,
+                                  int64_t batch_size,
+                                  FloatArrays& outputs,
+                                  edm::WaitingTaskWithArenaHolder holder) {
+    if (input_values.size() != input_names_.size()) {
+      throw cms::Exception("RuntimeError") << "ONNXRuntimeBatcher: got " << input_values.size() << " inputs, expected "
+                                           << input_names_.size();
+    }
+    if (batch_size <= 0) {
+      throw cms::Exception("RuntimeError") << "ONNXRuntimeBatcher: batch_size must be positive, got " << batch_size;
+    }
+    // the arena of the calling thread, where the follow-up batches are run (as done by the holder itself)
+    auto arena = std::make_shared<oneapi::tbb::task_arena>(oneapi::tbb::task_arena::attach());
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      pending_.push_back(Request{&input_values, batch_size, &outputs, std::move(holder), std::move(arena)});
+      if (running_)
+        return;
+      running_ = true;
+    }
+    runBatch();
+  }
+
+  void ONNXRuntimeBatcher::runBatch() {
+    std::vector<Request> batch;
+    int64_t total = 0;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto it = pending_.begin();
+      for (; it != pending_.end(); ++it) {
+        if (!batch.empty() && total + it->batch_size > max_batch_size_)
+          break;
+        total += it->batch_size;
+        batch.push_back(std::move(*it));
+      }
+      pending_.erase(pending_.begin(), it);
+    }
+
+    std::exception_ptr exc;
+    try {
+      if (batch.size() == 1) {
+        // nothing to merge
+        *batch.front().outputs = model_.run(input_names_, *batch.front().inputs, {}, output_names_, total);
+      } else {
+        // concatenate the inputs of all requests along the batch dimension
+        FloatArrays merged(input_names_.size());
+        for (unsigned i = 0; i < merged.size(); ++i) {
+          size_t len = 0;
+          for (const auto& req : batch)
+            len += (*req.inputs)[i].size();
+          merged[i].reserve(len);
+          for (const auto& req : batch)
+            merged[i].insert(merged[i].end(), (*req.inputs)[i].begin(), (*req.inputs)[i].end());
+        }
+
+        auto results = model_.run(input_names_, merged, {}, output_names_, total);
+
+        // scatter the outputs back to the requests
+        for (auto& req : batch)
+          req.outputs->resize(results.size());
+        // total > 0, since submit() only accepts requests with a positive batch size
+        for (unsigned o = 0; o < results.size(); ++o) {
+          const size_t row_len = results[o].size() / total;
+          auto begin = results[o].begin();
+          for (auto& req : batch) {
+            auto end = begin + row_len * req.batch_size;
+            (*req.outputs)[o].assign(begin, end);
+            begin = end;
+          }
+        }
+      }
+    } catch (...) {
+      exc = std::current_exception();
+    }
+    for (auto& req : batch)
+      req.holder.doneWaiting(exc);
+
+    // requests queued while this batch was running are run in a new task, so that the
+    // caller (typically an acquire()) is not held up by the requests of other streams;
+    // the task is enqueued in the arena of the first pending request, like the holder would do
+    oneapi::tbb::task_group* group = nullptr;
+    std::shared_ptr<oneapi::tbb::task_arena> arena;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (pending_.empty()) {
+        running_ = false;
+        return;
+      }
+      group = pending_.front().holder.group();
+      arena = pending_.front().arena;
+    }
+    arena->enqueue([this, group]() { group->run([this]() { runBatch(); }); });
+  }
+
+}  // namespace cms::Ort
@@ -1,10 +1,16 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "PhysicsTools/ONNXRuntime/interface/ONNXRuntime.h"
+#include "PhysicsTools/ONNXRuntime/interface/ONNXRuntimeBatcher.h"
+#include "FWCore/Concurrency/interface/FinalWaitingTask.h"
+#include "FWCore/Concurrency/interface/WaitingTaskWithArenaHolder.h"
 #include "FWCore/ParameterSet/interface/FileInPath.h"
+#include "FWCore/Utilities/interface/Exception.h"
 #include "HeterogeneousCore/CUDAUtilities/interface/requireDevices.h"
 
+#include <cmath>
 #include <iostream>
+#include <memory>
 
 using namespace cms::Ort;
 
@@ -12,6 +18,8 @@ class testONNXRuntime : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(testONNXRuntime);
   CPPUNIT_TEST(checkCPU);
   CPPUNIT_TEST(checkGPU);
+  CPPUNIT_TEST(checkBatcher);
+  CPPUNIT_TEST(checkBatcherMerge);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -20,6 +28,8 @@ private:
 public:
   void checkCPU();
   void checkGPU();
+  void checkBatcher();
+  void checkBatcherMerge();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(testONNXRuntime);
@@ -49,3 +59,78 @@ void testONNXRuntime::checkGPU() {
     test(Backend::cuda);
   }
 }
+
+void testONNXRuntime::checkBatcher() {
+  std::string model_path = edm::FileInPath("PhysicsTools/ONNXRuntime/test/data/model.onnx").fullPath();
+  ONNXRuntime rt(model_path);
+  ONNXRuntimeBatcher batcher(rt, {"X"}, {"Y"}, 4);
+  for (const unsigned batch_size : {1, 2, 4, 5}) {
+    FloatArrays input_values{
+        std::vector<float>(batch_size * 2, 1),
+    };
+    FloatArrays outputs;
+    oneapi::tbb::task_group group;
+    edm::FinalWaitingTask task{group};
+    batcher.submit(input_values, batch_size, outputs, edm::WaitingTaskWithArenaHolder(group, &task));
+    CPPUNIT_ASSERT_NO_THROW(task.wait());
+    CPPUNIT_ASSERT(outputs.size() == 1);
+    CPPUNIT_ASSERT(outputs[0].size() == batch_size);
+    for (const auto &v : outputs[0]) {
+      CPPUNIT_ASSERT(v == 3);
+    }
+  }
+}
+
+void testONNXRuntime::checkBatcherMerge() {
+  std::string model_path = edm::FileInPath("PhysicsTools/ONNXRuntime/test/data/model.onnx").fullPath();
+  ONNXRuntime rt(model_path);
+  ONNXRuntimeBatcher batcher(rt, {"X"}, {"Y"}, 4);
+
+  // with max_batch_size = 4 the requests are run as {1, 2, 1}, {3}, {5} (alone, larger than
+  // the maximum) and {2, 2}, exercising both the merged and the single request paths
+  const std::vector<unsigned> batch_sizes{1, 2, 1, 3, 5, 2, 2};
+  const unsigned n = batch_sizes.size();
+
+  // different inputs for each request, and the reference outputs from running each one alone
+  std::vector<FloatArrays> input_values(n);
+  std::vector<FloatArrays> expected(n);
+  for (unsigned i = 0; i < n; ++i) {
+    std::vector<float> values(batch_sizes[i] * 2);
+    for (unsigned j = 0; j < values.size(); ++j)
+      values[j] = 0.5f * i + 0.25f * j;
+    input_values[i] = FloatArrays{values};
+    expected[i] = rt.run({"X"}, input_values[i], {}, {"Y"}, batch_sizes[i]);
+  }
+
+  // queue all the requests before the first batch is run
+  std::vector<FloatArrays> outputs(n);
+  oneapi::tbb::task_group group;
+  std::vector<std::unique_ptr<edm::FinalWaitingTask>> tasks;
+  batcher.running_ = true;
+  for (unsigned i = 0; i < n; ++i) {
+    tasks.push_back(std::make_unique<edm::FinalWaitingTask>(group));
+    batcher.submit(input_values[i], batch_sizes[i], outputs[i], edm::WaitingTaskWithArenaHolder(group, tasks[i].get()));
+  }
+  CPPUNIT_ASSERT(batcher.pending_.size() == n);
+  batcher.runBatch();
+
+  for (unsigned i = 0; i < n; ++i) {
+    CPPUNIT_ASSERT_NO_THROW(tasks[i]->wait());
+    CPPUNIT_ASSERT(tasks[i]->done());
+    CPPUNIT_ASSERT(outputs[i].size() == 1);
+    CPPUNIT_ASSERT(outputs[i][0].size() == batch_sizes[i]);
+    for (unsigned j = 0; j < outputs[i][0].size(); ++j) {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i][0][j], outputs[i][0][j], 1e-5 * std::abs(expected[i][0][j]) + 1e-6);
+    }
+  }
+  CPPUNIT_ASSERT(batcher.pending_.empty());
+  CPPUNIT_ASSERT(not batcher.running_);
+
+  // empty requests are rejected
+  FloatArrays empty_input{std::vector<float>()};
+  FloatArrays empty_output;
+  edm::FinalWaitingTask task{group};
+  CPPUNIT_ASSERT_THROW(
+      batcher.submit(empty_input, 0, empty_output, edm::WaitingTaskWithArenaHolder(group, &task)), cms::Exception);
+  task.waitNoThrow();
+}
@@ -14,23 +14,34 @@
 #include "DataFormats/BTauReco/interface/DeepFlavourTagInfo.h"
 
 #include "PhysicsTools/ONNXRuntime/interface/ONNXRuntime.h"
+#include "PhysicsTools/ONNXRuntime/interface/ONNXRuntimeBatcher.h"
 
 using namespace cms::Ort;
 
-class DeepFlavourONNXJetTagsProducer : public edm::stream::EDProducer<edm::GlobalCache<ONNXRuntime>> {
+namespace {
+  struct DeepFlavourONNXCache {
+    std::unique_ptr<ONNXRuntime> model;
+    // shared by all streams, only set if inference is batched across events
+    std::unique_ptr<ONNXRuntimeBatcher> batcher;
+  };
+}  // namespace
+
+class DeepFlavourONNXJetTagsProducer
+    : public edm::stream::EDProducer<edm::GlobalCache<DeepFlavourONNXCache>, edm::ExternalWork> {
 public:
-  explicit DeepFlavourONNXJetTagsProducer(const edm::ParameterSet&, const ONNXRuntime*);
+  explicit DeepFlavourONNXJetTagsProducer(const edm::ParameterSet&, const DeepFlavourONNXCache*);
   ~DeepFlavourONNXJetTagsProducer() override;
 
   static void fillDescriptions(edm::ConfigurationDescriptions&);
 
-  static std::unique_ptr<ONNXRuntime> initializeGlobalCache(const edm::ParameterSet&);
-  static void globalEndJob(const ONNXRuntime*);
+  static std::unique_ptr<DeepFlavourONNXCache> initializeGlobalCache(const edm::ParameterSet&);
+  static void globalEndJob(const DeepFlavourONNXCache*);
 
 private:
   typedef std::vector<reco::DeepFlavourTagInfo> TagInfoCollection;
   typedef reco::JetTagCollection JetTagCollection;
 
+  void acquire(edm::Event const&, edm::EventSetup const&, edm::WaitingTaskWithArenaHolder) override;
   void produce(edm::Event&, const edm::EventSetup&) override;
 
   void make_inputs(unsigned i_jet, const reco::DeepFlavourTagInfo& taginfo);
@@ -51,15 +62,16 @@ private:
   constexpr static unsigned n_features_jetpt_ = 1;
   const static std::vector<unsigned> input_sizes_;
 
-  // hold the input data
+  // hold the input and output data between acquire() and produce()
   FloatArrays data_;
+  FloatArrays outputs_;
 };
 
 const std::vector<unsigned> DeepFlavourONNXJetTagsProducer::input_sizes_{
     n_features_global_, n_cpf_* n_features_cpf_, n_npf_* n_features_npf_, n_sv_* n_features_sv_, n_features_jetpt_};
 
 DeepFlavourONNXJetTagsProducer::DeepFlavourONNXJetTagsProducer(const edm::ParameterSet& iConfig,
-                                                               const ONNXRuntime* cache)
+                                                               const DeepFlavourONNXCache* cache)
     : src_(consumes<TagInfoCollection>(iConfig.getParameter<edm::InputTag>("src"))),
       flav_names_(iConfig.getParameter<std::vector<std::string>>("flav_names")),
       input_names_(iConfig.getParameter<std::vector<std::string>>("input_names")),
@@ -84,15 +96,57 @@ void DeepFlavourONNXJetTagsProducer::fillDescriptions(edm::ConfigurationDescript
   desc.add<std::vector<std::string>>("output_names", {"ID_pred/Softmax:0"});
   desc.add<std::vector<std::string>>(
       "flav_names", std::vector<std::string>{"probb", "probbb", "problepb", "probc", "probuds", "probg"});
+  desc.add<bool>("batchAcrossEvents", false)
+      ->setComment("gather the jets of concurrent events into a single inference call per batch");
+  desc.add<unsigned int>("maxBatchSize", 1024)->setComment("maximum number of jets per batch across events");
 
   descriptions.add("pfDeepFlavourJetTags", desc);
 }
 
-std::unique_ptr<ONNXRuntime> DeepFlavourONNXJetTagsProducer::initializeGlobalCache(const edm::ParameterSet& iConfig) {
-  return std::make_unique<ONNXRuntime>(iConfig.getParameter<edm::FileInPath>("model_path").fullPath());
+std::unique_ptr<DeepFlavourONNXCache> DeepFlavourONNXJetTagsProducer::initializeGlobalCache(
+    const edm::ParameterSet& iConfig) {
+  auto cache = std::make_unique<DeepFlavourONNXCache>();
+  cache->model = std::make_unique<ONNXRuntime>(iConfig.getParameter<edm::FileInPath>("model_path").fullPath());
+  if (iConfig.getParameter<bool>("batchAcrossEvents")) {
+    cache->batcher =
+        std::make_unique<ONNXRuntimeBatcher>(*cache->model,
+                                             iConfig.getParameter<std::vector<std::string>>("input_names"),
+                                             iConfig.getParameter<std::vector<std::string>>("output_names"),
+                                             iConfig.getParameter<unsigned int>("maxBatchSize"));
+  }
+  return cache;
 }
 
-void DeepFlavourONNXJetTagsProducer::globalEndJob(const ONNXRuntime* cache) {}
+void DeepFlavourONNXJetTagsProducer::globalEndJob(const DeepFlavourONNXCache* cache) {}
+
+void DeepFlavourONNXJetTagsProducer::acquire(edm::Event const& iEvent,
+                                             edm::EventSetup const& iSetup,
+                                             edm::WaitingTaskWithArenaHolder holder) {
+  const auto& tag_infos = iEvent.get(src_);
+
+  outputs_.clear();
+  if (tag_infos.empty())
+    return;
+
+  // init data storage
+  data_.clear();
+  for (const auto& len : input_sizes_) {
+    data_.emplace_back(tag_infos.size() * len, 0.0);
+  }
+
+  // convert inputs
+  for (unsigned jet_n = 0; jet_n < tag_infos.size(); ++jet_n) {
+    const auto& taginfo = tag_infos[jet_n];
+    make_inputs(jet_n, taginfo);
+  }
+
+  // run prediction, possibly together with the jets of other events
+  if (globalCache()->batcher) {
+    globalCache()->batcher->submit(data_, tag_infos.size(), outputs_, std::move(holder));
+  } else {
+    outputs_ = globalCache()->model->run(input_names_, data_, {}, output_names_, tag_infos.size());
+  }
+}
 
 void DeepFlavourONNXJetTagsProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup) {
   edm::Handle<TagInfoCollection> tag_infos;
@@ -107,20 +161,7 @@ void DeepFlavourONNXJetTagsProducer::produce(edm::Event& iEvent, const edm::Even
       output_tags.emplace_back(std::make_unique<JetTagCollection>(ref2prod));
     }
 
-    // init data storage
-    data_.clear();
-    for (const auto& len : input_sizes_) {
-      data_.emplace_back(tag_infos->size() * len, 0.0);
-    }
-
-    // convert inputs
-    for (unsigned jet_n = 0; jet_n < tag_infos->size(); ++jet_n) {
-      const auto& taginfo = (*tag_infos)[jet_n];
-      make_inputs(jet_n, taginfo);
-    }
-
-    // run prediction
-    auto outputs = globalCache()->run(input_names_, data_, {}, output_names_, tag_infos->size())[0];
+    const auto& outputs = outputs_.at(0);
     assert(outputs.size() == flav_names_.size() * tag_infos->size());
 
     // get the outputs
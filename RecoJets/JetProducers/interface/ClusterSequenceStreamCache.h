@@ -0,0 +1,65 @@
+#ifndef RecoJets_JetProducers_ClusterSequenceStreamCache_h
+#define RecoJets_JetProducers_ClusterSequenceStreamCache_h
+
+//
+// The fastjet cluster sequences built in the current event by the modules of one stream,
+// used by the ClusterSequenceCache service.
+//
+// A sequence is identified by a string describing the jet and area definitions and by an
+// exact copy of the input four-momenta and user indices.
+//
+// Once built, a sequence is only used through its const methods, but the modules of a stream
+// can run concurrently: every PseudoJet returned by e.g. inclusive_jets() holds a copy of the
+// shared pointer to the ClusterSequenceStructure of the sequence. The reference count of that
+// pointer (fastjet::SharedPtr) is atomic only if fastjet is configured with
+// --enable-thread-safety (fastjet >= 3.4), which defines FASTJET_HAVE_THREAD_SAFETY: without it
+// the sequences must not be shared, see threadSafe.
+//
+
+#include "fastjet/config.h"
+#include "fastjet/ClusterSequence.hh"
+#include "fastjet/PseudoJet.hh"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ClusterSequenceStreamCache {
+public:
+  typedef std::shared_ptr<fastjet::ClusterSequence> ClusterSequencePtr;
+
+#ifdef FASTJET_HAVE_THREAD_SAFETY
+  static constexpr bool threadSafe = true;
+#else
+  static constexpr bool threadSafe = false;
+#endif
+
+  // Return the sequence built from `inputs` with the definition described by `key`, calling
+  // `cluster` if it has not been built yet. Concurrent requests for the same sequence wait
+  // for the first one to complete.
+  ClusterSequencePtr get(const std::string& key,
+                         const std::vector<fastjet::PseudoJet>& inputs,
+                         const std::function<ClusterSequencePtr()>& cluster);
+
+  // Release all the sequences.
+  void clear();
+
+private:
+  struct Entry {
+    Entry(const std::string& k, const std::vector<fastjet::PseudoJet>& in) : key(k), inputs(in) {}
+
+    const std::string key;
+    const std::vector<fastjet::PseudoJet> inputs;
+    std::once_flag built;
+    ClusterSequencePtr sequence;
+  };
+
+  static bool sameInputs(const std::vector<fastjet::PseudoJet>& a, const std::vector<fastjet::PseudoJet>& b);
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+#endif
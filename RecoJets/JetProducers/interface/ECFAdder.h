@@ -17,7 +17,9 @@ public:
   explicit ECFAdder(const edm::ParameterSet& iConfig);
 
   void produce(edm::Event& iEvent, const edm::EventSetup& iSetup) override;
-  float getECF(unsigned index, const edm::Ptr<reco::Jet>& object) const;
+  // Fill fjParticles with the (weighted) constituents of the jet
+  void getConstituents(const reco::Jet* object, std::vector<fastjet::PseudoJet>& fjParticles) const;
+  float getECF(unsigned index, const fastjet::PseudoJet& fjJet, unsigned nParticles) const;
 
   static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
 
@@ -9,6 +9,7 @@
 #include "FWCore/Utilities/interface/InputTag.h"
 #include "DataFormats/JetReco/interface/Jet.h"
 #include "DataFormats/Common/interface/ValueMap.h"
+#include "fastjet/ClusterSequence.hh"
 #include "fastjet/contrib/Njettiness.hh"
 
 class NjettinessAdder : public edm::stream::EDProducer<> {
@@ -44,7 +45,12 @@ public:
   ~NjettinessAdder() override {}
 
   void produce(edm::Event& iEvent, const edm::EventSetup& iSetup) override;
-  float getTau(unsigned num, const edm::Ptr<reco::Jet>& object) const;
+  // Fill fjParticles with the (weighted) constituents of the jet
+  void getConstituents(const reco::Jet* object, std::vector<fastjet::PseudoJet>& fjParticles) const;
+  // tau_num of the constituents; seedSequence is their clustering with seedJetDefinition_, if any
+  float getTau(unsigned num,
+               const std::vector<fastjet::PseudoJet>& fjParticles,
+               const fastjet::ClusterSequence* seedSequence) const;
 
 private:
   edm::InputTag src_;
@@ -66,6 +72,8 @@ private:
   edm::ValueMap<float> const* weightsHandle_;
 
   std::unique_ptr<fastjet::contrib::Njettiness> routine_;
+  // jet definition of the exclusive seed axes, if they are shared between the N
+  std::unique_ptr<fastjet::JetDefinition> seedJetDefinition_;
 };
 
 #endif
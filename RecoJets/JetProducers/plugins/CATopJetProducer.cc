@@ -63,15 +63,7 @@ CATopJetProducer::CATopJetProducer(edm::ParameterSet const& conf)
 void CATopJetProducer::produce(edm::Event& e, const edm::EventSetup& c) { FastjetJetProducer::produce(e, c); }
 
 void CATopJetProducer::runAlgorithm(edm::Event& iEvent, const edm::EventSetup& iSetup) {
-  if (!doAreaFastjet_ && !doRhoFastjet_) {
-    fjClusterSeq_ = std::make_shared<fastjet::ClusterSequence>(fjInputs_, *fjJetDefinition_);
-  } else if (voronoiRfact_ <= 0) {
-    fjClusterSeq_ =
-        ClusterSequencePtr(new fastjet::ClusterSequenceArea(fjInputs_, *fjJetDefinition_, *fjAreaDefinition_));
-  } else {
-    fjClusterSeq_ = ClusterSequencePtr(
-        new fastjet::ClusterSequenceVoronoiArea(fjInputs_, *fjJetDefinition_, fastjet::VoronoiAreaSpec(voronoiRfact_)));
-  }
+  clusterSequence(iEvent);
 
   if (tagAlgo_ == CA_TOPTAGGER) {
     (*legacyCMSTopTagger_).run(fjInputs_, fjJets_, fjClusterSeq_);
@@ -44,15 +44,7 @@ void CSJetProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup) {
 //______________________________________________________________________________
 void CSJetProducer::runAlgorithm(edm::Event& iEvent, edm::EventSetup const& iSetup) {
   // run algorithm
-  if (!doAreaFastjet_ && !doRhoFastjet_) {
-    fjClusterSeq_ = std::make_shared<fastjet::ClusterSequence>(fjInputs_, *fjJetDefinition_);
-  } else if (voronoiRfact_ <= 0) {
-    fjClusterSeq_ =
-        ClusterSequencePtr(new fastjet::ClusterSequenceArea(fjInputs_, *fjJetDefinition_, *fjAreaDefinition_));
-  } else {
-    fjClusterSeq_ = ClusterSequencePtr(
-        new fastjet::ClusterSequenceVoronoiArea(fjInputs_, *fjJetDefinition_, fastjet::VoronoiAreaSpec(voronoiRfact_)));
-  }
+  clusterSequence(iEvent);
 
   fjJets_.clear();
   std::vector<fastjet::PseudoJet> tempJets = fastjet::sorted_by_pt(fjClusterSeq_->inclusive_jets(jetPtMin_));
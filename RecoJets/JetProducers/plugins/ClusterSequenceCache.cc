@@ -0,0 +1,43 @@
+#include "RecoJets/JetProducers/plugins/ClusterSequenceCache.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
+
+ClusterSequenceCache::ClusterSequenceCache(const edm::ParameterSet& iConfig, edm::ActivityRegistry& iRegistry) {
+  if constexpr (!ClusterSequenceStreamCache::threadSafe) {
+    edm::LogWarning("ClusterSequenceCache")
+        << "fastjet is built without --enable-thread-safety, the cluster sequences will not be shared";
+  }
+  iRegistry.watchPreallocate(this, &ClusterSequenceCache::preallocate);
+  iRegistry.watchPostEvent(this, &ClusterSequenceCache::postEvent);
+}
+
+void ClusterSequenceCache::fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
+  edm::ParameterSetDescription desc;
+  descriptions.add("ClusterSequenceCache", desc);
+  descriptions.setComment("Shares the fastjet cluster sequences between the jet producers of an event.");
+}
+
+void ClusterSequenceCache::preallocate(const edm::service::SystemBounds& bounds) {
+  streams_.resize(bounds.maxNumberOfStreams());
+  for (auto& stream : streams_)
+    stream = std::make_unique<ClusterSequenceStreamCache>();
+}
+
+void ClusterSequenceCache::postEvent(const edm::StreamContext& sc) {
+  // release the sequences (a few MB each at high pileup) as soon as the event is done
+  streams_[sc.streamID()]->clear();
+}
+
+ClusterSequenceCache::ClusterSequencePtr ClusterSequenceCache::get(edm::StreamID streamID,
+                                                                   const std::string& key,
+                                                                   const std::vector<fastjet::PseudoJet>& inputs,
+                                                                   const std::function<ClusterSequencePtr()>& cluster) {
+  if constexpr (ClusterSequenceStreamCache::threadSafe)
+    return streams_[streamID]->get(key, inputs, cluster);
+  else
+    return cluster();
+}
+
+#include "FWCore/ServiceRegistry/interface/ServiceMaker.h"
+DEFINE_FWK_SERVICE(ClusterSequenceCache);
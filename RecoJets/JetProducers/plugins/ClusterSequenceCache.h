@@ -0,0 +1,50 @@
+#ifndef RecoJets_JetProducers_plugins_ClusterSequenceCache_h
+#define RecoJets_JetProducers_plugins_ClusterSequenceCache_h
+
+//
+// Service holding the fastjet cluster sequences built in the current event, so that jet
+// producers clustering the same inputs with the same definition (e.g. the ungroomed,
+// soft-drop and pruned versions of a jet collection) share a single clustering.
+//
+// Each stream has its own ClusterSequenceStreamCache, emptied at the end of every event.
+// The sequences are shared only if fastjet is built with thread safety, since the modules
+// of a stream use them concurrently (see ClusterSequenceStreamCache); otherwise every
+// request clusters its inputs again, as without the service.
+//
+
+#include "FWCore/ParameterSet/interface/ConfigurationDescriptions.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ServiceRegistry/interface/ActivityRegistry.h"
+#include "FWCore/ServiceRegistry/interface/StreamContext.h"
+#include "FWCore/ServiceRegistry/interface/SystemBounds.h"
+#include "FWCore/Utilities/interface/StreamID.h"
+#include "RecoJets/JetProducers/interface/ClusterSequenceStreamCache.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ClusterSequenceCache {
+public:
+  typedef ClusterSequenceStreamCache::ClusterSequencePtr ClusterSequencePtr;
+
+  ClusterSequenceCache(const edm::ParameterSet& iConfig, edm::ActivityRegistry& iRegistry);
+  static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
+
+  // Return the sequence built from `inputs` with the definition described by `key`, calling
+  // `cluster` if no module of this stream has built it yet in the current event. Concurrent
+  // requests for the same sequence wait for the first one to complete.
+  ClusterSequencePtr get(edm::StreamID streamID,
+                         const std::string& key,
+                         const std::vector<fastjet::PseudoJet>& inputs,
+                         const std::function<ClusterSequencePtr()>& cluster);
+
+private:
+  void preallocate(const edm::service::SystemBounds& bounds);
+  void postEvent(const edm::StreamContext& sc);
+
+  std::vector<std::unique_ptr<ClusterSequenceStreamCache>> streams_;
+};
+
+#endif
@@ -63,34 +63,42 @@ void ECFAdder::produce(edm::Event& iEvent, const edm::EventSetup& iSetup) {
   if (!input_weights_token_.isUninitialized())
     weightsHandle_ = &iEvent.get(input_weights_token_);
 
-  unsigned i = 0;
-  for (std::vector<unsigned>::const_iterator n = Njets_.begin(); n != Njets_.end(); ++n) {
-    // prepare room for output
-    std::vector<float> ecfN;
-    ecfN.reserve(jets->size());
-
-    for (typename edm::View<reco::Jet>::const_iterator jetIt = jets->begin(); jetIt != jets->end(); ++jetIt) {
-      edm::Ptr<reco::Jet> jetPtr = jets->ptrAt(jetIt - jets->begin());
+  // prepare room for output
+  std::vector<std::vector<float>> ecfN(Njets_.size());
+  for (auto& e : ecfN)
+    e.reserve(jets->size());
 
+  // the constituents of each jet are collected once for all the N passing the selection
+  std::vector<fastjet::PseudoJet> fjParticles;
+  for (auto const& jet : *jets) {
+    fastjet::PseudoJet fjJet;
+    bool filled = false;
+    for (unsigned i = 0; i < Njets_.size(); ++i) {
       float t = -1.0;
-      if (selectors_[n - Njets_.begin()](*jetIt))
-        t = getECF(i, jetPtr);
-
-      ecfN.push_back(t);
+      if (selectors_[i](jet)) {
+        if (not filled) {
+          getConstituents(&jet, fjParticles);
+          fjJet = join(fjParticles);
+          filled = true;
+        }
+        t = getECF(i, fjJet, fjParticles.size());
+      }
+      ecfN[i].push_back(t);
     }
+  }
 
+  for (unsigned i = 0; i < Njets_.size(); ++i) {
     auto outT = std::make_unique<edm::ValueMap<float>>();
     edm::ValueMap<float>::Filler fillerT(*outT);
-    fillerT.insert(jets, ecfN.begin(), ecfN.end());
+    fillerT.insert(jets, ecfN[i].begin(), ecfN[i].end());
     fillerT.fill();
 
     iEvent.put(std::move(outT), variables_[i]);
-    ++i;
   }
 }
 
-float ECFAdder::getECF(unsigned index, const edm::Ptr<reco::Jet>& object) const {
-  std::vector<fastjet::PseudoJet> fjParticles;
+void ECFAdder::getConstituents(const reco::Jet* object, std::vector<fastjet::PseudoJet>& fjParticles) const {
+  fjParticles.clear();
   for (unsigned k = 0; k < object->numberOfDaughters(); ++k) {
     const reco::CandidatePtr& dp = object->daughterPtr(k);
     if (dp.isNonnull() && dp.isAvailable()) {
@@ -126,8 +134,11 @@ float ECFAdder::getECF(unsigned index, const edm::Ptr<reco::Jet>& object) const
     else
       edm::LogWarning("MissingJetConstituent") << "Jet constituent required for ECF computation is missing!";
   }
-  if (fjParticles.size() > Njets_[index]) {
-    return routine_[index]->result(join(fjParticles));
+}
+
+float ECFAdder::getECF(unsigned index, const fastjet::PseudoJet& fjJet, unsigned nParticles) const {
+  if (nParticles > Njets_[index]) {
+    return routine_[index]->result(fjJet);
   } else {
     return -1.0;
   }
@@ -352,15 +352,7 @@ void FastjetJetProducer::runAlgorithm(edm::Event& iEvent, edm::EventSetup const&
   fin.close();
   */
 
-  if (!doAreaFastjet_ && !doRhoFastjet_) {
-    fjClusterSeq_ = std::make_shared<fastjet::ClusterSequence>(fjInputs_, *fjJetDefinition_);
-  } else if (voronoiRfact_ <= 0) {
-    fjClusterSeq_ =
-        ClusterSequencePtr(new fastjet::ClusterSequenceArea(fjInputs_, *fjJetDefinition_, *fjAreaDefinition_));
-  } else {
-    fjClusterSeq_ = ClusterSequencePtr(
-        new fastjet::ClusterSequenceVoronoiArea(fjInputs_, *fjJetDefinition_, fastjet::VoronoiAreaSpec(voronoiRfact_)));
-  }
+  clusterSequence(iEvent);
 
   if (!(useMassDropTagger_ || useCMSBoostedTauSeedingAlgorithm_ || useTrimming_ || useFiltering_ || usePruning_ ||
         useSoftDrop_ || useConstituentSubtraction_)) {
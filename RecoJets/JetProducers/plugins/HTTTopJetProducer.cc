@@ -91,15 +91,7 @@ void HTTTopJetProducer::produce(edm::Event& e, const edm::EventSetup& c) {
 }
 
 void HTTTopJetProducer::runAlgorithm(edm::Event& iEvent, const edm::EventSetup& iSetup) {
-  if (!doAreaFastjet_ && !doRhoFastjet_) {
-    fjClusterSeq_ = std::make_shared<fastjet::ClusterSequence>(fjInputs_, *fjJetDefinition_);
-  } else if (voronoiRfact_ <= 0) {
-    fjClusterSeq_ =
-        ClusterSequencePtr(new fastjet::ClusterSequenceArea(fjInputs_, *fjJetDefinition_, *fjAreaDefinition_));
-  } else {
-    fjClusterSeq_ = ClusterSequencePtr(
-        new fastjet::ClusterSequenceVoronoiArea(fjInputs_, *fjJetDefinition_, fastjet::VoronoiAreaSpec(voronoiRfact_)));
-  }
+  clusterSequence(iEvent);
 
   //Run the jet clustering
   vector<fastjet::PseudoJet> inclusiveJets = fjClusterSeq_->inclusive_jets(minFatjetPt_);
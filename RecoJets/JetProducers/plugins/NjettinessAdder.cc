@@ -67,6 +67,8 @@ NjettinessAdder::NjettinessAdder(const edm::ParameterSet& iConfig)
   fastjet::contrib::OnePass_WTA_KT_Axes onepass_wta_kt_axes;
   fastjet::contrib::OnePass_WTA_CA_Axes onepass_wta_ca_axes;
   fastjet::contrib::MultiPass_Axes multipass_axes(nPass_);
+  fastjet::contrib::Manual_Axes manual_axes;
+  fastjet::contrib::OnePass_Manual_Axes onepass_manual_axes;
 
   fastjet::contrib::AxesDefinition const* axesDef = nullptr;
   switch (axesDefinition_) {
@@ -106,6 +108,19 @@ NjettinessAdder::NjettinessAdder(const edm::ParameterSet& iConfig)
       break;
   };
 
+  // The exclusive kt and C/A axes for all the N come from the same clustering of the constituents:
+  // run it once per jet, and give its exclusive jets to the (one-pass) minimization as manual axes
+  if (axesDef == &kt_axes || axesDef == &onepass_kt_axes || axesDef == &ca_axes || axesDef == &onepass_ca_axes) {
+    bool kt = (axesDef == &kt_axes || axesDef == &onepass_kt_axes);
+    bool onePass = (axesDef == &onepass_kt_axes || axesDef == &onepass_ca_axes);
+    seedJetDefinition_ = std::make_unique<fastjet::JetDefinition>(
+        kt ? fastjet::kt_algorithm : fastjet::cambridge_algorithm,
+        fastjet::JetDefinition::max_allowable_R,
+        fastjet::E_scheme,
+        fastjet::Best);
+    axesDef = onePass ? static_cast<fastjet::contrib::AxesDefinition const*>(&onepass_manual_axes) : &manual_axes;
+  }
+
   routine_ = std::make_unique<fastjet::contrib::Njettiness>(*axesDef, *measureDef);
 }
 
@@ -118,33 +133,39 @@ void NjettinessAdder::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
   if (!input_weights_token_.isUninitialized())
     weightsHandle_ = &iEvent.get(input_weights_token_);
 
-  for (std::vector<unsigned>::const_iterator n = Njets_.begin(); n != Njets_.end(); ++n) {
-    std::ostringstream tauN_str;
-    tauN_str << "tau" << *n;
+  // prepare room for output
+  std::vector<std::vector<float>> tauN(Njets_.size());
+  for (auto& t : tauN)
+    t.reserve(jets->size());
 
-    // prepare room for output
-    std::vector<float> tauN;
-    tauN.reserve(jets->size());
+  // the constituents (and the seed axes) of each jet are computed once for all the N
+  std::vector<fastjet::PseudoJet> fjParticles;
+  for (auto const& jet : *jets) {
+    getConstituents(&jet, fjParticles);
 
-    for (typename edm::View<reco::Jet>::const_iterator jetIt = jets->begin(); jetIt != jets->end(); ++jetIt) {
-      edm::Ptr<reco::Jet> jetPtr = jets->ptrAt(jetIt - jets->begin());
+    std::unique_ptr<fastjet::ClusterSequence> seedSequence;
+    if (seedJetDefinition_ && !fjParticles.empty())
+      seedSequence = std::make_unique<fastjet::ClusterSequence>(fjParticles, *seedJetDefinition_);
 
-      float t = getTau(*n, jetPtr);
+    for (unsigned i = 0; i < Njets_.size(); ++i)
+      tauN[i].push_back(getTau(Njets_[i], fjParticles, seedSequence.get()));
+  }
 
-      tauN.push_back(t);
-    }
+  for (unsigned i = 0; i < Njets_.size(); ++i) {
+    std::ostringstream tauN_str;
+    tauN_str << "tau" << Njets_[i];
 
     auto outT = std::make_unique<edm::ValueMap<float>>();
     edm::ValueMap<float>::Filler fillerT(*outT);
-    fillerT.insert(jets, tauN.begin(), tauN.end());
+    fillerT.insert(jets, tauN[i].begin(), tauN[i].end());
     fillerT.fill();
 
     iEvent.put(std::move(outT), tauN_str.str());
   }
 }
 
-float NjettinessAdder::getTau(unsigned num, const edm::Ptr<reco::Jet>& object) const {
-  std::vector<fastjet::PseudoJet> fjParticles;
+void NjettinessAdder::getConstituents(const reco::Jet* object, std::vector<fastjet::PseudoJet>& fjParticles) const {
+  fjParticles.clear();
   for (unsigned k = 0; k < object->numberOfDaughters(); ++k) {
     const reco::CandidatePtr& dp = object->daughterPtr(k);
     if (dp.isNonnull() && dp.isAvailable()) {
@@ -181,7 +202,18 @@ float NjettinessAdder::getTau(unsigned num, const edm::Ptr<reco::Jet>& object) c
     else
       edm::LogWarning("MissingJetConstituent") << "Jet constituent required for N-jettiness computation is missing!";
   }
+}
 
+float NjettinessAdder::getTau(unsigned num,
+                              const std::vector<fastjet::PseudoJet>& fjParticles,
+                              const fastjet::ClusterSequence* seedSequence) const {
+  if (seedJetDefinition_) {
+    std::vector<fastjet::PseudoJet> axes;
+    if (seedSequence)
+      axes = seedSequence->exclusive_jets_up_to(num);
+    axes.resize(num);
+    routine_->setAxes(axes);
+  }
   return routine_->getTau(num, fjParticles);
 }
 
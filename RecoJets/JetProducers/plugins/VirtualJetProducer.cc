@@ -9,6 +9,7 @@
 #include "FWCore/ParameterSet/interface/ConfigurationDescriptions.h"
 #include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
 #include "RecoJets/JetProducers/plugins/VirtualJetProducer.h"
+#include "RecoJets/JetProducers/plugins/ClusterSequenceCache.h"
 #include "RecoJets/JetProducers/interface/BackgroundEstimator.h"
 #include "RecoJets/JetProducers/interface/VirtualJetProducerHelper.h"
 
@@ -22,6 +23,7 @@
 #include "FWCore/Utilities/interface/Exception.h"
 #include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
 #include "FWCore/Utilities/interface/isFinite.h"
 #include "FWCore/Framework/interface/ConsumesCollector.h"
 
@@ -511,6 +513,39 @@ bool VirtualJetProducer::isAnomalousTower(reco::CandidatePtr input) {
     return (*anomalousTowerDef_)(*input);
 }
 
+//______________________________________________________________________________
+void VirtualJetProducer::clusterSequence(const edm::Event& iEvent) {
+  auto cluster = [this]() -> ClusterSequencePtr {
+    if (!doAreaFastjet_ && !doRhoFastjet_) {
+      return std::make_shared<fastjet::ClusterSequence>(fjInputs_, *fjJetDefinition_);
+    } else if (voronoiRfact_ <= 0) {
+      return std::make_shared<fastjet::ClusterSequenceArea>(fjInputs_, *fjJetDefinition_, *fjAreaDefinition_);
+    } else {
+      return std::make_shared<fastjet::ClusterSequenceVoronoiArea>(
+          fjInputs_, *fjJetDefinition_, fastjet::VoronoiAreaSpec(voronoiRfact_));
+    }
+  };
+
+  // Plugins are not fully identified by their description, and the ghosts of the active
+  // areas only match between producers if they are seeded from the event number.
+  bool shareable = fjJetDefinition_->jet_algorithm() != fastjet::plugin_algorithm;
+  std::string key = fjJetDefinition_->description();
+  if (doAreaFastjet_ || doRhoFastjet_) {
+    if (voronoiRfact_ <= 0) {
+      shareable = shareable && useDeterministicSeed_;
+      key += "; " + fjAreaDefinition_->description() + "; minimum seed " + std::to_string(minSeed_);
+    } else {
+      key += "; " + fastjet::VoronoiAreaSpec(voronoiRfact_).description();
+    }
+  }
+
+  edm::Service<ClusterSequenceCache> cache;
+  if (shareable && cache.isAvailable())
+    fjClusterSeq_ = cache->get(iEvent.streamID(), key, fjInputs_, cluster);
+  else
+    fjClusterSeq_ = cluster();
+}
+
 //------------------------------------------------------------------------------
 // This is pure virtual.
 //______________________________________________________________________________
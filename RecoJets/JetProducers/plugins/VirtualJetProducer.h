@@ -108,6 +108,11 @@ protected:
   // This will copy the fastjet constituents to the jet itself.
   virtual void copyConstituents(const std::vector<fastjet::PseudoJet>& fjConstituents, reco::Jet* jet);
 
+  // This clusters fjInputs_ into fjClusterSeq_, with an area definition if needed.
+  // The sequence is shared with the other producers of the event that cluster the same
+  // inputs with the same definitions if the ClusterSequenceCache service is enabled.
+  void clusterSequence(const edm::Event& iEvent);
+
   // This will run the actual algorithm. This method is pure virtual and
   // has no default.
   virtual void runAlgorithm(edm::Event& iEvent, const edm::EventSetup& iSetup) = 0;
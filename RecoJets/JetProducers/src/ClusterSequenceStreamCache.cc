@@ -0,0 +1,47 @@
+#include "RecoJets/JetProducers/interface/ClusterSequenceStreamCache.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+
+bool ClusterSequenceStreamCache::sameInputs(const std::vector<fastjet::PseudoJet>& a,
+                                            const std::vector<fastjet::PseudoJet>& b) {
+  if (a.size() != b.size())
+    return false;
+  for (unsigned int i = 0; i < a.size(); ++i) {
+    if (a[i].user_index() != b[i].user_index() || a[i].px() != b[i].px() || a[i].py() != b[i].py() ||
+        a[i].pz() != b[i].pz() || a[i].E() != b[i].E())
+      return false;
+  }
+  return true;
+}
+
+ClusterSequenceStreamCache::ClusterSequencePtr ClusterSequenceStreamCache::get(
+    const std::string& key,
+    const std::vector<fastjet::PseudoJet>& inputs,
+    const std::function<ClusterSequencePtr()>& cluster) {
+  Entry* entry = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto const& e : entries_) {
+      if (e->key == key && sameInputs(e->inputs, inputs)) {
+        entry = e.get();
+        break;
+      }
+    }
+    if (entry == nullptr) {
+      entries_.push_back(std::make_unique<Entry>(key, inputs));
+      entry = entries_.back().get();
+    } else {
+      LogDebug("ClusterSequenceCache") << "Reusing the cluster sequence " << key;
+    }
+  }
+
+  // the clustering itself runs outside of the lock, so that different sequences
+  // are built concurrently; if it throws, the next request for it will try again
+  std::call_once(entry->built, [&]() { entry->sequence = cluster(); });
+  return entry->sequence;
+}
+
+void ClusterSequenceStreamCache::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+}
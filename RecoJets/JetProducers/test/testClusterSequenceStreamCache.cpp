@@ -0,0 +1,181 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "RecoJets/JetProducers/interface/ClusterSequenceStreamCache.h"
+
+#include "fastjet/AreaDefinition.hh"
+#include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/JetDefinition.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+class testClusterSequenceStreamCache : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testClusterSequenceStreamCache);
+  CPPUNIT_TEST(checkSharedSequence);
+  CPPUNIT_TEST(checkSharedAreaSequence);
+  CPPUNIT_TEST(checkDifferentSequences);
+  CPPUNIT_TEST(checkClear);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void checkSharedSequence();
+  void checkSharedAreaSequence();
+  void checkDifferentSequences();
+  void checkClear();
+
+private:
+  typedef ClusterSequenceStreamCache::ClusterSequencePtr ClusterSequencePtr;
+
+  // what a jet producer keeps of a jet
+  struct Jet {
+    double px, py, pz, e, area;
+    std::vector<int> constituents;
+    bool operator==(Jet const& other) const {
+      return px == other.px and py == other.py and pz == other.pz and e == other.e and area == other.area and
+             constituents == other.constituents;
+    }
+  };
+
+  // the inputs of one event, with their index in the collection of candidates
+  static std::vector<fastjet::PseudoJet> makeInputs(unsigned int event);
+
+  // cluster the inputs as VirtualJetProducer does, through the cache if one is given,
+  // and return the inclusive jets above ptMin
+  static std::vector<Jet> produce(ClusterSequenceStreamCache* cache,
+                                  std::vector<fastjet::PseudoJet> const& inputs,
+                                  double radius,
+                                  bool doArea,
+                                  double ptMin,
+                                  std::atomic<int>& nClustered);
+
+  // two producers with different jet pt thresholds clustering the same inputs with the same
+  // definition, concurrently as in a stream: the sequence is built once and each producer
+  // gets the same jets as without the cache
+  static void checkTwoProducers(bool doArea);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testClusterSequenceStreamCache);
+
+std::vector<fastjet::PseudoJet> testClusterSequenceStreamCache::makeInputs(unsigned int event) {
+  std::mt19937 rng(event);
+  std::exponential_distribution<double> pt(1. / 3.);
+  std::uniform_real_distribution<double> eta(-4.7, 4.7);
+  std::uniform_real_distribution<double> phi(-M_PI, M_PI);
+  std::vector<fastjet::PseudoJet> inputs;
+  for (int i = 0; i < 800; ++i) {
+    // a few hard particles on top of the soft ones
+    double p = pt(rng) * (i % 100 == 0 ? 20. : 1.);
+    fastjet::PseudoJet input;
+    input.reset_PtYPhiM(p, eta(rng), phi(rng), 0.);
+    input.set_user_index(i);
+    inputs.push_back(input);
+  }
+  return inputs;
+}
+
+std::vector<testClusterSequenceStreamCache::Jet> testClusterSequenceStreamCache::produce(
+    ClusterSequenceStreamCache* cache,
+    std::vector<fastjet::PseudoJet> const& inputs,
+    double radius,
+    bool doArea,
+    double ptMin,
+    std::atomic<int>& nClustered) {
+  fastjet::JetDefinition jetDefinition(fastjet::antikt_algorithm, radius);
+  // ghosts seeded from the event, as with useDeterministicSeed
+  fastjet::GhostedAreaSpec ghosts(5., 1, 0.01);
+  ghosts.set_random_status({1234, 5678});
+  fastjet::AreaDefinition areaDefinition(fastjet::active_area_explicit_ghosts, ghosts);
+
+  auto cluster = [&]() -> ClusterSequencePtr {
+    ++nClustered;
+    if (doArea)
+      return std::make_shared<fastjet::ClusterSequenceArea>(inputs, jetDefinition, areaDefinition);
+    return std::make_shared<fastjet::ClusterSequence>(inputs, jetDefinition);
+  };
+  std::string key = jetDefinition.description();
+  if (doArea)
+    key += "; " + areaDefinition.description();
+  ClusterSequencePtr sequence = cache ? cache->get(key, inputs, cluster) : cluster();
+
+  std::vector<Jet> jets;
+  for (auto const& jet : fastjet::sorted_by_pt(sequence->inclusive_jets(ptMin))) {
+    Jet j{jet.px(), jet.py(), jet.pz(), jet.e(), doArea ? jet.area() : 0., {}};
+    for (auto const& constituent : jet.constituents())
+      j.constituents.push_back(constituent.user_index());
+    std::sort(j.constituents.begin(), j.constituents.end());
+    jets.push_back(j);
+  }
+  return jets;
+}
+
+void testClusterSequenceStreamCache::checkTwoProducers(bool doArea) {
+  ClusterSequenceStreamCache cache;
+  for (unsigned int event = 1; event <= 10; ++event) {
+    auto inputs = makeInputs(event);
+    std::atomic<int> nClustered = 0;
+    auto expected1 = produce(nullptr, inputs, 0.8, doArea, 5., nClustered);
+    auto expected2 = produce(nullptr, inputs, 0.8, doArea, 20., nClustered);
+    CPPUNIT_ASSERT(not expected2.empty());
+
+    nClustered = 0;
+    std::vector<Jet> jets1, jets2;
+    if constexpr (ClusterSequenceStreamCache::threadSafe) {
+      std::thread producer1([&]() { jets1 = produce(&cache, inputs, 0.8, doArea, 5., nClustered); });
+      std::thread producer2([&]() { jets2 = produce(&cache, inputs, 0.8, doArea, 20., nClustered); });
+      producer1.join();
+      producer2.join();
+    } else {
+      // the service does not share the sequences in this case, use them from one thread only
+      jets1 = produce(&cache, inputs, 0.8, doArea, 5., nClustered);
+      jets2 = produce(&cache, inputs, 0.8, doArea, 20., nClustered);
+    }
+    CPPUNIT_ASSERT(nClustered == 1);
+    CPPUNIT_ASSERT(jets1 == expected1);
+    CPPUNIT_ASSERT(jets2 == expected2);
+    cache.clear();
+  }
+}
+
+void testClusterSequenceStreamCache::checkSharedSequence() { checkTwoProducers(false); }
+
+void testClusterSequenceStreamCache::checkSharedAreaSequence() { checkTwoProducers(true); }
+
+void testClusterSequenceStreamCache::checkDifferentSequences() {
+  ClusterSequenceStreamCache cache;
+  auto inputs = makeInputs(1);
+  std::atomic<int> nClustered = 0;
+  auto jets = produce(&cache, inputs, 0.4, false, 5., nClustered);
+
+  // another definition
+  CPPUNIT_ASSERT(produce(&cache, inputs, 0.8, false, 5., nClustered) != jets);
+  CPPUNIT_ASSERT(nClustered == 2);
+
+  // other inputs, or the same inputs with another index
+  auto selected = inputs;
+  selected.pop_back();
+  produce(&cache, selected, 0.4, false, 5., nClustered);
+  CPPUNIT_ASSERT(nClustered == 3);
+  auto reindexed = inputs;
+  reindexed.front().set_user_index(-1);
+  produce(&cache, reindexed, 0.4, false, 5., nClustered);
+  CPPUNIT_ASSERT(nClustered == 4);
+
+  // all of them are kept
+  CPPUNIT_ASSERT(produce(&cache, inputs, 0.4, false, 5., nClustered) == jets);
+  produce(&cache, selected, 0.4, false, 5., nClustered);
+  CPPUNIT_ASSERT(nClustered == 4);
+}
+
+void testClusterSequenceStreamCache::checkClear() {
+  ClusterSequenceStreamCache cache;
+  auto inputs = makeInputs(1);
+  std::atomic<int> nClustered = 0;
+  auto jets = produce(&cache, inputs, 0.4, false, 5., nClustered);
+  cache.clear();
+  CPPUNIT_ASSERT(produce(&cache, inputs, 0.4, false, 5., nClustered) == jets);
+  CPPUNIT_ASSERT(nClustered == 2);
+}
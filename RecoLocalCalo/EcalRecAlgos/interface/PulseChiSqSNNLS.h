@@ -7,13 +7,42 @@
 #include <set>
 #include <array>
 
+//matrices of the minimization, with the number of pulses (NP) fixed at
+//compile time unless it is Eigen::Dynamic
+template <int NP>
+struct PulseChiSqSNNLSMatrices {
+  static constexpr int MaxNP = NP == Eigen::Dynamic ? PulseVectorSize : NP;
+
+  typedef Eigen::Matrix<double, NP, 1, 0, MaxNP, 1> PulseVector;
+  typedef Eigen::Matrix<char, NP, 1, 0, MaxNP, 1> BXVector;
+  typedef Eigen::Matrix<double, NP, NP, 0, MaxNP, MaxNP> PulseMatrix;
+  typedef Eigen::Matrix<double, SampleVectorSize, NP, 0, SampleVectorSize, MaxNP> SamplePulseMatrix;
+
+  SamplePulseMatrix pulsemat;
+  PulseVector ampvec;
+  BXVector bxs;
+  unsigned int nP;
+
+  SamplePulseMatrix invcovp;
+  PulseMatrix aTamat;
+  PulseVector aTbvec;
+};
+
+class testPulseChiSqSNNLS;
+
 class PulseChiSqSNNLS {
+  // For tests
+  friend class testPulseChiSqSNNLS;
+
 public:
   typedef BXVector::Index Index;
 
   PulseChiSqSNNLS();
   ~PulseChiSqSNNLS();
 
+  //fullpulse and fullpulsecov hold the pulse template starting at sample 7 (3 samples before the in-time
+  //pulse maximum), and must be zero in the first 7 samples (rows and columns of fullpulsecov): the
+  //covariance of each pulse is added as a block of SampleVectorSize, which may start before the template
   bool DoFit(const SampleVector &samples,
              const SampleMatrix &samplecov,
              const BXVector &bxs,
@@ -36,11 +65,20 @@ public:
 
 protected:
   bool Minimize(const SampleMatrix &samplecov, const FullSampleMatrix &fullpulsecov);
-  bool NNLS();
-  void NNLSUnconstrainParameter(Index idxp);
-  void NNLSConstrainParameter(Index minratioidx);
-  bool OnePulseMinimize();
-  bool updateCov(const SampleMatrix &samplecov, const FullSampleMatrix &fullpulsecov);
+  template <int NP>
+  bool Minimize(const SampleMatrix &samplecov, const FullSampleMatrix &fullpulsecov);
+  template <typename M>
+  bool NNLS(M &m);
+  template <typename M>
+  void NNLSUnconstrainParameter(M &m, Index idxp);
+  template <typename M>
+  void NNLSConstrainParameter(M &m, Index minratioidx);
+  template <typename M>
+  bool OnePulseMinimize(M &m);
+  template <typename M>
+  bool updateCov(const M &m, const SampleMatrix &samplecov, const FullSampleMatrix &fullpulsecov);
+  template <typename M>
+  double ComputeChiSq(const M &m);
   double ComputeChiSq();
   double ComputeApproxUncertainty(unsigned int ipulse);
 
@@ -52,22 +90,12 @@ protected:
   PulseVector _ampvecmin;
 
   SampleDecompLLT _covdecomp;
-  SampleMatrix _covdecompLinv;
-  PulseMatrix _topleft_work;
-  PulseDecompLDLT _pulsedecomp;
 
   BXVector _bxs;
   BXVector _bxsmin;
   unsigned int _npulsetot;
   unsigned int _nP;
 
-  SamplePulseMatrix invcovp;
-  PulseMatrix aTamat;
-  PulseVector aTbvec;
-  PulseVector updatework;
-
-  PulseVector ampvecpermtest;
-
   double _chisq;
   bool _computeErrors;
   int _maxiters;
@@ -3,52 +3,20 @@
 #include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include <iostream>
 
-void eigen_solve_submatrix(PulseMatrix &mat, PulseVector &invec, PulseVector &outvec, unsigned NP) {
-  using namespace Eigen;
-  switch (NP) {  // pulse matrix is always square.
-    case 10: {
-      Matrix<double, 10, 10> temp = mat.topLeftCorner<10, 10>();
-      outvec.head<10>() = temp.ldlt().solve(invec.head<10>());
-    } break;
-    case 9: {
-      Matrix<double, 9, 9> temp = mat.topLeftCorner<9, 9>();
-      outvec.head<9>() = temp.ldlt().solve(invec.head<9>());
-    } break;
-    case 8: {
-      Matrix<double, 8, 8> temp = mat.topLeftCorner<8, 8>();
-      outvec.head<8>() = temp.ldlt().solve(invec.head<8>());
-    } break;
-    case 7: {
-      Matrix<double, 7, 7> temp = mat.topLeftCorner<7, 7>();
-      outvec.head<7>() = temp.ldlt().solve(invec.head<7>());
-    } break;
-    case 6: {
-      Matrix<double, 6, 6> temp = mat.topLeftCorner<6, 6>();
-      outvec.head<6>() = temp.ldlt().solve(invec.head<6>());
-    } break;
-    case 5: {
-      Matrix<double, 5, 5> temp = mat.topLeftCorner<5, 5>();
-      outvec.head<5>() = temp.ldlt().solve(invec.head<5>());
-    } break;
-    case 4: {
-      Matrix<double, 4, 4> temp = mat.topLeftCorner<4, 4>();
-      outvec.head<4>() = temp.ldlt().solve(invec.head<4>());
-    } break;
-    case 3: {
-      Matrix<double, 3, 3> temp = mat.topLeftCorner<3, 3>();
-      outvec.head<3>() = temp.ldlt().solve(invec.head<3>());
-    } break;
-    case 2: {
-      Matrix<double, 2, 2> temp = mat.topLeftCorner<2, 2>();
-      outvec.head<2>() = temp.ldlt().solve(invec.head<2>());
-    } break;
-    case 1: {
-      Matrix<double, 1, 1> temp = mat.topLeftCorner<1, 1>();
-      outvec.head<1>() = temp.ldlt().solve(invec.head<1>());
-    } break;
-    default:
-      throw cms::Exception("MultFitWeirdState")
-          << "Weird number of pulses encountered in multifit, module is configured incorrectly!";
+template <int N, typename PulseMatrix, typename PulseVector>
+void eigen_solve_submatrix(const PulseMatrix &mat, const PulseVector &invec, PulseVector &outvec, unsigned NP) {
+  // pulse matrix is always square: solve the top-left NP x NP block with a
+  // matrix of compile-time size, to call the optimized versions of the solver
+  if constexpr (N > 0) {
+    if (NP == N) {
+      Eigen::Matrix<double, N, N> temp = mat.template topLeftCorner<N, N>();
+      outvec.template head<N>() = temp.ldlt().solve(invec.template head<N>());
+    } else {
+      eigen_solve_submatrix<N - 1>(mat, invec, outvec, NP);
+    }
+  } else {
+    throw cms::Exception("MultFitWeirdState")
+        << "Weird number of pulses encountered in multifit, module is configured incorrectly!";
   }
 }
 
@@ -111,8 +79,6 @@ bool PulseChiSqSNNLS::DoFit(const SampleVector &samples,
     _ampvec.coeffRef(0) = _sampvec.coeff(_bxs.coeff(0) + 5);
   }
 
-  aTamat.resize(_npulsetot, _npulsetot);
-
   //initialize pulse template matrix
   for (int ipulse = 0; ipulse < npulse; ++ipulse) {
     int bx = _bxs.coeff(ipulse);
@@ -125,7 +91,10 @@ bool PulseChiSqSNNLS::DoFit(const SampleVector &samples,
     for (int i = 0; i < _bxs.rows(); ++i) {
       int bx = _bxs.coeff(i);
       if (bx >= 100) {
-        NNLSUnconstrainParameter(i);
+        _pulsemat.col(_nP).swap(_pulsemat.col(i));
+        std::swap(_ampvec.coeffRef(_nP), _ampvec.coeffRef(i));
+        std::swap(_bxs.coeffRef(_nP), _bxs.coeffRef(i));
+        ++_nP;
       }
     }
   }
@@ -211,9 +180,30 @@ bool PulseChiSqSNNLS::DoFit(const SampleVector &samples,
   return status;
 }
 
+bool PulseChiSqSNNLS::Minimize(const SampleMatrix &samplecov, const FullSampleMatrix &fullpulsecov) {
+  // run the minimization with matrices of compile-time size, which Eigen can
+  // unroll and vectorize, for the standard configurations: 10 active BXs,
+  // and the single-pulse prefit
+  switch (_bxs.rows()) {
+    case 1:
+      return Minimize<1>(samplecov, fullpulsecov);
+    case 10:
+      return Minimize<10>(samplecov, fullpulsecov);
+    default:
+      return Minimize<Eigen::Dynamic>(samplecov, fullpulsecov);
+  }
+}
+
+template <int NP>
 bool PulseChiSqSNNLS::Minimize(const SampleMatrix &samplecov, const FullSampleMatrix &fullpulsecov) {
   const unsigned int npulse = _bxs.rows();
 
+  PulseChiSqSNNLSMatrices<NP> m;
+  m.pulsemat = _pulsemat;
+  m.ampvec = _ampvec;
+  m.bxs = _bxs;
+  m.nP = _nP;
+
   int iter = 0;
   bool status = false;
   while (true) {
@@ -224,19 +214,19 @@ bool PulseChiSqSNNLS::Minimize(const SampleMatrix &samplecov, const FullSampleMa
       break;
     }
 
-    status = updateCov(samplecov, fullpulsecov);
+    status = updateCov(m, samplecov, fullpulsecov);
     if (!status)
       break;
     if (npulse > 1) {
-      status = NNLS();
+      status = NNLS(m);
     } else {
       //special case for one pulse fit (performance optimized)
-      status = OnePulseMinimize();
+      status = OnePulseMinimize(m);
     }
     if (!status)
       break;
 
-    double chisqnow = ComputeChiSq();
+    double chisqnow = ComputeChiSq(m);
     double deltachisq = chisqnow - _chisq;
 
     _chisq = chisqnow;
@@ -246,31 +236,37 @@ bool PulseChiSqSNNLS::Minimize(const SampleMatrix &samplecov, const FullSampleMa
     ++iter;
   }
 
+  //the pulses may have been reordered by the NNLS: copy back the permuted
+  //pulse matrix and BXs along with the fitted amplitudes
+  _pulsemat = m.pulsemat;
+  _ampvec = m.ampvec;
+  _bxs = m.bxs;
+  _nP = m.nP;
+
   return status;
 }
 
-bool PulseChiSqSNNLS::updateCov(const SampleMatrix &samplecov, const FullSampleMatrix &fullpulsecov) {
-  const unsigned int nsample = SampleVector::RowsAtCompileTime;
-  const unsigned int npulse = _bxs.rows();
+template <typename M>
+bool PulseChiSqSNNLS::updateCov(const M &m, const SampleMatrix &samplecov, const FullSampleMatrix &fullpulsecov) {
+  const unsigned int npulse = m.bxs.rows();
 
   _invcov = samplecov;  //
 
   for (unsigned int ipulse = 0; ipulse < npulse; ++ipulse) {
-    if (_ampvec.coeff(ipulse) == 0.)
+    if (m.ampvec.coeff(ipulse) == 0.)
       continue;
-    int bx = _bxs.coeff(ipulse);
+    int bx = m.bxs.coeff(ipulse);
     if (std::abs(bx) >= 100)
       continue;  //no contribution to covariance from pedestal or saturation/slew step correction
 
-    int firstsamplet = std::max(0, bx + 3);
     int offset = 7 - 3 - bx;
 
-    const double ampveccoef = _ampvec.coeff(ipulse);
+    const double ampveccoef = m.ampvec.coeff(ipulse);
     const double ampsq = ampveccoef * ampveccoef;
 
-    const unsigned int nsamplepulse = nsample - firstsamplet;
-    _invcov.block(firstsamplet, firstsamplet, nsamplepulse, nsamplepulse) +=
-        ampsq * fullpulsecov.block(firstsamplet + offset, firstsamplet + offset, nsamplepulse, nsamplepulse);
+    //the full pulse covariance is zero before the start of the pulse template (see DoFit), so the
+    //samples before the pulse (if any) can be included in a block of compile-time size
+    _invcov += ampsq * fullpulsecov.block<SampleVectorSize, SampleVectorSize>(offset, offset);
   }
 
   _covdecomp.compute(_invcov);
@@ -279,10 +275,15 @@ bool PulseChiSqSNNLS::updateCov(const SampleMatrix &samplecov, const FullSampleM
   return status;
 }
 
-double PulseChiSqSNNLS::ComputeChiSq() {
+template <typename M>
+double PulseChiSqSNNLS::ComputeChiSq(const M &m) {
   //   SampleVector resvec = _pulsemat*_ampvec - _sampvec;
   //   return resvec.transpose()*_covdecomp.solve(resvec);
 
+  return _covdecomp.matrixL().solve(m.pulsemat * m.ampvec - _sampvec).squaredNorm();
+}
+
+double PulseChiSqSNNLS::ComputeChiSq() {
   return _covdecomp.matrixL().solve(_pulsemat * _ampvec - _sampvec).squaredNorm();
 }
 
@@ -294,15 +295,19 @@ double PulseChiSqSNNLS::ComputeApproxUncertainty(unsigned int ipulse) {
   return 1. / _covdecomp.matrixL().solve(_pulsemat.col(ipulse)).norm();
 }
 
-bool PulseChiSqSNNLS::NNLS() {
+template <typename M>
+bool PulseChiSqSNNLS::NNLS(M &m) {
   //Fast NNLS (fnnls) algorithm as per http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.157.9203&rep=rep1&type=pdf
 
-  const unsigned int npulse = _bxs.rows();
+  const unsigned int npulse = m.bxs.rows();
   constexpr unsigned int nsamples = SampleVector::RowsAtCompileTime;
 
-  invcovp = _covdecomp.matrixL().solve(_pulsemat);
-  aTamat.noalias() = invcovp.transpose().lazyProduct(invcovp);
-  aTbvec.noalias() = invcovp.transpose().lazyProduct(_covdecomp.matrixL().solve(_sampvec));
+  m.invcovp = _covdecomp.matrixL().solve(m.pulsemat);
+  m.aTamat.noalias() = m.invcovp.transpose().lazyProduct(m.invcovp);
+  m.aTbvec.noalias() = m.invcovp.transpose().lazyProduct(_covdecomp.matrixL().solve(_sampvec));
+
+  typename M::PulseVector updatework;
+  typename M::PulseVector ampvecpermtest;
 
   int iter = 0;
   Index idxwmax = 0;
@@ -310,13 +315,13 @@ bool PulseChiSqSNNLS::NNLS() {
   double threshold = 1e-11;
   while (true) {
     //can only perform this step if solution is guaranteed viable
-    if (iter > 0 || _nP == 0) {
-      if (_nP == std::min(npulse, nsamples))
+    if (iter > 0 || m.nP == 0) {
+      if (m.nP == std::min(npulse, nsamples))
         break;
 
-      const unsigned int nActive = npulse - _nP;
+      const unsigned int nActive = npulse - m.nP;
 
-      updatework = aTbvec - aTamat * _ampvec;
+      updatework = m.aTbvec - m.aTamat * m.ampvec;
       Index idxwmaxprev = idxwmax;
       double wmaxprev = wmax;
       wmax = updatework.tail(nActive).maxCoeff(&idxwmax);
@@ -332,29 +337,29 @@ bool PulseChiSqSNNLS::NNLS() {
       }
 
       //unconstrain parameter
-      Index idxp = _nP + idxwmax;
-      NNLSUnconstrainParameter(idxp);
+      Index idxp = m.nP + idxwmax;
+      NNLSUnconstrainParameter(m, idxp);
     }
 
     while (true) {
       //printf("iter in, idxsP = %i\n",int(_idxsP.size()));
 
-      if (_nP == 0)
+      if (m.nP == 0)
         break;
 
-      ampvecpermtest = _ampvec;
+      ampvecpermtest = m.ampvec;
 
       //solve for unconstrained parameters
       //need to have specialized function to call optimized versions
       // of matrix solver... this is truly amazing...
-      eigen_solve_submatrix(aTamat, aTbvec, ampvecpermtest, _nP);
+      eigen_solve_submatrix<std::min(M::MaxNP, SampleVectorSize)>(m.aTamat, m.aTbvec, ampvecpermtest, m.nP);
 
       //check solution
       bool positive = true;
-      for (unsigned int i = 0; i < _nP; ++i)
+      for (unsigned int i = 0; i < m.nP; ++i)
         positive &= (ampvecpermtest(i) > 0);
       if (positive) {
-        _ampvec.head(_nP) = ampvecpermtest.head(_nP);
+        m.ampvec.head(m.nP) = ampvecpermtest.head(m.nP);
         break;
       }
 
@@ -363,9 +368,9 @@ bool PulseChiSqSNNLS::NNLS() {
 
       // no realizable optimization here (because it autovectorizes!)
       double minratio = std::numeric_limits<double>::max();
-      for (unsigned int ipulse = 0; ipulse < _nP; ++ipulse) {
+      for (unsigned int ipulse = 0; ipulse < m.nP; ++ipulse) {
         if (ampvecpermtest.coeff(ipulse) <= 0.) {
-          const double c_ampvec = _ampvec.coeff(ipulse);
+          const double c_ampvec = m.ampvec.coeff(ipulse);
           const double ratio = c_ampvec / (c_ampvec - ampvecpermtest.coeff(ipulse));
           if (ratio < minratio) {
             minratio = ratio;
@@ -374,13 +379,13 @@ bool PulseChiSqSNNLS::NNLS() {
         }
       }
 
-      _ampvec.head(_nP) += minratio * (ampvecpermtest.head(_nP) - _ampvec.head(_nP));
+      m.ampvec.head(m.nP) += minratio * (ampvecpermtest.head(m.nP) - m.ampvec.head(m.nP));
 
       //avoid numerical problems with later ==0. check
-      _ampvec.coeffRef(minratioidx) = 0.;
+      m.ampvec.coeffRef(minratioidx) = 0.;
 
       //printf("removing index %i, orig idx %i\n",int(minratioidx),int(_bxs.coeff(minratioidx)));
-      NNLSConstrainParameter(minratioidx);
+      NNLSConstrainParameter(m, minratioidx);
     }
     ++iter;
 
@@ -394,38 +399,49 @@ bool PulseChiSqSNNLS::NNLS() {
   return true;
 }
 
-void PulseChiSqSNNLS::NNLSUnconstrainParameter(Index idxp) {
-  aTamat.col(_nP).swap(aTamat.col(idxp));
-  aTamat.row(_nP).swap(aTamat.row(idxp));
-  _pulsemat.col(_nP).swap(_pulsemat.col(idxp));
-  std::swap(aTbvec.coeffRef(_nP), aTbvec.coeffRef(idxp));
-  std::swap(_ampvec.coeffRef(_nP), _ampvec.coeffRef(idxp));
-  std::swap(_bxs.coeffRef(_nP), _bxs.coeffRef(idxp));
-  ++_nP;
+template <typename M>
+void PulseChiSqSNNLS::NNLSUnconstrainParameter(M &m, Index idxp) {
+  m.aTamat.col(m.nP).swap(m.aTamat.col(idxp));
+  m.aTamat.row(m.nP).swap(m.aTamat.row(idxp));
+  m.pulsemat.col(m.nP).swap(m.pulsemat.col(idxp));
+  std::swap(m.aTbvec.coeffRef(m.nP), m.aTbvec.coeffRef(idxp));
+  std::swap(m.ampvec.coeffRef(m.nP), m.ampvec.coeffRef(idxp));
+  std::swap(m.bxs.coeffRef(m.nP), m.bxs.coeffRef(idxp));
+  ++m.nP;
 }
 
-void PulseChiSqSNNLS::NNLSConstrainParameter(Index minratioidx) {
-  aTamat.col(_nP - 1).swap(aTamat.col(minratioidx));
-  aTamat.row(_nP - 1).swap(aTamat.row(minratioidx));
-  _pulsemat.col(_nP - 1).swap(_pulsemat.col(minratioidx));
-  std::swap(aTbvec.coeffRef(_nP - 1), aTbvec.coeffRef(minratioidx));
-  std::swap(_ampvec.coeffRef(_nP - 1), _ampvec.coeffRef(minratioidx));
-  std::swap(_bxs.coeffRef(_nP - 1), _bxs.coeffRef(minratioidx));
-  --_nP;
+template <typename M>
+void PulseChiSqSNNLS::NNLSConstrainParameter(M &m, Index minratioidx) {
+  m.aTamat.col(m.nP - 1).swap(m.aTamat.col(minratioidx));
+  m.aTamat.row(m.nP - 1).swap(m.aTamat.row(minratioidx));
+  m.pulsemat.col(m.nP - 1).swap(m.pulsemat.col(minratioidx));
+  std::swap(m.aTbvec.coeffRef(m.nP - 1), m.aTbvec.coeffRef(minratioidx));
+  std::swap(m.ampvec.coeffRef(m.nP - 1), m.ampvec.coeffRef(minratioidx));
+  std::swap(m.bxs.coeffRef(m.nP - 1), m.bxs.coeffRef(minratioidx));
+  --m.nP;
 }
 
-bool PulseChiSqSNNLS::OnePulseMinimize() {
+template <typename M>
+bool PulseChiSqSNNLS::OnePulseMinimize(M &m) {
   //Fast NNLS (fnnls) algorithm as per http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.157.9203&rep=rep1&type=pdf
 
   //   const unsigned int npulse = 1;
 
-  invcovp = _covdecomp.matrixL().solve(_pulsemat);
+  m.invcovp = _covdecomp.matrixL().solve(m.pulsemat);
   //   aTamat = invcovp.transpose()*invcovp;
   //   aTbvec = invcovp.transpose()*_covdecomp.matrixL().solve(_sampvec);
 
-  SingleMatrix aTamatval = invcovp.transpose() * invcovp;
-  SingleVector aTbvecval = invcovp.transpose() * _covdecomp.matrixL().solve(_sampvec);
-  _ampvec.coeffRef(0) = std::max(0., aTbvecval.coeff(0) / aTamatval.coeff(0));
+  const double aTamatval = m.invcovp.col(0).squaredNorm();
+  const double aTbvecval = m.invcovp.col(0).dot(_covdecomp.matrixL().solve(_sampvec));
+  m.ampvec.coeffRef(0) = std::max(0., aTbvecval / aTamatval);
 
   return true;
 }
+
+// the minimizations and the covariance update are also used directly by testPulseChiSqSNNLS
+template bool PulseChiSqSNNLS::Minimize<1>(const SampleMatrix &, const FullSampleMatrix &);
+template bool PulseChiSqSNNLS::Minimize<10>(const SampleMatrix &, const FullSampleMatrix &);
+template bool PulseChiSqSNNLS::Minimize<Eigen::Dynamic>(const SampleMatrix &, const FullSampleMatrix &);
+template bool PulseChiSqSNNLS::updateCov(const PulseChiSqSNNLSMatrices<Eigen::Dynamic> &,
+                                         const SampleMatrix &,
+                                         const FullSampleMatrix &);
@@ -0,0 +1,197 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "RecoLocalCalo/EcalRecAlgos/interface/PulseChiSqSNNLS.h"
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+class testPulseChiSqSNNLS : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testPulseChiSqSNNLS);
+  CPPUNIT_TEST(checkCovariance);
+  CPPUNIT_TEST(checkTenPulses);
+  CPPUNIT_TEST(checkOnePulse);
+  CPPUNIT_TEST(checkDoFit);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+
+  void checkCovariance();
+  void checkTenPulses();
+  void checkOnePulse();
+  void checkDoFit();
+
+private:
+  // the same state as set by PulseChiSqSNNLS::DoFit before the minimization, without pedestals or steps
+  void prepare(PulseChiSqSNNLS& fit, SampleVector const& samples, std::vector<int> const& bxs) const;
+  // samples with an in-time pulse, out-of-time pulses in some of the other BXs, and noise
+  std::vector<SampleVector> makeSamples(unsigned int n) const;
+  // run the minimization with dynamic-size matrices
+  PulseChiSqSNNLS minimizeDynamic(SampleVector const& samples, std::vector<int> const& bxs) const;
+  // run the minimization with matrices of fixed size NP, and with dynamic-size matrices
+  template <int NP>
+  void compare(SampleVector const& samples, std::vector<int> const& bxs) const;
+  static void compareResults(PulseChiSqSNNLS const& fit, PulseChiSqSNNLS const& reference);
+
+  FullSampleVector fullpulse_;
+  FullSampleMatrix fullpulsecov_;
+  SampleMatrix noisecov_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testPulseChiSqSNNLS);
+
+namespace {
+  const std::vector<int> kTenBXs = {-5, -4, -3, -2, -1, 0, 1, 2, 3, 4};
+
+  std::map<int, double> amplitudesPerBX(PulseChiSqSNNLS const& fit) {
+    std::map<int, double> amplitudes;
+    for (int i = 0; i < fit.BXs().rows(); ++i)
+      amplitudes[fit.BXs().coeff(i)] = fit.X().coeff(i);
+    return amplitudes;
+  }
+}  // namespace
+
+void testPulseChiSqSNNLS::setUp() {
+  // a pulse template starting at sample 7, and zero before it, as filled by EcalUncalibRecHitWorkerMultiFit
+  fullpulse_.setZero();
+  for (int i = 0; i < 12; ++i) {
+    const double t = i - 1.7;
+    fullpulse_(i + 7) = t > 0 ? std::pow(t / 2.3, 1.6) * std::exp(-(t - 2.3) / 1.45) : 0.;
+  }
+  fullpulse_ /= fullpulse_(9);
+  fullpulsecov_.setZero();
+  for (int i = 7; i < FullSampleVectorSize; ++i)
+    for (int j = 7; j < FullSampleVectorSize; ++j)
+      fullpulsecov_(i, j) = 1e-5 * std::exp(-0.5 * std::abs(i - j)) * (1 + 0.1 * (i + j - 14));
+  for (int i = 0; i < SampleVectorSize; ++i)
+    for (int j = 0; j < SampleVectorSize; ++j)
+      noisecov_(i, j) = 1.1 * 1.1 * std::pow(0.7, std::abs(i - j));
+}
+
+void testPulseChiSqSNNLS::prepare(PulseChiSqSNNLS& fit,
+                                  SampleVector const& samples,
+                                  std::vector<int> const& bxs) const {
+  const int npulse = bxs.size();
+  fit._sampvec = samples;
+  fit._bxs.resize(npulse);
+  fit._pulsemat.resize(Eigen::NoChange, npulse);
+  for (int ipulse = 0; ipulse < npulse; ++ipulse) {
+    fit._bxs.coeffRef(ipulse) = bxs[ipulse];
+    fit._pulsemat.col(ipulse) = fullpulse_.segment<SampleVectorSize>(7 - 3 - bxs[ipulse]);
+  }
+  fit._npulsetot = npulse;
+  fit._ampvec = PulseVector::Zero(npulse);
+  fit._errvec = PulseVector::Zero(npulse);
+  fit._nP = 0;
+  fit._chisq = 0.;
+  if (npulse == 1)
+    fit._ampvec.coeffRef(0) = samples.coeff(bxs[0] + 5);
+}
+
+std::vector<SampleVector> testPulseChiSqSNNLS::makeSamples(unsigned int n) const {
+  std::mt19937 rng(4242);
+  std::exponential_distribution<double> amplitude(1. / 20.);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  std::normal_distribution<double> noise(0., 1.1);
+  std::vector<SampleVector> samples(n);
+  for (auto& sample : samples) {
+    sample.setZero();
+    for (int bx : kTenBXs) {
+      const double a = (bx == 0 or uniform(rng) < 0.3) ? amplitude(rng) : 0.;
+      sample += a * fullpulse_.segment<SampleVectorSize>(7 - 3 - bx);
+    }
+    for (int i = 0; i < SampleVectorSize; ++i)
+      sample.coeffRef(i) += noise(rng);
+  }
+  return samples;
+}
+
+PulseChiSqSNNLS testPulseChiSqSNNLS::minimizeDynamic(SampleVector const& samples,
+                                                     std::vector<int> const& bxs) const {
+  PulseChiSqSNNLS fit;
+  prepare(fit, samples, bxs);
+  CPPUNIT_ASSERT(fit.Minimize<Eigen::Dynamic>(noisecov_, fullpulsecov_));
+  fit._ampvecmin = fit._ampvec;
+  fit._bxsmin = fit._bxs;
+  return fit;
+}
+
+template <int NP>
+void testPulseChiSqSNNLS::compare(SampleVector const& samples, std::vector<int> const& bxs) const {
+  PulseChiSqSNNLS fixed;
+  prepare(fixed, samples, bxs);
+  CPPUNIT_ASSERT(fixed.Minimize<NP>(noisecov_, fullpulsecov_));
+  fixed._ampvecmin = fixed._ampvec;
+  fixed._bxsmin = fixed._bxs;
+  PulseChiSqSNNLS dynamic = minimizeDynamic(samples, bxs);
+
+  compareResults(fixed, dynamic);
+  CPPUNIT_ASSERT(fixed._nP == dynamic._nP);
+  // the pulses are permuted along with their BXs
+  for (unsigned int i = 0; i < bxs.size(); ++i) {
+    const int bx = fixed._bxs.coeff(i);
+    CPPUNIT_ASSERT(fixed._pulsemat.col(i) == fullpulse_.segment<SampleVectorSize>(7 - 3 - bx));
+  }
+}
+
+void testPulseChiSqSNNLS::compareResults(PulseChiSqSNNLS const& fit, PulseChiSqSNNLS const& reference) {
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(reference.ChiSq(), fit.ChiSq(), 1e-9 * std::max(1., reference.ChiSq()));
+  auto amplitudes = amplitudesPerBX(fit);
+  auto expected = amplitudesPerBX(reference);
+  CPPUNIT_ASSERT(amplitudes.size() == expected.size());
+  for (auto const& [bx, amplitude] : expected) {
+    CPPUNIT_ASSERT(amplitudes.count(bx) == 1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(amplitude, amplitudes[bx], 1e-9 * std::max(1., amplitude));
+  }
+}
+
+void testPulseChiSqSNNLS::checkCovariance() {
+  // the covariance of each pulse is added as a block of fixed size, including the zeros before the
+  // pulse template: compare with the block starting at the first sample of the pulse
+  PulseChiSqSNNLS fit;
+  PulseChiSqSNNLSMatrices<Eigen::Dynamic> m;
+  m.bxs.resize(kTenBXs.size());
+  m.ampvec.resize(kTenBXs.size());
+  for (unsigned int i = 0; i < kTenBXs.size(); ++i) {
+    m.bxs.coeffRef(i) = kTenBXs[i];
+    m.ampvec.coeffRef(i) = i == 3 ? 0. : 10. + i;
+  }
+  CPPUNIT_ASSERT(fit.updateCov(m, noisecov_, fullpulsecov_));
+
+  SampleMatrix expected = noisecov_;
+  for (unsigned int i = 0; i < kTenBXs.size(); ++i) {
+    const int first = std::max(0, kTenBXs[i] + 3);
+    const int offset = 7 - 3 - kTenBXs[i];
+    const int size = SampleVectorSize - first;
+    expected.block(first, first, size, size) +=
+        m.ampvec.coeff(i) * m.ampvec.coeff(i) * fullpulsecov_.block(first + offset, first + offset, size, size);
+  }
+  for (int i = 0; i < SampleVectorSize; ++i)
+    for (int j = 0; j < SampleVectorSize; ++j)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected(i, j), fit._invcov(i, j), 1e-12 * std::abs(expected(i, j)));
+}
+
+void testPulseChiSqSNNLS::checkTenPulses() {
+  for (auto const& samples : makeSamples(200))
+    compare<10>(samples, kTenBXs);
+}
+
+void testPulseChiSqSNNLS::checkOnePulse() {
+  for (auto const& samples : makeSamples(200))
+    compare<1>(samples, {0});
+}
+
+void testPulseChiSqSNNLS::checkDoFit() {
+  // the full fit chooses the fixed-size matrices for 10 pulses
+  BXVector bxs(kTenBXs.size());
+  for (unsigned int i = 0; i < kTenBXs.size(); ++i)
+    bxs.coeffRef(i) = kTenBXs[i];
+  for (auto const& samples : makeSamples(50)) {
+    PulseChiSqSNNLS fit;
+    fit.disableErrorCalculation();
+    CPPUNIT_ASSERT(fit.DoFit(samples, noisecov_, bxs, fullpulse_, fullpulsecov_));
+    compareResults(fit, minimizeDynamic(samples, kTenBXs));
+  }
+}
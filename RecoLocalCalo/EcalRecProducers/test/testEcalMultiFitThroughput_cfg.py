@@ -0,0 +1,93 @@
+# Measure the throughput of the CPU multifit, running only the uncalibrated rechit
+# producer over the digis stored in the input files (e.g. a RAW-RECO or a skim with
+# the ecalDigis collections):
+#
+#   cmsRun testEcalMultiFitThroughput_cfg.py inputFiles=file:digis.root threads=8
+#
+# The per-module timing is reported by the FastTimerService at the end of the job.
+import FWCore.ParameterSet.Config as cms
+from Configuration.Eras.Era_Run3_cff import Run3
+
+from FWCore.ParameterSet.VarParsing import VarParsing
+options = VarParsing('analysis')
+options.register('threads',
+                 1,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.int,
+                 "Number of threads (and streams)")
+options.register('globalTag',
+                 'auto:run3_data_prompt',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "Global tag")
+options.register('digiLabel',
+                 'ecalDigis',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "Module label of the EB and EE digi collections")
+options.register('repeat',
+                 1,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.int,
+                 "Number of copies of the multifit run on each event")
+options.parseArguments()
+
+process = cms.Process('MULTIFIT', Run3)
+
+process.load('Configuration.StandardSequences.Services_cff')
+process.load('FWCore.MessageService.MessageLogger_cfi')
+process.load('Configuration.StandardSequences.GeometryRecoDB_cff')
+process.load('Configuration.StandardSequences.FrontierConditions_GlobalTag_cff')
+
+from Configuration.AlCa.GlobalTag import GlobalTag
+process.GlobalTag = GlobalTag(process.GlobalTag, options.globalTag, '')
+
+process.source = cms.Source("PoolSource",
+    fileNames = cms.untracked.vstring(options.inputFiles),
+    inputCommands = cms.untracked.vstring(
+        'drop *',
+        'keep *_%s_*_*' % options.digiLabel
+    ),
+    dropDescendantsOfDroppedBranches = cms.untracked.bool(False)
+)
+
+process.maxEvents = cms.untracked.PSet(
+    input = cms.untracked.int32(options.maxEvents)
+)
+
+process.options = cms.untracked.PSet(
+    numberOfThreads = cms.untracked.uint32(options.threads),
+    numberOfStreams = cms.untracked.uint32(0),
+    wantSummary = cms.untracked.bool(False)
+)
+
+process.load('HLTrigger.Timer.FastTimerService_cfi')
+process.FastTimerService.enableDQM = False
+process.FastTimerService.printRunSummary = False
+process.FastTimerService.printJobSummary = True
+process.FastTimerService.writeJSONSummary = True
+process.FastTimerService.jsonFileName = 'resources.json'
+process.MessageLogger.FastReport = cms.untracked.PSet()
+
+# the uncalibrated rechits with the multifit and the default (offline) configuration,
+# optionally run several times on the same digis to measure the fit alone
+import RecoLocalCalo.EcalRecProducers.ecalMultiFitUncalibRecHit_cfi
+process.multifitTask = cms.Task()
+for i in range(options.repeat):
+    multifit = RecoLocalCalo.EcalRecProducers.ecalMultiFitUncalibRecHit_cfi.ecalMultiFitUncalibRecHit.clone(
+        EBdigiCollection = (options.digiLabel, 'ebDigis'),
+        EEdigiCollection = (options.digiLabel, 'eeDigis')
+    )
+    multifit.algoPSet.useLumiInfoRunHeader = False
+    label = 'ecalMultiFitUncalibRecHit' + (str(i) if i > 0 else '')
+    setattr(process, label, multifit)
+    process.multifitTask.add(multifit)
+
+# consume the rechits without writing them, so that only the reconstruction is timed
+process.consumer = cms.EDAnalyzer("GenericConsumer",
+    eventProducts = cms.untracked.vstring(
+        *['ecalMultiFitUncalibRecHit' + (str(i) if i > 0 else '') for i in range(options.repeat)]
+    )
+)
+
+process.multifitPath = cms.EndPath(process.consumer, process.multifitTask)
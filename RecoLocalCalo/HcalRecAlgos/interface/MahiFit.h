@@ -54,12 +54,34 @@ struct MahiNnlsWorkspace {
   //for FNNLS algorithm
   unsigned int nP;
   PulseVector ampVec;
+};
+
+//matrices of the minimization, with the number of samples (NS) and of
+//pulses (NP) fixed at compile time unless they are Eigen::Dynamic
+template <int NS, int NP>
+struct MahiFitMatrices {
+  static constexpr int MaxNS = NS == Eigen::Dynamic ? MaxSVSize : NS;
+  static constexpr int MaxNP = NP == Eigen::Dynamic ? MaxPVSize : NP;
+
+  typedef Eigen::Matrix<float, NS, 1, 0, MaxNS, 1> SampleVector;
+  typedef Eigen::Matrix<float, NP, 1, 0, MaxNP, 1> PulseVector;
+  typedef Eigen::Matrix<int, NP, 1, 0, MaxNP, 1> BXVector;
+  typedef Eigen::Matrix<float, NS, NS, 0, MaxNS, MaxNS> SampleMatrix;
+  typedef Eigen::Matrix<float, NP, NP, 0, MaxNP, MaxNP> PulseMatrix;
+  typedef Eigen::Matrix<float, NS, NP, 0, MaxNS, MaxNP> SamplePulseMatrix;
+
+  SampleVector amplitudes;
+  SamplePulseMatrix pulseMat;
+  BXVector bxs;
+
+  unsigned int nP;
+  PulseVector ampVec;
 
   SamplePulseMatrix invcovp;
   PulseMatrix aTaMat;  // A-transpose A (matrix)
   PulseVector aTbVec;  // A-transpose b (vector)
 
-  SampleDecompLLT covDecomp;
+  Eigen::LLT<SampleMatrix> covDecomp;
 };
 
 struct MahiDebugInfo {
@@ -93,7 +115,12 @@ struct MahiDebugInfo {
   float ootPulse[7][MaxSVSize];
 };
 
+class testMahiFit;
+
 class MahiFit {
+  // For tests
+  friend class testMahiFit;
+
 public:
   MahiFit();
   ~MahiFit(){};
@@ -143,8 +170,13 @@ private:
   typedef std::pair<int, std::shared_ptr<FitterFuncs::PulseShapeFunctor> > ShapeWithId;
 
   const float minimize() const;
-  void onePulseMinimize() const;
-  void updateCov(const SampleMatrix& invCovMat) const;
+  template <int NS, int NP>
+  float minimize() const;
+
+  template <typename M>
+  void onePulseMinimize(M& m) const;
+  template <typename M>
+  void updateCov(M& m, const typename M::SampleMatrix& invCovMat) const;
   void resetPulseShapeTemplate(int pulseShapeId, const HcalPulseShapes& ps, unsigned int nSamples);
 
   float ccTime(const float itQ) const;
@@ -154,14 +186,19 @@ private:
                         FullSampleMatrix& pulseCov) const;
 
   float calculateArrivalTime(const unsigned int iBX) const;
-  float calculateChiSq() const;
-  void nnls() const;
+  template <typename M>
+  float calculateChiSq(const M& m) const;
+  template <typename M>
+  void nnls(M& m) const;
   void resetWorkspace() const;
 
-  void nnlsUnconstrainParameter(Index idxp) const;
-  void nnlsConstrainParameter(Index minratioidx) const;
+  template <typename M>
+  void nnlsUnconstrainParameter(M& m, Index idxp) const;
+  template <typename M>
+  void nnlsConstrainParameter(M& m, Index minratioidx) const;
 
-  void solveSubmatrix(PulseMatrix& mat, PulseVector& invec, PulseVector& outvec, unsigned nP) const;
+  template <int N, typename M>
+  void solveSubmatrix(const M& m, typename M::PulseVector& outvec) const;
 
   mutable MahiNnlsWorkspace nnlsWork_;
 
@@ -227,10 +227,38 @@ void MahiFit::doFit(std::array<float, 4>& correctedOutput, int nbx) const {
 }
 
 const float MahiFit::minimize() const {
-  nnlsWork_.invcovp.setZero(nnlsWork_.tsSize, nnlsWork_.nPulseTot);
-  nnlsWork_.ampVec.setZero(nnlsWork_.nPulseTot);
+  // run the minimization with matrices of compile-time size, which Eigen can
+  // unroll and vectorize, for the standard configurations: 8 or 10 samples,
+  // with the single-pulse pre-fit and 3 or 8 active BXs
+  const unsigned int nPulses = nnlsWork_.nPulseTot;
+  if (nnlsWork_.tsSize == 8) {
+    if (nPulses == 1)
+      return minimize<8, 1>();
+    if (nPulses == 3)
+      return minimize<8, 3>();
+    if (nPulses == 8)
+      return minimize<8, 8>();
+  } else if (nnlsWork_.tsSize == 10) {
+    if (nPulses == 1)
+      return minimize<10, 1>();
+    if (nPulses == 3)
+      return minimize<10, 3>();
+  }
+  return minimize<Eigen::Dynamic, Eigen::Dynamic>();
+}
+
+template <int NS, int NP>
+float MahiFit::minimize() const {
+  typedef MahiFitMatrices<NS, NP> Matrices;
 
-  SampleMatrix invCovMat;
+  Matrices m;
+  m.amplitudes = nnlsWork_.amplitudes;
+  m.pulseMat = nnlsWork_.pulseMat;
+  m.bxs = nnlsWork_.bxs;
+  m.nP = nnlsWork_.nP;
+  m.ampVec.setZero(nnlsWork_.nPulseTot);
+
+  typename Matrices::SampleMatrix invCovMat;
   invCovMat.setConstant(nnlsWork_.tsSize, nnlsWork_.tsSize, nnlsWork_.pedVal);
   invCovMat += nnlsWork_.noiseTerms.asDiagonal();
 
@@ -247,15 +275,15 @@ const float MahiFit::minimize() const {
   float chiSq = oldChiSq;
 
   for (int iter = 1; iter < nMaxItersMin_; ++iter) {
-    updateCov(invCovMat);
+    updateCov(m, invCovMat);
 
     if (nnlsWork_.nPulseTot > 1) {
-      nnls();
+      nnls(m);
     } else {
-      onePulseMinimize();
+      onePulseMinimize(m);
     }
 
-    const float newChiSq = calculateChiSq();
+    const float newChiSq = calculateChiSq(m);
     const float deltaChiSq = newChiSq - chiSq;
 
     if (newChiSq == oldChiSq && newChiSq < chiSq) {
@@ -268,9 +296,19 @@ const float MahiFit::minimize() const {
       break;
   }
 
+  // the pulses may have been reordered by the NNLS: copy back the permuted
+  // pulse matrix and BXs along with the fitted amplitudes
+  nnlsWork_.pulseMat = m.pulseMat;
+  nnlsWork_.bxs = m.bxs;
+  nnlsWork_.nP = m.nP;
+  nnlsWork_.ampVec = m.ampVec;
+
   return chiSq;
 }
 
+// the dynamic-size minimization is also used directly by testMahiFit
+template float MahiFit::minimize<Eigen::Dynamic, Eigen::Dynamic>() const;
+
 void MahiFit::updatePulseShape(const float itQ,
                                FullSampleVector& pulseShape,
                                FullSampleVector& pulseDeriv,
@@ -331,15 +369,16 @@ void MahiFit::updatePulseShape(const float itQ,
   }
 }
 
-void MahiFit::updateCov(const SampleMatrix& samplecov) const {
-  SampleMatrix invCovMat = samplecov;
+template <typename M>
+void MahiFit::updateCov(M& m, const typename M::SampleMatrix& samplecov) const {
+  typename M::SampleMatrix invCovMat = samplecov;
 
   for (unsigned int iBX = 0; iBX < nnlsWork_.nPulseTot; ++iBX) {
-    auto const amp = nnlsWork_.ampVec.coeff(iBX);
+    auto const amp = m.ampVec.coeff(iBX);
     if (amp == 0)
       continue;
 
-    int offset = nnlsWork_.bxs.coeff(iBX);
+    int offset = m.bxs.coeff(iBX);
 
     if (offset == pedestalBX_)
       continue;
@@ -348,7 +387,7 @@ void MahiFit::updateCov(const SampleMatrix& samplecov) const {
     }
   }
 
-  nnlsWork_.covDecomp.compute(invCovMat);
+  m.covDecomp.compute(invCovMat);
 }
 
 float MahiFit::ccTime(const float itQ) const {
@@ -436,17 +475,17 @@ float MahiFit::calculateArrivalTime(const unsigned int itIndex) const {
   return t;
 }
 
-void MahiFit::nnls() const {
+template <typename M>
+void MahiFit::nnls(M& m) const {
   const unsigned int npulse = nnlsWork_.nPulseTot;
   const unsigned int nsamples = nnlsWork_.tsSize;
 
-  PulseVector updateWork;
-  PulseVector ampvecpermtest;
+  typename M::PulseVector updateWork;
+  typename M::PulseVector ampvecpermtest;
 
-  nnlsWork_.invcovp = nnlsWork_.covDecomp.matrixL().solve(nnlsWork_.pulseMat);
-  nnlsWork_.aTaMat.noalias() = nnlsWork_.invcovp.transpose().lazyProduct(nnlsWork_.invcovp);
-  nnlsWork_.aTbVec.noalias() =
-      nnlsWork_.invcovp.transpose().lazyProduct(nnlsWork_.covDecomp.matrixL().solve(nnlsWork_.amplitudes));
+  m.invcovp = m.covDecomp.matrixL().solve(m.pulseMat);
+  m.aTaMat.noalias() = m.invcovp.transpose().lazyProduct(m.invcovp);
+  m.aTbVec.noalias() = m.invcovp.transpose().lazyProduct(m.covDecomp.matrixL().solve(m.amplitudes));
 
   int iter = 0;
   Index idxwmax = 0;
@@ -454,16 +493,16 @@ void MahiFit::nnls() const {
   float threshold = nnlsThresh_;
 
   while (true) {
-    if (iter > 0 || nnlsWork_.nP == 0) {
-      if (nnlsWork_.nP == std::min(npulse, nsamples))
+    if (iter > 0 || m.nP == 0) {
+      if (m.nP == std::min(npulse, nsamples))
         break;
 
-      const unsigned int nActive = npulse - nnlsWork_.nP;
+      const unsigned int nActive = npulse - m.nP;
       // exit if there are no more pulses to constrain
       if (nActive == 0)
         break;
 
-      updateWork.noalias() = nnlsWork_.aTbVec - nnlsWork_.aTaMat.lazyProduct(nnlsWork_.ampVec);
+      updateWork.noalias() = m.aTbVec - m.aTaMat.lazyProduct(m.ampVec);
 
       Index idxwmaxprev = idxwmax;
       float wmaxprev = wmax;
@@ -478,21 +517,21 @@ void MahiFit::nnls() const {
       }
 
       //unconstrain parameter
-      idxwmax += nnlsWork_.nP;
-      nnlsUnconstrainParameter(idxwmax);
+      idxwmax += m.nP;
+      nnlsUnconstrainParameter(m, idxwmax);
     }
 
     while (true) {
-      if (nnlsWork_.nP == 0)
+      if (m.nP == 0)
         break;
 
-      ampvecpermtest.noalias() = nnlsWork_.ampVec.head(nnlsWork_.nP);
+      ampvecpermtest = m.ampVec;
 
-      solveSubmatrix(nnlsWork_.aTaMat, nnlsWork_.aTbVec, ampvecpermtest, nnlsWork_.nP);
+      solveSubmatrix<M::MaxNP>(m, ampvecpermtest);
 
       //check solution
-      if (ampvecpermtest.head(nnlsWork_.nP).minCoeff() > 0.f) {
-        nnlsWork_.ampVec.head(nnlsWork_.nP) = ampvecpermtest.head(nnlsWork_.nP);
+      if (ampvecpermtest.head(m.nP).minCoeff() > 0.f) {
+        m.ampVec.head(m.nP) = ampvecpermtest.head(m.nP);
         break;
       }
 
@@ -501,9 +540,9 @@ void MahiFit::nnls() const {
 
       // no realizable optimization here (because it autovectorizes!)
       float minratio = std::numeric_limits<float>::max();
-      for (unsigned int ipulse = 0; ipulse < nnlsWork_.nP; ++ipulse) {
+      for (unsigned int ipulse = 0; ipulse < m.nP; ++ipulse) {
         if (ampvecpermtest.coeff(ipulse) <= 0.f) {
-          const float c_ampvec = nnlsWork_.ampVec.coeff(ipulse);
+          const float c_ampvec = m.ampVec.coeff(ipulse);
           const float ratio = c_ampvec / (c_ampvec - ampvecpermtest.coeff(ipulse));
           if (ratio < minratio) {
             minratio = ratio;
@@ -511,13 +550,12 @@ void MahiFit::nnls() const {
           }
         }
       }
-      nnlsWork_.ampVec.head(nnlsWork_.nP) +=
-          minratio * (ampvecpermtest.head(nnlsWork_.nP) - nnlsWork_.ampVec.head(nnlsWork_.nP));
+      m.ampVec.head(m.nP) += minratio * (ampvecpermtest.head(m.nP) - m.ampVec.head(m.nP));
 
       //avoid numerical problems with later ==0. check
-      nnlsWork_.ampVec.coeffRef(minratioidx) = 0.f;
+      m.ampVec.coeffRef(minratioidx) = 0.f;
 
-      nnlsConstrainParameter(minratioidx);
+      nnlsConstrainParameter(m, minratioidx);
     }
 
     ++iter;
@@ -530,19 +568,19 @@ void MahiFit::nnls() const {
   }
 }
 
-void MahiFit::onePulseMinimize() const {
-  nnlsWork_.invcovp = nnlsWork_.covDecomp.matrixL().solve(nnlsWork_.pulseMat);
+template <typename M>
+void MahiFit::onePulseMinimize(M& m) const {
+  m.invcovp = m.covDecomp.matrixL().solve(m.pulseMat);
 
-  float aTaCoeff = (nnlsWork_.invcovp.transpose() * nnlsWork_.invcovp).coeff(0);
-  float aTbCoeff =
-      (nnlsWork_.invcovp.transpose() * (nnlsWork_.covDecomp.matrixL().solve(nnlsWork_.amplitudes))).coeff(0);
+  float aTaCoeff = m.invcovp.col(0).squaredNorm();
+  float aTbCoeff = m.invcovp.col(0).dot(m.covDecomp.matrixL().solve(m.amplitudes));
 
-  nnlsWork_.ampVec.coeffRef(0) = std::max(0.f, aTbCoeff / aTaCoeff);
+  m.ampVec.coeffRef(0) = std::max(0.f, aTbCoeff / aTaCoeff);
 }
 
-float MahiFit::calculateChiSq() const {
-  return (nnlsWork_.covDecomp.matrixL().solve(nnlsWork_.pulseMat * nnlsWork_.ampVec - nnlsWork_.amplitudes))
-      .squaredNorm();
+template <typename M>
+float MahiFit::calculateChiSq(const M& m) const {
+  return (m.covDecomp.matrixL().solve(m.pulseMat * m.ampVec - m.amplitudes)).squaredNorm();
 }
 
 void MahiFit::setPulseShapeTemplate(const int pulseShapeId,
@@ -600,28 +638,30 @@ void MahiFit::resetPulseShapeTemplate(const int pulseShapeId,
   currentPulseShapeId_ = pulseShapeId;
 }
 
-void MahiFit::nnlsUnconstrainParameter(Index idxp) const {
-  if (idxp != nnlsWork_.nP) {
-    nnlsWork_.aTaMat.col(nnlsWork_.nP).swap(nnlsWork_.aTaMat.col(idxp));
-    nnlsWork_.aTaMat.row(nnlsWork_.nP).swap(nnlsWork_.aTaMat.row(idxp));
-    nnlsWork_.pulseMat.col(nnlsWork_.nP).swap(nnlsWork_.pulseMat.col(idxp));
-    Eigen::numext::swap(nnlsWork_.aTbVec.coeffRef(nnlsWork_.nP), nnlsWork_.aTbVec.coeffRef(idxp));
-    Eigen::numext::swap(nnlsWork_.ampVec.coeffRef(nnlsWork_.nP), nnlsWork_.ampVec.coeffRef(idxp));
-    Eigen::numext::swap(nnlsWork_.bxs.coeffRef(nnlsWork_.nP), nnlsWork_.bxs.coeffRef(idxp));
+template <typename M>
+void MahiFit::nnlsUnconstrainParameter(M& m, Index idxp) const {
+  if (idxp != m.nP) {
+    m.aTaMat.col(m.nP).swap(m.aTaMat.col(idxp));
+    m.aTaMat.row(m.nP).swap(m.aTaMat.row(idxp));
+    m.pulseMat.col(m.nP).swap(m.pulseMat.col(idxp));
+    Eigen::numext::swap(m.aTbVec.coeffRef(m.nP), m.aTbVec.coeffRef(idxp));
+    Eigen::numext::swap(m.ampVec.coeffRef(m.nP), m.ampVec.coeffRef(idxp));
+    Eigen::numext::swap(m.bxs.coeffRef(m.nP), m.bxs.coeffRef(idxp));
   }
-  ++nnlsWork_.nP;
+  ++m.nP;
 }
 
-void MahiFit::nnlsConstrainParameter(Index minratioidx) const {
-  if (minratioidx != (nnlsWork_.nP - 1)) {
-    nnlsWork_.aTaMat.col(nnlsWork_.nP - 1).swap(nnlsWork_.aTaMat.col(minratioidx));
-    nnlsWork_.aTaMat.row(nnlsWork_.nP - 1).swap(nnlsWork_.aTaMat.row(minratioidx));
-    nnlsWork_.pulseMat.col(nnlsWork_.nP - 1).swap(nnlsWork_.pulseMat.col(minratioidx));
-    Eigen::numext::swap(nnlsWork_.aTbVec.coeffRef(nnlsWork_.nP - 1), nnlsWork_.aTbVec.coeffRef(minratioidx));
-    Eigen::numext::swap(nnlsWork_.ampVec.coeffRef(nnlsWork_.nP - 1), nnlsWork_.ampVec.coeffRef(minratioidx));
-    Eigen::numext::swap(nnlsWork_.bxs.coeffRef(nnlsWork_.nP - 1), nnlsWork_.bxs.coeffRef(minratioidx));
+template <typename M>
+void MahiFit::nnlsConstrainParameter(M& m, Index minratioidx) const {
+  if (minratioidx != (m.nP - 1)) {
+    m.aTaMat.col(m.nP - 1).swap(m.aTaMat.col(minratioidx));
+    m.aTaMat.row(m.nP - 1).swap(m.aTaMat.row(minratioidx));
+    m.pulseMat.col(m.nP - 1).swap(m.pulseMat.col(minratioidx));
+    Eigen::numext::swap(m.aTbVec.coeffRef(m.nP - 1), m.aTbVec.coeffRef(minratioidx));
+    Eigen::numext::swap(m.ampVec.coeffRef(m.nP - 1), m.ampVec.coeffRef(minratioidx));
+    Eigen::numext::swap(m.bxs.coeffRef(m.nP - 1), m.bxs.coeffRef(minratioidx));
   }
-  --nnlsWork_.nP;
+  --m.nP;
 }
 
 void MahiFit::phase1Debug(const HBHEChannelInfo& channelData, MahiDebugInfo& mdi) const {
@@ -690,52 +730,20 @@ void MahiFit::phase1Debug(const HBHEChannelInfo& channelData, MahiDebugInfo& mdi
   }
 }
 
-void MahiFit::solveSubmatrix(PulseMatrix& mat, PulseVector& invec, PulseVector& outvec, unsigned nP) const {
-  using namespace Eigen;
-  switch (nP) {  // pulse matrix is always square.
-    case 10: {
-      Matrix<float, 10, 10> temp = mat;
-      outvec.head<10>() = temp.ldlt().solve(invec.head<10>());
-    } break;
-    case 9: {
-      Matrix<float, 9, 9> temp = mat.topLeftCorner<9, 9>();
-      outvec.head<9>() = temp.ldlt().solve(invec.head<9>());
-    } break;
-    case 8: {
-      Matrix<float, 8, 8> temp = mat.topLeftCorner<8, 8>();
-      outvec.head<8>() = temp.ldlt().solve(invec.head<8>());
-    } break;
-    case 7: {
-      Matrix<float, 7, 7> temp = mat.topLeftCorner<7, 7>();
-      outvec.head<7>() = temp.ldlt().solve(invec.head<7>());
-    } break;
-    case 6: {
-      Matrix<float, 6, 6> temp = mat.topLeftCorner<6, 6>();
-      outvec.head<6>() = temp.ldlt().solve(invec.head<6>());
-    } break;
-    case 5: {
-      Matrix<float, 5, 5> temp = mat.topLeftCorner<5, 5>();
-      outvec.head<5>() = temp.ldlt().solve(invec.head<5>());
-    } break;
-    case 4: {
-      Matrix<float, 4, 4> temp = mat.topLeftCorner<4, 4>();
-      outvec.head<4>() = temp.ldlt().solve(invec.head<4>());
-    } break;
-    case 3: {
-      Matrix<float, 3, 3> temp = mat.topLeftCorner<3, 3>();
-      outvec.head<3>() = temp.ldlt().solve(invec.head<3>());
-    } break;
-    case 2: {
-      Matrix<float, 2, 2> temp = mat.topLeftCorner<2, 2>();
-      outvec.head<2>() = temp.ldlt().solve(invec.head<2>());
-    } break;
-    case 1: {
-      Matrix<float, 1, 1> temp = mat.topLeftCorner<1, 1>();
-      outvec.head<1>() = temp.ldlt().solve(invec.head<1>());
-    } break;
-    default:
-      throw cms::Exception("HcalMahiWeirdState")
-          << "Weird number of pulses encountered in Mahi, module is configured incorrectly!";
+template <int N, typename M>
+void MahiFit::solveSubmatrix(const M& m, typename M::PulseVector& outvec) const {
+  // pulse matrix is always square: solve the top-left nP x nP block with a
+  // decomposition of compile-time size
+  if constexpr (N > 0) {
+    if (m.nP == N) {
+      Eigen::Matrix<float, N, N> temp = m.aTaMat.template topLeftCorner<N, N>();
+      outvec.template head<N>() = temp.ldlt().solve(m.aTbVec.template head<N>());
+    } else {
+      solveSubmatrix<N - 1>(m, outvec);
+    }
+  } else {
+    throw cms::Exception("HcalMahiWeirdState")
+        << "Weird number of pulses encountered in Mahi, module is configured incorrectly!";
   }
 }
 
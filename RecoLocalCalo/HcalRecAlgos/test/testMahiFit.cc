@@ -0,0 +1,148 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "RecoLocalCalo/HcalRecAlgos/interface/MahiFit.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <vector>
+
+class testMahiFit : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMahiFit);
+  CPPUNIT_TEST(checkFixedSize);
+  CPPUNIT_TEST(checkNoiseCorrelation);
+  CPPUNIT_TEST(checkOtherSize);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void checkFixedSize();
+  void checkNoiseCorrelation();
+  void checkOtherSize();
+
+private:
+  static MahiFit makeFit(unsigned int nSamples, std::vector<int> const& bxs, float noisecorr);
+  // run the fit with the matrices chosen by MahiFit::minimize(), and with dynamic-size matrices
+  static void compare(MahiFit const& fit);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMahiFit);
+
+namespace {
+  // a pulse with most of the charge in the first two samples
+  constexpr std::array<float, 6> kPulse = {{0.05f, 0.55f, 0.25f, 0.1f, 0.04f, 0.01f}};
+
+  std::map<int, float> amplitudesPerBX(MahiNnlsWorkspace const& work) {
+    std::map<int, float> amplitudes;
+    for (unsigned int i = 0; i < work.nPulseTot; ++i)
+      amplitudes[work.bxs.coeff(i)] = work.ampVec.coeff(i);
+    return amplitudes;
+  }
+}  // namespace
+
+MahiFit testMahiFit::makeFit(unsigned int nSamples, std::vector<int> const& bxs, float noisecorr) {
+  MahiFit fit;
+  fit.setParameters(false,
+                    0.,
+                    15.,
+                    false,
+                    HcalTimeSlew::Medium,
+                    false,
+                    1,
+                    5.,
+                    0.,
+                    5.,
+                    2.5,
+                    bxs,
+                    50,
+                    500,
+                    1e-3,
+                    1e-11);
+
+  // the same input as built by MahiFit::doFit, with a synthetic pulse shape
+  auto& work = fit.nnlsWork_;
+  const int soi = nSamples == 8 ? 3 : 4;
+  work.tsSize = nSamples;
+  work.tsOffset = soi;
+  work.nPulseTot = bxs.size();
+  work.bxOffset = -(*std::min_element(bxs.begin(), bxs.end()));
+  work.nP = 0;
+  work.pedVal = 0.25f;
+  work.noisecorr = noisecorr;
+
+  work.bxs.resize(work.nPulseTot);
+  work.pulseMat.setZero(nSamples, work.nPulseTot);
+  for (unsigned int iBX = 0; iBX < work.nPulseTot; ++iBX) {
+    work.bxs.coeffRef(iBX) = bxs[iBX];
+    for (unsigned int i = 0; i < kPulse.size(); ++i) {
+      const int iTS = soi + bxs[iBX] + i;
+      if (iTS >= 0 and iTS < static_cast<int>(nSamples))
+        work.pulseMat.coeffRef(iTS, iBX) = kPulse[i];
+    }
+    SampleVector column = work.pulseMat.col(iBX);
+    work.pulseCovArray[bxs[iBX] + work.bxOffset] = 1e-3f * column * column.transpose();
+  }
+
+  // an in-time pulse, an early and a late out-of-time pulse, and a ripple on top
+  std::map<int, float> charges = {{-1, 40.f}, {0, 200.f}, {2, 25.f}};
+  work.amplitudes.setZero(nSamples);
+  for (unsigned int iBX = 0; iBX < work.nPulseTot; ++iBX) {
+    auto charge = charges.find(bxs[iBX]);
+    if (charge != charges.end())
+      work.amplitudes += charge->second * work.pulseMat.col(iBX);
+  }
+  work.noiseTerms.resize(nSamples);
+  work.pedVals.resize(nSamples);
+  for (unsigned int iTS = 0; iTS < nSamples; ++iTS) {
+    work.amplitudes.coeffRef(iTS) += (iTS % 2 == 0 ? 0.7f : -0.4f);
+    work.pedVals.coeffRef(iTS) = 0.5f;
+    work.noiseTerms.coeffRef(iTS) = 1.f + 0.1f * std::max(0.f, work.amplitudes.coeff(iTS));
+  }
+  return fit;
+}
+
+void testMahiFit::compare(MahiFit const& fit) {
+  MahiFit fixed(fit);
+  const float chiSqFixed = fixed.minimize();
+  MahiFit dynamic(fit);
+  const float chiSqDynamic = dynamic.minimize<Eigen::Dynamic, Eigen::Dynamic>();
+
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(chiSqDynamic, chiSqFixed, 1e-3 * std::max(1.f, chiSqDynamic));
+  CPPUNIT_ASSERT_EQUAL(dynamic.nnlsWork_.nP, fixed.nnlsWork_.nP);
+  auto amplitudesFixed = amplitudesPerBX(fixed.nnlsWork_);
+  auto amplitudesDynamic = amplitudesPerBX(dynamic.nnlsWork_);
+  CPPUNIT_ASSERT_EQUAL(amplitudesDynamic.size(), amplitudesFixed.size());
+  for (auto const& [bx, amplitude] : amplitudesDynamic) {
+    CPPUNIT_ASSERT(amplitudesFixed.count(bx) == 1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(amplitude, amplitudesFixed[bx], 1e-4 * std::max(1.f, amplitude));
+  }
+  // the pulses are permuted along with their BXs
+  for (unsigned int i = 0; i < fixed.nnlsWork_.nPulseTot; ++i) {
+    unsigned int j = 0;
+    while (fit.nnlsWork_.bxs.coeff(j) != fixed.nnlsWork_.bxs.coeff(i))
+      ++j;
+    CPPUNIT_ASSERT(fixed.nnlsWork_.pulseMat.col(i) == fit.nnlsWork_.pulseMat.col(j));
+  }
+  // the in-time pulse is found in both cases
+  CPPUNIT_ASSERT(amplitudesDynamic.at(0) > 150.f);
+}
+
+void testMahiFit::checkFixedSize() {
+  // the configurations with fixed-size matrices: 8 samples with 1, 3 or 8 pulses, 10 samples with 1 or 3 pulses
+  compare(makeFit(8, {0}, 0.f));
+  compare(makeFit(8, {-1, 0, 1}, 0.f));
+  compare(makeFit(8, {-3, -2, -1, 0, 1, 2, 3, 4}, 0.f));
+  compare(makeFit(10, {0}, 0.f));
+  compare(makeFit(10, {-1, 0, 1}, 0.f));
+}
+
+void testMahiFit::checkNoiseCorrelation() {
+  compare(makeFit(8, {-1, 0, 1}, 0.3f));
+  compare(makeFit(8, {-3, -2, -1, 0, 1, 2, 3, 4}, 0.3f));
+}
+
+void testMahiFit::checkOtherSize() {
+  // no fixed-size matrices for these: both fits run with dynamic-size matrices
+  compare(makeFit(8, {-1, 0, 1, 2}, 0.f));
+  compare(makeFit(10, {-3, -2, -1, 0, 1, 2, 3, 4}, 0.f));
+}
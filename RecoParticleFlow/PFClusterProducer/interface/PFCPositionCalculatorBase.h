@@ -29,6 +29,7 @@ public:
   virtual void update(const edm::EventSetup&) {}
 
   // here we transform one PFCluster to use the new position calculation
+  // (may be called concurrently for different clusters, e.g. from different topo clusters)
   virtual void calculateAndSetPosition(reco::PFCluster&, const HcalPFCuts*) = 0;
   // here you call a loop inside to transform the whole vector
   virtual void calculateAndSetPositions(reco::PFClusterCollection&, const HcalPFCuts*) = 0;
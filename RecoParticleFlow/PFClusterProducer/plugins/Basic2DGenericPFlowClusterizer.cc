@@ -10,6 +10,9 @@
 #include "Math/GenVector/VectorUtil.h"
 #include "vdt/vdtMath.h"
 
+#include "oneapi/tbb/blocked_range.h"
+#include "oneapi/tbb/parallel_for.h"
+
 #include <iterator>
 #include <unordered_map>
 
@@ -48,13 +51,28 @@ private:
   std::unique_ptr<PFCPositionCalculatorBase> _allCellsPosCalc;
   std::unique_ptr<PFCPositionCalculatorBase> _convergencePosCalc;
 
+  // properties of the rechits of a topo cluster that do not change while the
+  // PF clusters are grown, stored as arrays to be looped over once per iteration
+  struct TopoHits {
+    std::vector<double> x, y, z;
+    std::vector<double> recHitEnergyNorm;
+    std::vector<bool> seedable;
+  };
+
+  void buildClustersInTopo(const reco::PFCluster&,
+                           const std::vector<bool>&,
+                           reco::PFClusterCollection&,
+                           const HcalPFCuts*) const;
+
   void seedPFClustersFromTopo(const reco::PFCluster&,
                               const std::vector<bool>&,
                               reco::PFClusterCollection&,
                               const HcalPFCuts*) const;
 
+  void fillTopoHits(const reco::PFCluster&, const std::vector<bool>&, TopoHits&, const HcalPFCuts*) const;
+
   void growPFClusters(const reco::PFCluster&,
-                      const std::vector<bool>&,
+                      const TopoHits&,
                       const unsigned toleranceScaling,
                       const unsigned iter,
                       double dist,
@@ -142,29 +160,45 @@ void Basic2DGenericPFlowClusterizer::buildClusters(const reco::PFClusterCollecti
                                                    const std::vector<bool>& seedable,
                                                    reco::PFClusterCollection& output,
                                                    const HcalPFCuts* hcalCuts) {
-  reco::PFClusterCollection clustersInTopo;
-  for (const auto& topocluster : input) {
-    clustersInTopo.clear();
-    seedPFClustersFromTopo(topocluster, seedable, clustersInTopo, hcalCuts);
-    const unsigned tolScal = std::pow(std::max(1.0, clustersInTopo.size() - 1.0), 2.0);
-    growPFClusters(topocluster, seedable, tolScal, 0, tolScal, clustersInTopo, hcalCuts);
-    // step added by Josh Bendavid, removes low-fraction clusters
-    // did not impact position resolution with fraction cut of 1e-7
-    // decreases the size of each pf cluster considerably
-    prunePFClusters(clustersInTopo);
-    // recalculate the positions of the pruned clusters
-    if (_convergencePosCalc) {
-      // if defined, use the special position calculation for convergence tests
-      _convergencePosCalc->calculateAndSetPositions(clustersInTopo, hcalCuts);
-    } else {
-      if (clustersInTopo.size() == 1 && _allCellsPosCalc) {
-        _allCellsPosCalc->calculateAndSetPosition(clustersInTopo.back(), hcalCuts);
-      } else {
-        _positionCalc->calculateAndSetPositions(clustersInTopo, hcalCuts);
-      }
+  // topo clusters are independent of each other: they are processed in parallel, each one into
+  // its own collection, and the collections are then appended in the order of the topo clusters
+  std::vector<reco::PFClusterCollection> clustersInTopos(input.size());
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, input.size()), [&](const tbb::blocked_range<size_t>& range) {
+    for (size_t i = range.begin(); i != range.end(); ++i) {
+      buildClustersInTopo(input[i], seedable, clustersInTopos[i], hcalCuts);
     }
-    for (auto& clusterout : clustersInTopo) {
-      output.insert(output.end(), std::move(clusterout));
+  });
+
+  size_t nClusters = output.size();
+  for (auto const& clustersInTopo : clustersInTopos)
+    nClusters += clustersInTopo.size();
+  output.reserve(nClusters);
+  for (auto& clustersInTopo : clustersInTopos)
+    std::move(clustersInTopo.begin(), clustersInTopo.end(), std::back_inserter(output));
+}
+
+void Basic2DGenericPFlowClusterizer::buildClustersInTopo(const reco::PFCluster& topocluster,
+                                                         const std::vector<bool>& seedable,
+                                                         reco::PFClusterCollection& clustersInTopo,
+                                                         const HcalPFCuts* hcalCuts) const {
+  seedPFClustersFromTopo(topocluster, seedable, clustersInTopo, hcalCuts);
+  TopoHits topoHits;
+  fillTopoHits(topocluster, seedable, topoHits, hcalCuts);
+  const unsigned tolScal = std::pow(std::max(1.0, clustersInTopo.size() - 1.0), 2.0);
+  growPFClusters(topocluster, topoHits, tolScal, 0, tolScal, clustersInTopo, hcalCuts);
+  // step added by Josh Bendavid, removes low-fraction clusters
+  // did not impact position resolution with fraction cut of 1e-7
+  // decreases the size of each pf cluster considerably
+  prunePFClusters(clustersInTopo);
+  // recalculate the positions of the pruned clusters
+  if (_convergencePosCalc) {
+    // if defined, use the special position calculation for convergence tests
+    _convergencePosCalc->calculateAndSetPositions(clustersInTopo, hcalCuts);
+  } else {
+    if (clustersInTopo.size() == 1 && _allCellsPosCalc) {
+      _allCellsPosCalc->calculateAndSetPosition(clustersInTopo.back(), hcalCuts);
+    } else {
+      _positionCalc->calculateAndSetPositions(clustersInTopo, hcalCuts);
     }
   }
 }
@@ -189,8 +223,53 @@ void Basic2DGenericPFlowClusterizer::seedPFClustersFromTopo(const reco::PFCluste
   }
 }
 
+void Basic2DGenericPFlowClusterizer::fillTopoHits(const reco::PFCluster& topo,
+                                                  const std::vector<bool>& seedable,
+                                                  TopoHits& hits,
+                                                  const HcalPFCuts* hcalCuts) const {
+  const auto& recHitFractions = topo.recHitFractions();
+  const unsigned nHits = recHitFractions.size();
+  hits.x.resize(nHits);
+  hits.y.resize(nHits);
+  hits.z.resize(nHits);
+  hits.recHitEnergyNorm.resize(nHits);
+  hits.seedable.resize(nHits);
+  for (unsigned ihit = 0; ihit < nHits; ++ihit) {
+    const reco::PFRecHitRef& refhit = recHitFractions[ihit].recHitRef();
+    int cell_layer = (int)refhit->layer();
+    if (cell_layer == PFLayer::HCAL_BARREL2 && std::abs(refhit->positionREP().eta()) > 0.34) {
+      cell_layer *= 100;
+    }
+
+    math::XYZPoint topocellpos_xyz(refhit->position());
+    hits.x[ihit] = topocellpos_xyz.x();
+    hits.y[ihit] = topocellpos_xyz.y();
+    hits.z[ihit] = topocellpos_xyz.z();
+    hits.seedable[ihit] = seedable[refhit.key()];
+
+    double recHitEnergyNorm = 0.;
+    auto const& recHitEnergyNormDepthPair = _recHitEnergyNorms.find(cell_layer)->second;
+
+    if (hcalCuts != nullptr &&  // this means, cutsFromDB is set to True in PFClusterProducer.cc
+        (cell_layer == PFLayer::HCAL_BARREL1 || cell_layer == PFLayer::HCAL_ENDCAP)) {
+      HcalDetId thisId = refhit->detId();
+      const HcalPFCut* item = hcalCuts->getValues(thisId.rawId());
+      recHitEnergyNorm = item->noiseThreshold();
+    } else {
+      for (unsigned int j = 0; j < recHitEnergyNormDepthPair.second.size(); ++j) {
+        int depth = recHitEnergyNormDepthPair.first[j];
+        if ((cell_layer == PFLayer::HCAL_BARREL1 && refhit->depth() == depth) ||
+            (cell_layer == PFLayer::HCAL_ENDCAP && refhit->depth() == depth) ||
+            (cell_layer != PFLayer::HCAL_ENDCAP && cell_layer != PFLayer::HCAL_BARREL1))
+          recHitEnergyNorm = recHitEnergyNormDepthPair.second[j];
+      }
+    }
+    hits.recHitEnergyNorm[ihit] = recHitEnergyNorm;
+  }
+}
+
 void Basic2DGenericPFlowClusterizer::growPFClusters(const reco::PFCluster& topo,
-                                                    const std::vector<bool>& seedable,
+                                                    const TopoHits& hits,
                                                     const unsigned toleranceScaling,
                                                     const unsigned iter,
                                                     double diff,
@@ -204,8 +283,11 @@ void Basic2DGenericPFlowClusterizer::growPFClusters(const reco::PFCluster& topo,
   if (iter >= _maxIterations || diff <= _stoppingTolerance * toleranceScaling)
     return;
   // reset the rechits in this cluster, keeping the previous position
+  const unsigned nClusters = clusters.size();
   std::vector<reco::PFCluster::REPPoint> clus_prev_pos;
-  for (auto& cluster : clusters) {
+  std::vector<double> clus_x(nClusters), clus_y(nClusters), clus_z(nClusters), clus_energy(nClusters);
+  for (unsigned i = 0; i < nClusters; ++i) {
+    auto& cluster = clusters[i];
     const reco::PFCluster::REPPoint& repp = cluster.positionREP();
     clus_prev_pos.emplace_back(repp.rho(), repp.eta(), repp.phi());
     if (_convergencePosCalc) {
@@ -216,64 +298,47 @@ void Basic2DGenericPFlowClusterizer::growPFClusters(const reco::PFCluster& topo,
       }
     }
     cluster.resetHitsAndFractions();
+    clus_x[i] = cluster.position().x();
+    clus_y[i] = cluster.position().y();
+    clus_z[i] = cluster.position().z();
+    clus_energy[i] = cluster.energy();
   }
   // loop over topo cluster and grow current PFCluster hypothesis
-  std::vector<double> dist2, frac;
-  double fractot = 0;
-  for (const reco::PFRecHitFraction& rhf : topo.recHitFractions()) {
-    const reco::PFRecHitRef& refhit = rhf.recHitRef();
-    int cell_layer = (int)refhit->layer();
-    if (cell_layer == PFLayer::HCAL_BARREL2 && std::abs(refhit->positionREP().eta()) > 0.34) {
-      cell_layer *= 100;
-    }
-
-    math::XYZPoint topocellpos_xyz(refhit->position());
-    dist2.clear();
-    frac.clear();
-    fractot = 0;
-
-    double recHitEnergyNorm = 0.;
-    auto const& recHitEnergyNormDepthPair = _recHitEnergyNorms.find(cell_layer)->second;
+  std::vector<double> dist2(nClusters), frac(nClusters);
+  const auto& recHitFractions = topo.recHitFractions();
+  for (unsigned ihit = 0; ihit < recHitFractions.size(); ++ihit) {
+    const reco::PFRecHitRef& refhit = recHitFractions[ihit].recHitRef();
+    const double hit_x = hits.x[ihit];
+    const double hit_y = hits.y[ihit];
+    const double hit_z = hits.z[ihit];
+    const double recHitEnergyNorm = hits.recHitEnergyNorm[ihit];
 
-    if (hcalCuts != nullptr &&  // this means, cutsFromDB is set to True in PFClusterProducer.cc
-        (cell_layer == PFLayer::HCAL_BARREL1 || cell_layer == PFLayer::HCAL_ENDCAP)) {
-      HcalDetId thisId = refhit->detId();
-      const HcalPFCut* item = hcalCuts->getValues(thisId.rawId());
-      recHitEnergyNorm = item->noiseThreshold();
-    } else {
-      for (unsigned int j = 0; j < recHitEnergyNormDepthPair.second.size(); ++j) {
-        int depth = recHitEnergyNormDepthPair.first[j];
-        if ((cell_layer == PFLayer::HCAL_BARREL1 && refhit->depth() == depth) ||
-            (cell_layer == PFLayer::HCAL_ENDCAP && refhit->depth() == depth) ||
-            (cell_layer != PFLayer::HCAL_ENDCAP && cell_layer != PFLayer::HCAL_BARREL1))
-          recHitEnergyNorm = recHitEnergyNormDepthPair.second[j];
-      }
+    // add rechits to clusters, calculating fraction based on distance
+    for (unsigned i = 0; i < nClusters; ++i) {
+      const double dx = clus_x[i] - hit_x;
+      const double dy = clus_y[i] - hit_y;
+      const double dz = clus_z[i] - hit_z;
+      const double d2 = (dx * dx + dy * dy + dz * dz) / _showerSigma2;
+      dist2[i] = d2;
+      frac[i] = clus_energy[i] / recHitEnergyNorm * vdt::fast_expf(-0.5 * d2);
     }
 
-    // add rechits to clusters, calculating fraction based on distance
-    for (auto& cluster : clusters) {
-      const math::XYZPoint& clusterpos_xyz = cluster.position();
-      const math::XYZVector deltav = clusterpos_xyz - topocellpos_xyz;
-      const double d2 = deltav.Mag2() / _showerSigma2;
-      dist2.emplace_back(d2);
-      if (d2 > 100) {
+    // fraction assignment logic: seeds are excluded from the other clusters
+    const bool isSeed = hits.seedable[ihit] && _excludeOtherSeeds;
+    if (isSeed) {
+      for (unsigned i = 0; i < nClusters; ++i)
+        frac[i] = (refhit->detId() == clusters[i].seed()) ? 1.0 : 0.0;
+    }
+    double fractot = 0;
+    for (unsigned i = 0; i < nClusters; ++i) {
+      if (dist2[i] > 100) {
         LOGDRESSED("Basic2DGenericPFlowClusterizer:growAndStabilizePFClusters")
-            << "Warning! :: pfcluster-topocell distance is too large! d= " << d2;
+            << "Warning! :: pfcluster-topocell distance is too large! d= " << dist2[i];
       }
-
-      // fraction assignment logic
-      double fraction;
-      if (refhit->detId() == cluster.seed() && _excludeOtherSeeds) {
-        fraction = 1.0;
-      } else if (seedable[refhit.key()] && _excludeOtherSeeds) {
-        fraction = 0.0;
-      } else {
-        fraction = cluster.energy() / recHitEnergyNorm * vdt::fast_expf(-0.5 * d2);
-      }
-      fractot += fraction;
-      frac.emplace_back(fraction);
+      fractot += frac[i];
     }
-    for (unsigned i = 0; i < clusters.size(); ++i) {
+
+    for (unsigned i = 0; i < nClusters; ++i) {
       if (fractot > _minFracTot || (refhit->detId() == clusters[i].seed() && fractot > 0.0)) {
         frac[i] /= fractot;
       } else {
@@ -312,10 +377,7 @@ void Basic2DGenericPFlowClusterizer::growPFClusters(const reco::PFCluster& topo,
       diff2 = delta2;
   }
   diff = std::sqrt(diff2);
-  dist2.clear();
-  frac.clear();
-  clus_prev_pos.clear();  // avoid badness
-  growPFClusters(topo, seedable, toleranceScaling, iter + 1, diff, clusters, hcalCuts);
+  growPFClusters(topo, hits, toleranceScaling, iter + 1, diff, clusters, hcalCuts);
 }
 
 void Basic2DGenericPFlowClusterizer::prunePFClusters(reco::PFClusterCollection& clusters) const {
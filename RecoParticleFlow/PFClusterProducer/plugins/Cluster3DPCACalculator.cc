@@ -22,8 +22,7 @@ class Cluster3DPCACalculator : public PFCPositionCalculatorBase {
 public:
   Cluster3DPCACalculator(const edm::ParameterSet& conf, edm::ConsumesCollector& cc)
       : PFCPositionCalculatorBase(conf, cc),
-        updateTiming_(conf.getParameter<bool>("updateTiming")),
-        pca_(new TPrincipal(3, "D")) {}
+        updateTiming_(conf.getParameter<bool>("updateTiming")) {}
   Cluster3DPCACalculator(const Cluster3DPCACalculator&) = delete;
   Cluster3DPCACalculator& operator=(const Cluster3DPCACalculator&) = delete;
 
@@ -32,28 +31,25 @@ public:
 
 private:
   const bool updateTiming_;
-  std::unique_ptr<TPrincipal> pca_;
 
   void showerParameters(const reco::PFCluster&, math::XYZPoint&, math::XYZVector&);
 
-  void calculateAndSetPositionActual(reco::PFCluster&);
+  void calculateAndSetPositionActual(reco::PFCluster&) const;
 };
 
 DEFINE_EDM_PLUGIN(PFCPositionCalculatorFactory, Cluster3DPCACalculator, "Cluster3DPCACalculator");
 
 void Cluster3DPCACalculator::calculateAndSetPosition(reco::PFCluster& cluster, const HcalPFCuts* cuts) {
-  pca_ = std::make_unique<TPrincipal>(3, "D");
   calculateAndSetPositionActual(cluster);
 }
 
 void Cluster3DPCACalculator::calculateAndSetPositions(reco::PFClusterCollection& clusters, const HcalPFCuts* cuts) {
   for (reco::PFCluster& cluster : clusters) {
-    pca_ = std::make_unique<TPrincipal>(3, "D");
     calculateAndSetPositionActual(cluster);
   }
 }
 
-void Cluster3DPCACalculator::calculateAndSetPositionActual(reco::PFCluster& cluster) {
+void Cluster3DPCACalculator::calculateAndSetPositionActual(reco::PFCluster& cluster) const {
   if (!cluster.seed()) {
     throw cms::Exception("ClusterWithNoSeed") << " Found a cluster with no seed: " << cluster;
   }
@@ -64,6 +60,7 @@ void Cluster3DPCACalculator::calculateAndSetPositionActual(reco::PFCluster& clus
   PFLayer::Layer max_e_layer = PFLayer::NONE;
   reco::PFRecHitRef refseed;
   double pcavars[3];
+  TPrincipal pca(3, "D");
 
   for (const reco::PFRecHitFraction& rhf : cluster.recHitFractions()) {
     const reco::PFRecHitRef& refhit = rhf.recHitRef();
@@ -98,16 +95,16 @@ void Cluster3DPCACalculator::calculateAndSetPositionActual(reco::PFCluster& clus
     int nhit = int(rh_energy * 100);  // put rec_hit energy in units of 10 MeV
 
     for (int i = 0; i < nhit; ++i) {
-      pca_->AddRow(pcavars);
+      pca.AddRow(pcavars);
     }
   }
   cluster.setEnergy(cl_energy);
   cluster.setLayer(max_e_layer);
   // calculate the position
 
-  pca_->MakePrincipals();
-  const TVectorD& means = *(pca_->GetMeanValues());
-  const TMatrixD& eigens = *(pca_->GetEigenVectors());
+  pca.MakePrincipals();
+  const TVectorD& means = *(pca.GetMeanValues());
+  const TMatrixD& eigens = *(pca.GetEigenVectors());
 
   math::XYZPoint barycenter(means[0], means[1], means[2]);
   math::XYZVector axis(eigens(0, 0), eigens(1, 0), eigens(2, 0));
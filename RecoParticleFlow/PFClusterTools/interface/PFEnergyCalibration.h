@@ -64,6 +64,11 @@ public:
   // Set the run-dependent calibration functions from the global tag
   void setCalibrationFunctions(const PerformancePayloadFromTFormula* thePFCal) { pfCalibrations = thePFCal; }
 
+  // The calibration functions from the global tag are compiled TFormulas evaluated through const methods,
+  // and the same payload is already shared by all streams, so they can be evaluated concurrently.
+  // The built-in TF1 fallback functions are owned by this object and are not meant to be shared across threads.
+  bool hasCalibrationFunctions() const { return pfCalibrations != nullptr; }
+
   void initAlphaGamma_ESplanes_fromDB(const ESEEIntercalibConstants* esEEInterCalib) {
     esEEInterCalib_ = esEEInterCalib;
   }
@@ -18,6 +18,11 @@ public:
 
   virtual double testLink(const reco::PFBlockElement*, const reco::PFBlockElement*) const = 0;
 
+  // For linkers of two cluster types that only link the clusters closer in eta-phi than this distance,
+  // computed from the positionREP() of the clusters: PFBlockAlgo then only tests the pairs found by
+  // its eta-phi index of the clusters. Negative if the link does not depend only on that distance.
+  virtual double maxEtaPhiLinkDistance() const { return -1.; }
+
   const std::string& name() const { return _linkerName; }
 
 private:
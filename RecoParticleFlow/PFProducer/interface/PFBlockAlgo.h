@@ -10,6 +10,7 @@
 #include "RecoParticleFlow/PFProducer/interface/BlockElementLinkerBase.h"
 #include "RecoParticleFlow/PFProducer/interface/KDTreeLinkerBase.h"
 #include "DataFormats/Common/interface/OwnVector.h"
+#include "CommonTools/RecoAlgos/interface/FKDTree.h"
 
 #include <memory>
 #include <string>
@@ -67,6 +68,18 @@ private:
   /// check whether 2 elements are linked. Returns distance
   inline void link(const reco::PFBlockElement* el1, const reco::PFBlockElement* el2, double& dist) const;
 
+  /// fill the eta-phi positions of the clusters and their index
+  void buildEtaPhiIndex();
+
+  /// elements in [first, last] of the given type closer in eta-phi than maxDist to element i, in increasing order
+  /// (and possibly a few more, the linker has the last word)
+  void findEtaPhiCandidates(unsigned i,
+                            reco::PFBlockElement::Type type,
+                            double maxDist,
+                            unsigned first,
+                            unsigned last,
+                            std::vector<unsigned>& candidates);
+
   // the test elements will be transferred to the blocks
   ElementList elements_;
   ElementRanges ranges_;
@@ -83,6 +96,16 @@ private:
   std::vector<std::unique_ptr<BlockElementLinkerBase>> linkTests_;
   unsigned int linkTestSquare_[reco::PFBlockElement::kNBETypes][reco::PFBlockElement::kNBETypes];
 
+  // the linkers that only link clusters closer in eta-phi than a distance (negative for the others),
+  // and the cluster types they link
+  std::vector<double> linkMaxEtaPhiDistance_;
+  std::array<bool, reco::PFBlockElement::kNBETypes> etaPhiIndexed_;
+  // eta-phi positions of the elements of these types, indexed like elements_, and an index of
+  // them in (type, eta, phi) shared by these linkers
+  std::vector<float> elementEta_;
+  std::vector<float> elementPhi_;
+  FKDTree<float, 3> etaPhiIndex_;
+
   std::vector<std::unique_ptr<KDTreeLinkerBase>> kdtrees_;
 };
 
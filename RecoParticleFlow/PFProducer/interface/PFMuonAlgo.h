@@ -43,10 +43,10 @@ public:
   static bool hasValidTrack(const reco::MuonRef& muonRef, bool loose, double maxDPtOPt);
 
   //Make a PF Muon : Basic method
-  bool reconstructMuon(reco::PFCandidate&, const reco::MuonRef&, bool allowLoose = false);
+  bool reconstructMuon(reco::PFCandidate&, const reco::MuonRef&, bool allowLoose = false) const;
 
   //Assign a different track to the muon
-  void changeTrack(reco::PFCandidate&, const MuonTrackTypePair&);
+  void changeTrack(reco::PFCandidate&, const MuonTrackTypePair&) const;
   //PF Post cleaning algorithm
   void setInputsForCleaning(reco::VertexCollection const&);
   void postClean(reco::PFCandidateCollection*);
@@ -85,7 +85,7 @@ public:
 
 private:
   //Give the track with the smallest Dpt/Pt
-  MuonTrackTypePair getTrackWithSmallestError(const std::vector<MuonTrackTypePair>&);
+  MuonTrackTypePair getTrackWithSmallestError(const std::vector<MuonTrackTypePair>&) const;
 
   //Estimate MET and SUmET for post cleaning
   void estimateEventQuantities(const reco::PFCandidateCollection*);
@@ -12,6 +12,8 @@ public:
 
   double testLink(const reco::PFBlockElement*, const reco::PFBlockElement*) const override;
 
+  double maxEtaPhiLinkDistance() const override { return 0.2; }
+
 private:
   bool useKDTree_, debug_;
 };
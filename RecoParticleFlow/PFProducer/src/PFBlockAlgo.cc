@@ -2,11 +2,14 @@
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/PluginManager/interface/PluginFactory.h"
 #include "FWCore/Utilities/interface/Exception.h"
+#include "DataFormats/ParticleFlowReco/interface/PFBlockElementCluster.h"
+#include "DataFormats/ParticleFlowReco/interface/PFCluster.h"
 
 #include <algorithm>
 #include <iostream>
 #include <array>
 #include <iterator>
+#include <limits>
 #include <sstream>
 #include <type_traits>
 #include <utility>
@@ -49,7 +52,6 @@ namespace {
     void unite(unsigned p, unsigned q) {
       unsigned rootP = find(p);
       unsigned rootQ = find(q);
-      id_[p] = q;
 
       if (size_[rootP] < size_[rootQ]) {
         id_[rootP] = rootQ;
@@ -89,6 +91,8 @@ void PFBlockAlgo::setLinkers(const std::vector<edm::ParameterSet>& confs) {
     }
   }
   linkTests_.resize(rowsize * rowsize);
+  linkMaxEtaPhiDistance_.assign(rowsize * rowsize, -1.);
+  etaPhiIndexed_.fill(false);
   const std::string prefix("PFBlockElement::");
   const std::string pfx_kdtree("KDTree");
   for (const auto& conf : confs) {
@@ -111,6 +115,11 @@ void PFBlockAlgo::setLinkers(const std::vector<edm::ParameterSet>& confs) {
     linkTests_[index] = BlockElementLinkerFactory::get()->create(linkerName, conf);
     linkTestSquare_[type1][type2] = index;
     linkTestSquare_[type2][type1] = index;
+    linkMaxEtaPhiDistance_[index] = linkTests_[index]->maxEtaPhiLinkDistance();
+    if (linkMaxEtaPhiDistance_[index] >= 0.) {
+      etaPhiIndexed_[type1] = true;
+      etaPhiIndexed_[type2] = true;
+    }
     // setup KDtree if requested
     const bool useKDTree = conf.getParameter<bool>("useKDTree");
     if (useKDTree) {
@@ -148,18 +157,40 @@ reco::PFBlockCollection PFBlockAlgo::findBlocks() {
 
   QuickUnion qu(elements_.size());
   const auto elem_size = elements_.size();
+  // element types in a contiguous array, so that the pair loop does not dereference
+  // every element to skip the type ranges without a linker
+  std::vector<PFBlockElement::Type> types(elem_size);
+  for (unsigned i = 0; i < elem_size; ++i)
+    types[i] = elements_[i]->type();
+  std::vector<unsigned> candidates;
   for (unsigned i = 0; i < elem_size; ++i) {
+    const PFBlockElement::Type type1 = types[i];
+    auto p1(elements_[i].get());
     for (unsigned j = i + 1; j < elem_size; ++j) {
-      if (qu.connected(i, j))
+      const PFBlockElement::Type type2 = types[j];
+      const unsigned index = linkTestSquare_[type1][type2];
+      // check for a linker first: it is cheaper than the union-find lookup and skips a whole type range
+      if (!linkTests_[index]) {
+        j = ranges_[type2].second;
         continue;
-      if (!linkTests_[linkTestSquare_[elements_[i]->type()][elements_[j]->type()]]) {
-        j = ranges_[elements_[j]->type()].second;
+      }
+      // the linkers by eta-phi distance only test the elements of the range found by the index,
+      // in the same order as the loop so that the blocks do not change
+      if (linkMaxEtaPhiDistance_[index] >= 0.) {
+        findEtaPhiCandidates(i, type2, linkMaxEtaPhiDistance_[index], j, ranges_[type2].second, candidates);
+        for (unsigned k : candidates) {
+          if (qu.connected(i, k))
+            continue;
+          auto p2(elements_[k].get());
+          if (linkTests_[index]->linkPrefilter(p1, p2) && linkTests_[index]->testLink(p1, p2) > -0.5)
+            qu.unite(i, k);
+        }
+        j = ranges_[type2].second;
         continue;
       }
-      auto p1(elements_[i].get()), p2(elements_[j].get());
-      const PFBlockElement::Type type1 = p1->type();
-      const PFBlockElement::Type type2 = p2->type();
-      const unsigned index = linkTestSquare_[type1][type2];
+      if (qu.connected(i, j))
+        continue;
+      auto p2(elements_[j].get());
       if (linkTests_[index]->linkPrefilter(p1, p2)) {
         const double dist = linkTests_[index]->testLink(p1, p2);
         // compute linking info if it is possible
@@ -190,9 +221,9 @@ reco::PFBlockCollection PFBlockAlgo::findBlocks() {
     auto& the_block = blocks.back();
     ElementList::value_type::pointer p1(elements_[range.first->second].get());
     the_block.addElement(p1);
-    const unsigned block_size = blocksmap.count(key) + 1;
-    //reserve up to 1M or 8MB; pay rehash cost for more
-    std::unordered_map<std::pair<unsigned int, unsigned int>, double> links(min(1000000u, block_size * block_size));
+    // only the links of the first element to the others are stored here, packLinks computes the rest
+    const unsigned block_size = blocksmap.count(key);
+    std::unordered_map<std::pair<unsigned int, unsigned int>, double> links(block_size);
     auto itr = range.first;
     ++itr;
     for (; itr != range.second; ++itr) {
@@ -258,6 +289,65 @@ void PFBlockAlgo::packLinks(reco::PFBlock& block,
   }
 }
 
+void PFBlockAlgo::buildEtaPhiIndex() {
+  const auto elem_size = elements_.size();
+  elementEta_.resize(elem_size);
+  elementPhi_.resize(elem_size);
+  std::vector<FKDPoint<float, 3>> points;
+  for (unsigned i = 0; i < elem_size; ++i) {
+    const PFBlockElement::Type type = elements_[i]->type();
+    if (!etaPhiIndexed_[type])
+      continue;
+    const reco::PFClusterRef& clusterref =
+        static_cast<const reco::PFBlockElementCluster*>(elements_[i].get())->clusterRef();
+    if (clusterref.isNull()) {
+      throw cms::Exception("BadClusterRefs") << "PFBlockElementCluster's refs are null!";
+    }
+    const reco::PFCluster::REPPoint& reppos = clusterref->positionREP();
+    elementEta_[i] = reppos.Eta();
+    elementPhi_[i] = reppos.Phi();
+    points.emplace_back(type, elementEta_[i], elementPhi_[i], i);
+  }
+  etaPhiIndex_.build(points);
+}
+
+void PFBlockAlgo::findEtaPhiCandidates(unsigned i,
+                                       PFBlockElement::Type type,
+                                       double maxDist,
+                                       unsigned first,
+                                       unsigned last,
+                                       std::vector<unsigned>& candidates) {
+  // the positions are stored as float: widen the window to keep all the pairs closer than maxDist
+  constexpr float margin = 1.e-4;
+  constexpr float twopi = 2. * M_PI;
+  constexpr float inf = std::numeric_limits<float>::max();
+  candidates.clear();
+  if (etaPhiIndex_.empty())
+    return;
+  const float eta = elementEta_[i];
+  const float phi = elementPhi_[i];
+  const float dist = maxDist + margin;
+  auto search = [&](float phiMin, float phiMax) {
+    etaPhiIndex_.search(
+        FKDPoint<float, 3>(type, eta - dist, phiMin), FKDPoint<float, 3>(type, eta + dist, phiMax), candidates);
+  };
+  if (dist >= M_PI) {
+    search(-inf, inf);
+  } else {
+    search(phi - dist, phi + dist);
+    // wrap around phi = +-pi
+    if (phi - dist < -M_PI)
+      search(phi - dist + twopi, inf);
+    if (phi + dist > M_PI)
+      search(-inf, phi + dist - twopi);
+  }
+  candidates.erase(std::remove_if(candidates.begin(),
+                                  candidates.end(),
+                                  [first, last](unsigned k) { return k < first || k > last; }),
+                   candidates.end());
+  std::sort(candidates.begin(), candidates.end());
+}
+
 inline void PFBlockAlgo::link(const reco::PFBlockElement* el1, const reco::PFBlockElement* el2, double& dist) const {
   constexpr unsigned rowsize = reco::PFBlockElement::kNBETypes;
   dist = -1.0;
@@ -319,6 +409,9 @@ void PFBlockAlgo::buildElements(const edm::Event& evt) {
       }
     }
   }
+
+  // and the eta-phi positions of the clusters to the linkers by eta-phi distance
+  buildEtaPhiIndex();
   //std::cout << "(new) imported: " << elements_.size() << " elements!" << std::endl;
 }
 
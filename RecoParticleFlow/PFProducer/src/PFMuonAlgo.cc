@@ -534,7 +534,7 @@ std::vector<reco::Muon::MuonTrackTypePair> PFMuonAlgo::muonTracks(const reco::Mu
 
 ////////////////////////////////////////////////////////////////////////////////////
 
-bool PFMuonAlgo::reconstructMuon(reco::PFCandidate& candidate, const reco::MuonRef& muon, bool allowLoose) {
+bool PFMuonAlgo::reconstructMuon(reco::PFCandidate& candidate, const reco::MuonRef& muon, bool allowLoose) const {
   using namespace std;
   using namespace reco;
 
@@ -593,7 +593,7 @@ bool PFMuonAlgo::reconstructMuon(reco::PFCandidate& candidate, const reco::MuonR
   return true;
 }
 
-void PFMuonAlgo::changeTrack(reco::PFCandidate& candidate, const MuonTrackTypePair& track) {
+void PFMuonAlgo::changeTrack(reco::PFCandidate& candidate, const MuonTrackTypePair& track) const {
   using namespace reco;
   reco::TrackRef bestTrack = track.first;
   MuonTrackType trackType = track.second;
@@ -612,7 +612,7 @@ void PFMuonAlgo::changeTrack(reco::PFCandidate& candidate, const MuonTrackTypePa
 }
 
 reco::Muon::MuonTrackTypePair PFMuonAlgo::getTrackWithSmallestError(
-    const std::vector<reco::Muon::MuonTrackTypePair>& tracks) {
+    const std::vector<reco::Muon::MuonTrackTypePair>& tracks) const {
   TrackPtErrorSorter sorter;
   return *std::min_element(tracks.begin(), tracks.end(), sorter);
 }
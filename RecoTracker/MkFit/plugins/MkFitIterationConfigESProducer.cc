@@ -21,13 +21,15 @@ private:
   const std::string configFile_;
   const float minPtCut_;
   const unsigned int maxClusterSize_;
+  const int seedsPerTask_;
 };
 
 MkFitIterationConfigESProducer::MkFitIterationConfigESProducer(const edm::ParameterSet &iConfig)
     : geomToken_{setWhatProduced(this, iConfig.getParameter<std::string>("ComponentName")).consumes()},
       configFile_{iConfig.getParameter<edm::FileInPath>("config").fullPath()},
       minPtCut_{(float)iConfig.getParameter<double>("minPt")},
-      maxClusterSize_{iConfig.getParameter<unsigned int>("maxClusterSize")} {}
+      maxClusterSize_{iConfig.getParameter<unsigned int>("maxClusterSize")},
+      seedsPerTask_{iConfig.getParameter<int>("seedsPerTask")} {}
 
 void MkFitIterationConfigESProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions) {
   edm::ParameterSetDescription desc;
@@ -36,6 +38,8 @@ void MkFitIterationConfigESProducer::fillDescriptions(edm::ConfigurationDescript
       ->setComment("Path to the JSON file for the mkFit configuration parameters");
   desc.add<double>("minPt", 0.0)->setComment("min pT cut applied during track building");
   desc.add<unsigned int>("maxClusterSize", 8)->setComment("Max cluster size of SiStrip hits");
+  desc.add<int>("seedsPerTask", 0)
+      ->setComment("Number of seeds per TBB task in track finding, 0 to adapt it to the available threads");
   descriptions.addWithDefaultLabel(desc);
 }
 
@@ -47,6 +51,7 @@ std::unique_ptr<mkfit::IterationConfig> MkFitIterationConfigESProducer::produce(
   it_conf->m_backward_params.minPtCut = minPtCut_;
   it_conf->m_params.maxClusterSize = maxClusterSize_;
   it_conf->m_backward_params.maxClusterSize = maxClusterSize_;
+  it_conf->m_seeds_per_task = seedsPerTask_;
   it_conf->setupStandardFunctionsFromNames();
   return it_conf;
 }
@@ -154,6 +154,10 @@ namespace mkfit {
     IterationParams m_params;
     IterationParams m_backward_params;
 
+    // Number of seeds processed in one TBB task during track finding, 0 for adaptive
+    // choice based on the number of available threads. Not stored in JSON.
+    int m_seeds_per_task = 0;
+
     int m_n_regions = -1;
     std::vector<int> m_region_order;
     std::vector<SteeringParams> m_steering_params;
@@ -24,6 +24,7 @@
 
 #include "oneapi/tbb/parallel_for.h"
 #include "oneapi/tbb/parallel_for_each.h"
+#include "oneapi/tbb/task_arena.h"
 
 namespace mkfit {
 
@@ -115,6 +116,47 @@ namespace {
     }
   };
 
+  // Batch of seeds from a single region processed within one TBB task.
+  // Batches of all regions are scheduled through a single parallel_for so that
+  // idle threads can steal work from any region instead of the regions being
+  // drained one after the other.
+  struct SeedBatch {
+    int m_region;
+    int m_beg, m_end;
+  };
+
+  // Number of seeds per TBB task: either fixed by the iteration configuration or
+  // adapted to the number of threads that can work on this event.
+  int seeds_per_task(const MkJob &job, int n_seeds) {
+    if (job.m_iter_config.m_seeds_per_task > 0)
+      return job.m_iter_config.m_seeds_per_task;
+#if defined(MKFIT_STANDALONE)
+    const int n_thr = std::max(1, Config::numThreadsFinder / Config::numThreadsEvents);
+#else
+    const int n_thr = tbb::this_task_arena::max_concurrency();
+#endif
+    return std::clamp(n_seeds / n_thr + 1, 4, Config::numSeedsPerTask);
+  }
+
+  std::vector<SeedBatch> make_seed_batches(MkJob &job,
+                                           const std::vector<int> &seedEtaSeparators,
+                                           SteeringParams::IterationType_e iteration_dir,
+                                           int seeds_per_task) {
+    std::vector<SeedBatch> batches;
+    for (auto it = job.regions_begin(); it != job.regions_end(); ++it) {
+      const int region = *it;
+      if (iteration_dir == SteeringParams::IT_BkwSearch && !job.steering_params(region).has_bksearch_plan()) {
+        printf("No backward search plan for region %d\n", region);
+        continue;
+      }
+      const RegionOfSeedIndices rosi(seedEtaSeparators, region);
+      for (int beg = rosi.m_reg_beg; beg < rosi.m_reg_end; beg += seeds_per_task) {
+        batches.push_back({region, beg, std::min(beg + seeds_per_task, rosi.m_reg_end)});
+      }
+    }
+    return batches;
+  }
+
 #ifdef DEBUG
   void pre_prop_print(int ilay, MkBase *fir) {
     const float pt = 1.f / fir->getPar(0, 0, 3);
@@ -760,183 +802,180 @@ namespace mkfit {
 
     EventOfCombCandidates &eoccs = m_event_of_comb_cands;
 
-    tbb::parallel_for_each(m_job->regions_begin(), m_job->regions_end(), [&](int region) {
-      if (iteration_dir == SteeringParams::IT_BkwSearch && !m_job->steering_params(region).has_bksearch_plan()) {
-        printf("No backward search plan for region %d\n", region);
-        return;
-      }
-
-      const TrackerInfo &trk_info = m_job->m_trk_info;
-      const SteeringParams &st_par = m_job->steering_params(region);
-      const IterationParams &params = m_job->params();
-      const PropagationConfig &prop_config = trk_info.prop_config();
+    const TrackerInfo &trk_info = m_job->m_trk_info;
+    const IterationParams &params = m_job->params();
+    const PropagationConfig &prop_config = trk_info.prop_config();
 
-      const RegionOfSeedIndices rosi(m_seedEtaSeparators, region);
+    // seed batches of all regions, sized on the total estimated amount of work to divide among all threads
+    const int spt = seeds_per_task(*m_job, eoccs.size());
+    const std::vector<SeedBatch> batches = make_seed_batches(*m_job, m_seedEtaSeparators, iteration_dir, spt);
+    dprint("seeds per task " << spt << " n_batches " << batches.size() << " n_seeds " << eoccs.size());
 
-      // adaptive seeds per task based on the total estimated amount of work to divide among all threads
-      const int adaptiveSPT = std::clamp(
-          Config::numThreadsEvents * eoccs.size() / Config::numThreadsFinder + 1, 4, Config::numSeedsPerTask);
-      dprint("adaptiveSPT " << adaptiveSPT << " fill " << rosi.count() << "/" << eoccs.size() << " region " << region);
+    // loop over seed batches
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, batches.size(), 1),
+        [&](const tbb::blocked_range<int> &batch_rng) {
+          const SeedBatch &batch = batches[batch_rng.begin()];
+          const int region = batch.m_region;
+          const SteeringParams &st_par = m_job->steering_params(region);
 
-      // loop over seeds
-      tbb::parallel_for(rosi.tbb_blk_rng_std(adaptiveSPT), [&](const tbb::blocked_range<int> &seeds) {
-        auto mkfndr = g_exe_ctx.m_finders.makeOrGet();
+          auto mkfndr = g_exe_ctx.m_finders.makeOrGet();
 
-        const int start_seed = seeds.begin();
-        const int end_seed = seeds.end();
-        const int n_seeds = end_seed - start_seed;
+          const int start_seed = batch.m_beg;
+          const int end_seed = batch.m_end;
+          const int n_seeds = end_seed - start_seed;
 
-        std::vector<std::vector<TrackCand>> tmp_cands(n_seeds);
-        for (size_t iseed = 0; iseed < tmp_cands.size(); ++iseed) {
-          tmp_cands[iseed].reserve(2 * params.maxCandsPerSeed);  //factor 2 seems reasonable to start with
-        }
+          std::vector<std::vector<TrackCand>> tmp_cands(n_seeds);
+          for (size_t iseed = 0; iseed < tmp_cands.size(); ++iseed) {
+            tmp_cands[iseed].reserve(2 * params.maxCandsPerSeed);  //factor 2 seems reasonable to start with
+          }
 
-        std::vector<std::pair<int, int>> seed_cand_idx;
-        seed_cand_idx.reserve(n_seeds * params.maxCandsPerSeed);
+          std::vector<std::pair<int, int>> seed_cand_idx;
+          seed_cand_idx.reserve(n_seeds * params.maxCandsPerSeed);
 
-        auto layer_plan_it = st_par.make_iterator(iteration_dir);
+          auto layer_plan_it = st_par.make_iterator(iteration_dir);
 
-        dprintf("Made iterator for %d, first layer=%d ... end layer=%d\n",
-                iteration_dir,
-                layer_plan_it.layer(),
-                layer_plan_it.last_layer());
+          dprintf("Made iterator for %d, first layer=%d ... end layer=%d\n",
+                  iteration_dir,
+                  layer_plan_it.layer(),
+                  layer_plan_it.last_layer());
 
-        assert(layer_plan_it.is_pickup_only());
+          assert(layer_plan_it.is_pickup_only());
 
-        int curr_layer = layer_plan_it.layer(), prev_layer;
+          int curr_layer = layer_plan_it.layer(), prev_layer;
 
-        dprintf("\nMkBuilder::FindTracksStandard region=%d, seed_pickup_layer=%d, first_layer=%d\n",
-                region,
-                curr_layer,
-                layer_plan_it.next_layer());
+          dprintf("\nMkBuilder::FindTracksStandard region=%d, seed_pickup_layer=%d, first_layer=%d\n",
+                  region,
+                  curr_layer,
+                  layer_plan_it.next_layer());
 
-        auto &iter_params = (iteration_dir == SteeringParams::IT_BkwSearch) ? m_job->m_iter_config.m_backward_params
-                                                                            : m_job->m_iter_config.m_params;
+          auto &iter_params = (iteration_dir == SteeringParams::IT_BkwSearch) ? m_job->m_iter_config.m_backward_params
+                                                                              : m_job->m_iter_config.m_params;
 
-        // Loop over layers, starting from after the seed.
-        while (++layer_plan_it) {
-          prev_layer = curr_layer;
-          curr_layer = layer_plan_it.layer();
-          mkfndr->setup(prop_config,
-                        m_job->m_iter_config,
-                        iter_params,
-                        m_job->m_iter_config.m_layer_configs[curr_layer],
-                        st_par,
-                        m_job->get_mask_for_layer(curr_layer),
-                        m_event,
-                        region,
-                        m_job->m_in_fwd);
+          // Loop over layers, starting from after the seed.
+          while (++layer_plan_it) {
+            prev_layer = curr_layer;
+            curr_layer = layer_plan_it.layer();
+            mkfndr->setup(prop_config,
+                          m_job->m_iter_config,
+                          iter_params,
+                          m_job->m_iter_config.m_layer_configs[curr_layer],
+                          st_par,
+                          m_job->get_mask_for_layer(curr_layer),
+                          m_event,
+                          region,
+                          m_job->m_in_fwd);
 
-          const LayerOfHits &layer_of_hits = m_job->m_event_of_hits[curr_layer];
-          const LayerInfo &layer_info = trk_info.layer(curr_layer);
-          const FindingFoos &fnd_foos = FindingFoos::get_finding_foos(layer_info.is_barrel());
+            const LayerOfHits &layer_of_hits = m_job->m_event_of_hits[curr_layer];
+            const LayerInfo &layer_info = trk_info.layer(curr_layer);
+            const FindingFoos &fnd_foos = FindingFoos::get_finding_foos(layer_info.is_barrel());
 
-          dprintf("\n* Processing layer %d\n", curr_layer);
-          mkfndr->begin_layer(layer_of_hits);
+            dprintf("\n* Processing layer %d\n", curr_layer);
+            mkfndr->begin_layer(layer_of_hits);
 
-          int theEndCand = find_tracks_unroll_candidates(seed_cand_idx,
-                                                         start_seed,
-                                                         end_seed,
-                                                         curr_layer,
-                                                         prev_layer,
-                                                         layer_plan_it.is_pickup_only(),
-                                                         iteration_dir);
+            int theEndCand = find_tracks_unroll_candidates(seed_cand_idx,
+                                                           start_seed,
+                                                           end_seed,
+                                                           curr_layer,
+                                                           prev_layer,
+                                                           layer_plan_it.is_pickup_only(),
+                                                           iteration_dir);
 
-          dprintf("  Number of candidates to process: %d, nHits in layer: %d\n", theEndCand, layer_of_hits.nHits());
+            dprintf("  Number of candidates to process: %d, nHits in layer: %d\n", theEndCand, layer_of_hits.nHits());
 
-          if (layer_plan_it.is_pickup_only() || theEndCand == 0)
-            continue;
+            if (layer_plan_it.is_pickup_only() || theEndCand == 0)
+              continue;
 
-          // vectorized loop
-          for (int itrack = 0; itrack < theEndCand; itrack += NN) {
-            int end = std::min(itrack + NN, theEndCand);
+            // vectorized loop
+            for (int itrack = 0; itrack < theEndCand; itrack += NN) {
+              int end = std::min(itrack + NN, theEndCand);
 
-            dprint("processing track=" << itrack << ", label="
-                                       << eoccs[seed_cand_idx[itrack].first][seed_cand_idx[itrack].second].label());
+              dprint("processing track=" << itrack << ", label="
+                                         << eoccs[seed_cand_idx[itrack].first][seed_cand_idx[itrack].second].label());
 
-            //fixme find a way to deal only with the candidates needed in this thread
-            mkfndr->inputTracksAndHitIdx(eoccs.refCandidates(), seed_cand_idx, itrack, end, false);
+              //fixme find a way to deal only with the candidates needed in this thread
+              mkfndr->inputTracksAndHitIdx(eoccs.refCandidates(), seed_cand_idx, itrack, end, false);
 
-            //propagate to layer
-            dcall(pre_prop_print(curr_layer, mkfndr.get()));
+              //propagate to layer
+              dcall(pre_prop_print(curr_layer, mkfndr.get()));
 
-            mkfndr->clearFailFlag();
-            (mkfndr.get()->*fnd_foos.m_propagate_foo)(
-                layer_info.propagate_to(), end - itrack, prop_config.finding_inter_layer_pflags);
+              mkfndr->clearFailFlag();
+              (mkfndr.get()->*fnd_foos.m_propagate_foo)(
+                  layer_info.propagate_to(), end - itrack, prop_config.finding_inter_layer_pflags);
 
-            dcall(post_prop_print(curr_layer, mkfndr.get()));
+              dcall(post_prop_print(curr_layer, mkfndr.get()));
 
-            dprint("now get hit range");
+              dprint("now get hit range");
 
-            if (alwaysUseHitSelectionV2 || iter_params.useHitSelectionV2)
-              mkfndr->selectHitIndicesV2(layer_of_hits, end - itrack);
-            else
-              mkfndr->selectHitIndices(layer_of_hits, end - itrack);
+              if (alwaysUseHitSelectionV2 || iter_params.useHitSelectionV2)
+                mkfndr->selectHitIndicesV2(layer_of_hits, end - itrack);
+              else
+                mkfndr->selectHitIndices(layer_of_hits, end - itrack);
 
-            find_tracks_handle_missed_layers(
-                mkfndr.get(), layer_info, tmp_cands, seed_cand_idx, region, start_seed, itrack, end);
+              find_tracks_handle_missed_layers(
+                  mkfndr.get(), layer_info, tmp_cands, seed_cand_idx, region, start_seed, itrack, end);
 
-            dprint("make new candidates");
-            mkfndr->findCandidates(layer_of_hits, tmp_cands, start_seed, end - itrack, fnd_foos);
+              dprint("make new candidates");
+              mkfndr->findCandidates(layer_of_hits, tmp_cands, start_seed, end - itrack, fnd_foos);
 
-          }  //end of vectorized loop
+            }  //end of vectorized loop
 
-          // sort the input candidates
-          for (int is = 0; is < n_seeds; ++is) {
-            dprint("dump seed n " << is << " with N_input_candidates=" << tmp_cands[is].size());
+            // sort the input candidates
+            for (int is = 0; is < n_seeds; ++is) {
+              dprint("dump seed n " << is << " with N_input_candidates=" << tmp_cands[is].size());
 
-            std::sort(tmp_cands[is].begin(), tmp_cands[is].end(), sortCandByScore);
-          }
+              std::sort(tmp_cands[is].begin(), tmp_cands[is].end(), sortCandByScore);
+            }
 
-          // now fill out the output candidates
-          for (int is = 0; is < n_seeds; ++is) {
-            if (!tmp_cands[is].empty()) {
-              eoccs[start_seed + is].clear();
+            // now fill out the output candidates
+            for (int is = 0; is < n_seeds; ++is) {
+              if (!tmp_cands[is].empty()) {
+                eoccs[start_seed + is].clear();
 
-              // Put good candidates into eoccs, process -2 candidates.
-              int n_placed = 0;
-              bool first_short = true;
-              for (int ii = 0; ii < (int)tmp_cands[is].size() && n_placed < params.maxCandsPerSeed; ++ii) {
-                TrackCand &tc = tmp_cands[is][ii];
+                // Put good candidates into eoccs, process -2 candidates.
+                int n_placed = 0;
+                bool first_short = true;
+                for (int ii = 0; ii < (int)tmp_cands[is].size() && n_placed < params.maxCandsPerSeed; ++ii) {
+                  TrackCand &tc = tmp_cands[is][ii];
 
-                // See if we have an overlap hit available, but only if we have a true hit in this layer
-                // and pT is above the pTCutOverlap
-                if (tc.pT() > params.pTCutOverlap && tc.getLastHitLyr() == curr_layer && tc.getLastHitIdx() >= 0) {
-                  CombCandidate &ccand = eoccs[start_seed + is];
+                  // See if we have an overlap hit available, but only if we have a true hit in this layer
+                  // and pT is above the pTCutOverlap
+                  if (tc.pT() > params.pTCutOverlap && tc.getLastHitLyr() == curr_layer && tc.getLastHitIdx() >= 0) {
+                    CombCandidate &ccand = eoccs[start_seed + is];
 
-                  HitMatch *hm = ccand[tc.originIndex()].findOverlap(
-                      tc.getLastHitIdx(), layer_of_hits.refHit(tc.getLastHitIdx()).detIDinLayer());
+                    HitMatch *hm = ccand[tc.originIndex()].findOverlap(
+                        tc.getLastHitIdx(), layer_of_hits.refHit(tc.getLastHitIdx()).detIDinLayer());
 
-                  if (hm) {
-                    tc.addHitIdx(hm->m_hit_idx, curr_layer, hm->m_chi2);
-                    tc.incOverlapCount();
+                    if (hm) {
+                      tc.addHitIdx(hm->m_hit_idx, curr_layer, hm->m_chi2);
+                      tc.incOverlapCount();
+                    }
                   }
-                }
 
-                if (tc.getLastHitIdx() != -2) {
-                  eoccs[start_seed + is].emplace_back(tc);
-                  ++n_placed;
-                } else if (first_short) {
-                  first_short = false;
-                  if (tc.score() > eoccs[start_seed + is].refBestShortCand().score()) {
-                    eoccs[start_seed + is].setBestShortCand(tc);
+                  if (tc.getLastHitIdx() != -2) {
+                    eoccs[start_seed + is].emplace_back(tc);
+                    ++n_placed;
+                  } else if (first_short) {
+                    first_short = false;
+                    if (tc.score() > eoccs[start_seed + is].refBestShortCand().score()) {
+                      eoccs[start_seed + is].setBestShortCand(tc);
+                    }
                   }
                 }
-              }
 
-              tmp_cands[is].clear();
+                tmp_cands[is].clear();
+              }
             }
-          }
-          mkfndr->end_layer();
-        }  // end of layer loop
-        mkfndr->release();
+            mkfndr->end_layer();
+          }  // end of layer loop
+          mkfndr->release();
 
-        // final sorting
-        for (int iseed = start_seed; iseed < end_seed; ++iseed) {
-          eoccs[iseed].mergeCandsAndBestShortOne(m_job->params(), st_par.m_track_scorer, true, true);
-        }
-      });  // end parallel-for over chunk of seeds within region
-    });    // end of parallel-for-each over eta regions
+          // final sorting
+          for (int iseed = start_seed; iseed < end_seed; ++iseed) {
+            eoccs[iseed].mergeCandsAndBestShortOne(m_job->params(), st_par.m_track_scorer, true, true);
+          }
+        },
+        tbb::simple_partitioner());  // end parallel-for over seed batches
 
     // debug = false;
   }
@@ -950,32 +989,28 @@ namespace mkfit {
 
     EventOfCombCandidates &eoccs = m_event_of_comb_cands;
 
-    tbb::parallel_for_each(m_job->regions_begin(), m_job->regions_end(), [&](int region) {
-      if (iteration_dir == SteeringParams::IT_BkwSearch && !m_job->steering_params(region).has_bksearch_plan()) {
-        printf("No backward search plan for region %d\n", region);
-        return;
-      }
-
-      const RegionOfSeedIndices rosi(m_seedEtaSeparators, region);
+    // seed batches of all regions, sized on the total estimated amount of work to divide among all threads
+    const int spt = seeds_per_task(*m_job, eoccs.size());
+    const std::vector<SeedBatch> batches = make_seed_batches(*m_job, m_seedEtaSeparators, iteration_dir, spt);
+    dprint("seeds per task " << spt << " n_batches " << batches.size() << " n_seeds " << eoccs.size());
 
-      // adaptive seeds per task based on the total estimated amount of work to divide among all threads
-      const int adaptiveSPT = std::clamp(
-          Config::numThreadsEvents * eoccs.size() / Config::numThreadsFinder + 1, 4, Config::numSeedsPerTask);
-      dprint("adaptiveSPT " << adaptiveSPT << " fill " << rosi.count() << "/" << eoccs.size() << " region " << region);
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, batches.size(), 1),
+        [&](const tbb::blocked_range<int> &batch_rng) {
+          const SeedBatch &batch = batches[batch_rng.begin()];
 
-      tbb::parallel_for(rosi.tbb_blk_rng_std(adaptiveSPT), [&](const tbb::blocked_range<int> &seeds) {
-        auto cloner = g_exe_ctx.m_cloners.makeOrGet();
-        auto mkfndr = g_exe_ctx.m_finders.makeOrGet();
+          auto cloner = g_exe_ctx.m_cloners.makeOrGet();
+          auto mkfndr = g_exe_ctx.m_finders.makeOrGet();
 
-        cloner->setup(m_job->params());
+          cloner->setup(m_job->params());
 
-        // loop over layers
-        find_tracks_in_layers(*cloner, mkfndr.get(), iteration_dir, seeds.begin(), seeds.end(), region);
+          // loop over layers
+          find_tracks_in_layers(*cloner, mkfndr.get(), iteration_dir, batch.m_beg, batch.m_end, batch.m_region);
 
-        mkfndr->release();
-        cloner->release();
-      });
-    });
+          mkfndr->release();
+          cloner->release();
+        },
+        tbb::simple_partitioner());
 
     // debug = false;
   }
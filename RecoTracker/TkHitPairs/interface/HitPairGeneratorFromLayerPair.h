@@ -9,6 +9,7 @@
 #include <optional>
 
 class DetLayer;
+class HitRZCompatibility;
 class IdealMagneticFieldRecord;
 class MagneticField;
 class MultipleScatteringParametrisationMaker;
@@ -72,6 +73,14 @@ public:
                        const unsigned int theMaxElement,
                        HitDoublets& result);
 
+  // Appends to result the indices of the hits of innerHitsMap in innerRange compatible in (r,z)
+  //  with checkRZ. The phi bins of the inner layer are scanned one by one, and the ones whose
+  //  (r,z) extent cannot satisfy a z check are skipped without looking at their hits.
+  static void compatibleInnerHits(const RecHitsSortedInPhi& innerHitsMap,
+                                  const RecHitsSortedInPhi::DoubleRange& innerRange,
+                                  const HitRZCompatibility& checkRZ,
+                                  std::vector<int>& result);
+
   Layer innerLayer(const Layers& layers) const { return layers[theInnerLayer]; }
   Layer outerLayer(const Layers& layers) const { return layers[theOuterLayer]; }
 
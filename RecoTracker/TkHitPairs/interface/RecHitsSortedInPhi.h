@@ -2,16 +2,25 @@
 #define RecHitsSortedInPhi_H
 
 #include "DataFormats/TrackerRecHit2D/interface/BaseTrackerRecHit.h"
+#include "DataFormats/GeometryVector/interface/Pi.h"
 #include "TrackingTools/DetLayers/interface/DetLayer.h"
 
+#include <algorithm>
 #include <vector>
 #include <array>
 
 #include <cassert>
 
+// For tests
+class testRecHitsSortedInPhi;
+
 /** A RecHit container sorted in phi.
  *  Provides fast access for hits in a given phi window
- *  using binary search.
+ *  using a precomputed phi-bin index followed by a binary
+ *  search restricted to the boundary bins.
+ *  For each phi bin the extent of the hits in the (u,v) plane
+ *  is kept as well, so that whole bins can be rejected
+ *  by the doublet search before looking at single hits.
  */
 
 class RecHitsSortedInPhi {
@@ -40,6 +49,9 @@ public:
 
   using DoubleRange = std::array<int, 4>;
 
+  // number of phi bins of the hit index (covering [-pi,pi])
+  static constexpr int nPhiBins = 128;
+
   RecHitsSortedInPhi(const std::vector<Hit>& hits, GlobalPoint const& origin, DetLayer const* il);
 
   bool empty() const { return theHits.empty(); }
@@ -83,6 +95,17 @@ public:
 
   Range all() const { return Range(theHits.begin(), theHits.end()); }
 
+  // phi bin of the index containing phi (phi is clamped to [-pi,pi])
+  static int phiBin(float phi) {
+    constexpr float scale = float(nPhiBins) / Geom::ftwoPi();
+    int b = int((phi + Geom::fpi()) * scale);
+    return std::clamp(b, 0, nPhiBins - 1);
+  }
+
+  // hits in bin ib are in [binBegin(ib), binEnd(ib))
+  int binBegin(int ib) const { return theBinOffsets[ib]; }
+  int binEnd(int ib) const { return theBinOffsets[ib + 1]; }
+
 public:
   float phi(int i) const { return theHits[i].phi(); }
   float gv(int i) const { return isBarrel ? z[i] : gp(i).perp(); }  // global v
@@ -109,11 +132,27 @@ public:
   std::vector<float> dv;
   std::vector<float> lphi;
 
+  // phi-bin index: offsets of the first hit in each bin, and per-bin (u,v) extent
+  std::array<int, nPhiBins + 1> theBinOffsets;
+  std::array<float, nPhiBins> binUMin;
+  std::array<float, nPhiBins> binUMax;
+  std::array<float, nPhiBins> binVMin;
+  std::array<float, nPhiBins> binVMax;
+  std::array<float, nPhiBins> binDVMax;
+
   static void copyResult(const Range& range, std::vector<Hit>& result) {
     result.reserve(result.size() + (range.second - range.first));
     for (HitIter i = range.first; i != range.second; i++)
       result.push_back(i->hit());
   }
+
+private:
+  // For tests
+  friend class testRecHitsSortedInPhi;
+  RecHitsSortedInPhi() : layer(nullptr), isBarrel(true) {}
+
+  // fill the phi-bin index from the hits sorted in phi and their (u,v) coordinates
+  void buildPhiIndex();
 };
 
 /*
@@ -6,6 +6,7 @@
 #include "TrackingTools/DetLayers/interface/ForwardDetLayer.h"
 
 #include "RecoTracker/TkTrackingRegions/interface/HitRZCompatibility.h"
+#include "RecoTracker/TkTrackingRegions/interface/HitZCheck.h"
 #include "RecoTracker/TkTrackingRegions/interface/TrackingRegion.h"
 #include "RecoTracker/TkTrackingRegions/interface/TrackingRegionBase.h"
 #include "RecoTracker/TkHitPairs/interface/OrderedHitPairs.h"
@@ -73,6 +74,59 @@ namespace {
 
 }  // namespace
 
+void HitPairGeneratorFromLayerPair::compatibleInnerHits(const RecHitsSortedInPhi& innerHitsMap,
+                                                        const RecHitsSortedInPhi::DoubleRange& innerRange,
+                                                        const HitRZCompatibility& checkRZ,
+                                                        std::vector<int>& result) {
+  // for the z check the allowed range is linear in r: a whole phi bin of the inner layer
+  // can be rejected looking at its extent in (r,z) only
+  auto binCompatible = [&](int ib) {
+    if (checkRZ.algo() != HitRZCompatibility::zAlgo)
+      return true;
+    constexpr float nSigmaRZ = 3.46410161514f;  // std::sqrt(12.f);
+    auto const& zCheck = static_cast<HitZCheck const&>(checkRZ);
+    Range a1 = zCheck.range(innerHitsMap.binUMin[ib]);
+    Range a2 = zCheck.range(innerHitsMap.binUMax[ib]);
+    Range allowed(std::min(a1.min(), a2.min()), std::max(a1.max(), a2.max()));
+    float vErr = nSigmaRZ * innerHitsMap.binDVMax[ib];
+    Range binRZ(innerHitsMap.binVMin[ib] - vErr, innerHitsMap.binVMax[ib] + vErr);
+    return !allowed.intersection(binRZ).empty();
+  };
+
+  Kernels<HitZCheck, HitRCheck, HitEtaCheck> kernels;
+  for (int j = 0; j < 3; j += 2) {
+    if (innerRange[j + 1] == innerRange[j])
+      continue;
+    int ibFirst = RecHitsSortedInPhi::phiBin(innerHitsMap.phi(innerRange[j]));
+    int ibLast = RecHitsSortedInPhi::phiBin(innerHitsMap.phi(innerRange[j + 1] - 1));
+    for (int ib = ibFirst; ib <= ibLast; ++ib) {
+      auto b = std::max(innerRange[j], innerHitsMap.binBegin(ib));
+      auto e = std::min(innerRange[j + 1], innerHitsMap.binEnd(ib));
+      if (e <= b || !binCompatible(ib))
+        continue;
+      bool ok[e - b];
+      switch (checkRZ.algo()) {
+        case (HitRZCompatibility::zAlgo):
+          std::get<0>(kernels).set(&checkRZ);
+          std::get<0>(kernels)(b, e, innerHitsMap, ok);
+          break;
+        case (HitRZCompatibility::rAlgo):
+          std::get<1>(kernels).set(&checkRZ);
+          std::get<1>(kernels)(b, e, innerHitsMap, ok);
+          break;
+        case (HitRZCompatibility::etaAlgo):
+          std::get<2>(kernels).set(&checkRZ);
+          std::get<2>(kernels)(b, e, innerHitsMap, ok);
+          break;
+      }
+      for (int i = 0; i != e - b; ++i) {
+        if (ok[i])
+          result.push_back(b + i);
+      }
+    }
+  }
+}
+
 bool HitPairGeneratorFromLayerPair::hitPairs(const TrackingRegion& region,
                                              OrderedHitPairs& result,
                                              const edm::Event& iEvent,
@@ -143,6 +197,7 @@ bool HitPairGeneratorFromLayerPair::doublets(const TrackingRegion& region,
 
   // constexpr float nSigmaRZ = std::sqrt(12.f);
   constexpr float nSigmaPhi = 3.f;
+  std::vector<int> innerHits;
   for (int io = 0; io != int(outerHitsMap.theHits.size()); ++io) {
     if (!deltaPhi.prefilter(outerHitsMap.x[io], outerHitsMap.y[io]))
       continue;
@@ -164,42 +219,19 @@ bool HitPairGeneratorFromLayerPair::doublets(const TrackingRegion& region,
     if (!checkRZ)
       continue;
 
-    Kernels<HitZCheck, HitRCheck, HitEtaCheck> kernels;
-
     auto innerRange = innerHitsMap.doubleRange(phiRange.min(), phiRange.max());
     LogDebug("HitPairGeneratorFromLayerPair")
         << "preparing for combination of: " << innerRange[1] - innerRange[0] + innerRange[3] - innerRange[2]
         << " inner and: " << outerHitsMap.theHits.size() << " outter";
-    for (int j = 0; j < 3; j += 2) {
-      auto b = innerRange[j];
-      auto e = innerRange[j + 1];
-      if (e == b)
-        continue;
-      bool ok[e - b];
-      switch (checkRZ->algo()) {
-        case (HitRZCompatibility::zAlgo):
-          std::get<0>(kernels).set(checkRZ.get());
-          std::get<0>(kernels)(b, e, innerHitsMap, ok);
-          break;
-        case (HitRZCompatibility::rAlgo):
-          std::get<1>(kernels).set(checkRZ.get());
-          std::get<1>(kernels)(b, e, innerHitsMap, ok);
-          break;
-        case (HitRZCompatibility::etaAlgo):
-          std::get<2>(kernels).set(checkRZ.get());
-          std::get<2>(kernels)(b, e, innerHitsMap, ok);
-          break;
-      }
-      for (int i = 0; i != e - b; ++i) {
-        if (!ok[i])
-          continue;
-        if (theMaxElement != 0 && result.size() >= theMaxElement) {
-          result.clear();
-          edm::LogError("TooManyPairs") << "number of pairs exceed maximum, no pairs produced";
-          return false;
-        }
-        result.add(b + i, io);
+    innerHits.clear();
+    compatibleInnerHits(innerHitsMap, innerRange, *checkRZ, innerHits);
+    for (int i : innerHits) {
+      if (theMaxElement != 0 && result.size() >= theMaxElement) {
+        result.clear();
+        edm::LogError("TooManyPairs") << "number of pairs exceed maximum, no pairs produced";
+        return false;
       }
+      result.add(i, io);
     }
   }
   LogDebug("HitPairGeneratorFromLayerPair") << " total number of pairs provided back: " << result.size();
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 
 RecHitsSortedInPhi::RecHitsSortedInPhi(const std::vector<Hit>& hits, GlobalPoint const& origin, DetLayer const* il)
     : layer(il),
@@ -47,6 +48,31 @@ RecHitsSortedInPhi::RecHitsSortedInPhi(const std::vector<Hit>& hits, GlobalPoint
     dv[i] = isBarrel ? dz : dr;
     lphi[i] = loc.barePhi();
   }
+
+  buildPhiIndex();
+}
+
+void RecHitsSortedInPhi::buildPhiIndex() {
+  // hits are sorted in phi and phiBin is monotonic, so each bin is contiguous
+  binUMin.fill(std::numeric_limits<float>::max());
+  binUMax.fill(std::numeric_limits<float>::lowest());
+  binVMin.fill(std::numeric_limits<float>::max());
+  binVMax.fill(std::numeric_limits<float>::lowest());
+  binDVMax.fill(0.f);
+  int nh = theHits.size();
+  int ih = 0;
+  for (int ib = 0; ib != nPhiBins; ++ib) {
+    theBinOffsets[ib] = ih;
+    for (; ih != nh && phiBin(theHits[ih].phi()) == ib; ++ih) {
+      binUMin[ib] = std::min(binUMin[ib], u[ih]);
+      binUMax[ib] = std::max(binUMax[ib], u[ih]);
+      binVMin[ib] = std::min(binVMin[ib], v[ih]);
+      binVMax[ib] = std::max(binVMax[ib], v[ih]);
+      binDVMax[ib] = std::max(binDVMax[ib], dv[ih]);
+    }
+  }
+  theBinOffsets[nPhiBins] = nh;
+  assert(ih == nh);
 }
 
 RecHitsSortedInPhi::DoubleRange RecHitsSortedInPhi::doubleRange(float phiMin, float phiMax) const {
@@ -97,6 +123,12 @@ std::vector<RecHitsSortedInPhi::Hit> RecHitsSortedInPhi::hits(float phiMin, floa
 }
 
 RecHitsSortedInPhi::Range RecHitsSortedInPhi::unsafeRange(float phiMin, float phiMax) const {
-  auto low = std::lower_bound(theHits.begin(), theHits.end(), HitWithPhi(phiMin), HitLessPhi());
-  return Range(low, std::upper_bound(low, theHits.end(), HitWithPhi(phiMax), HitLessPhi()));
+  // hits in bins before phiBin(phiMin) have phi < phiMin, the ones in bins after it have phi > phiMin:
+  // the binary search can be restricted to a single bin (and the same for phiMax)
+  auto const b = theHits.begin();
+  int ibl = phiBin(phiMin);
+  auto low = std::lower_bound(b + binBegin(ibl), b + binEnd(ibl), HitWithPhi(phiMin), HitLessPhi());
+  int ibh = phiBin(phiMax);
+  auto high = std::upper_bound(b + binBegin(ibh), b + binEnd(ibh), HitWithPhi(phiMax), HitLessPhi());
+  return Range(low, std::max(low, high));
 }
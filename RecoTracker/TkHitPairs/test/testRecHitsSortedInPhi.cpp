@@ -0,0 +1,293 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "RecoTracker/TkHitPairs/interface/RecHitsSortedInPhi.h"
+#include "RecoTracker/TkHitPairs/interface/HitPairGeneratorFromLayerPair.h"
+#include "RecoTracker/TkTrackingRegions/interface/HitRCheck.h"
+#include "RecoTracker/TkTrackingRegions/interface/HitZCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+class testRecHitsSortedInPhi : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testRecHitsSortedInPhi);
+  CPPUNIT_TEST(checkIndex);
+  CPPUNIT_TEST(checkUnsafeRange);
+  CPPUNIT_TEST(checkDoubleRange);
+  CPPUNIT_TEST(checkZDoublets);
+  CPPUNIT_TEST(checkRDoublets);
+  CPPUNIT_TEST(checkEmptyLayer);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+
+  void checkIndex();
+  void checkUnsafeRange();
+  void checkDoubleRange();
+  void checkZDoublets();
+  void checkRDoublets();
+  void checkEmptyLayer();
+
+private:
+  struct TestHit {
+    float phi, u, v, dv;
+  };
+  // a layer made of the given hits, with the phi-bin index built as in the constructor
+  static RecHitsSortedInPhi makeLayer(std::vector<TestHit> hits, bool isBarrel);
+
+  // the search without the phi-bin index: binary search over all the hits
+  static RecHitsSortedInPhi::Range unbinnedRange(RecHitsSortedInPhi const& layer, float phiMin, float phiMax);
+  static RecHitsSortedInPhi::DoubleRange unbinnedDoubleRange(RecHitsSortedInPhi const& layer,
+                                                             float phiMin,
+                                                             float phiMax);
+  // the inner hits accepted hit by hit, without the bin-level rejection
+  static std::vector<int> unbinnedInnerHits(RecHitsSortedInPhi const& layer,
+                                            RecHitsSortedInPhi::DoubleRange const& range,
+                                            HitRZCompatibility const& checkRZ);
+
+  // phi windows covering the whole circle, the wrap-around at +-pi and the empty bins
+  std::vector<std::pair<float, float>> windows() const;
+
+  void checkDoublets(RecHitsSortedInPhi const& layer, std::vector<HitRZCompatibility const*> const& checks) const;
+
+  std::vector<TestHit> hits_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testRecHitsSortedInPhi);
+
+namespace {
+  constexpr float kEmptyMin = 0.5f;
+  constexpr float kEmptyMax = 1.2f;
+}  // namespace
+
+void testRecHitsSortedInPhi::setUp() {
+  // hits of a barrel layer at r~4.4, with no hits for kEmptyMin<phi<kEmptyMax (several empty bins),
+  // some of them exactly at +-pi and at the bin edges; z follows phi, so that each bin covers a small
+  // range in z and can be rejected as a whole by a z check
+  std::mt19937 rng(2026);
+  std::uniform_real_distribution<float> phi(-Geom::fpi(), Geom::fpi());
+  std::uniform_real_distribution<float> r(4.1f, 4.7f);
+  std::uniform_real_distribution<float> dz(0.001f, 0.01f);
+  std::uniform_real_distribution<float> spread(-0.5f, 0.5f);
+  auto add = [&](float p) { hits_.push_back({p, r(rng), 24.f * std::sin(2.f * p) + spread(rng), dz(rng)}); };
+  hits_.clear();
+  while (hits_.size() < 2000) {
+    float p = phi(rng);
+    if (p > kEmptyMin && p < kEmptyMax)
+      continue;
+    add(p);
+  }
+  for (float p : {-Geom::fpi(), Geom::fpi(), -Geom::fpi(), 0.f, kEmptyMin, kEmptyMax})
+    add(p);
+  for (int ib = 0; ib <= RecHitsSortedInPhi::nPhiBins; ib += 16) {
+    float edge = -Geom::fpi() + ib * Geom::ftwoPi() / RecHitsSortedInPhi::nPhiBins;
+    if (edge > kEmptyMin && edge < kEmptyMax)
+      continue;
+    add(edge);
+    add(edge);
+  }
+}
+
+RecHitsSortedInPhi testRecHitsSortedInPhi::makeLayer(std::vector<TestHit> hits, bool isBarrel) {
+  std::stable_sort(hits.begin(), hits.end(), [](TestHit const& a, TestHit const& b) { return a.phi < b.phi; });
+  RecHitsSortedInPhi layer;
+  layer.isBarrel = isBarrel;
+  for (auto const& h : hits) {
+    layer.theHits.emplace_back(h.phi);
+    layer.u.push_back(h.u);
+    layer.v.push_back(h.v);
+    layer.dv.push_back(h.dv);
+  }
+  layer.buildPhiIndex();
+  return layer;
+}
+
+RecHitsSortedInPhi::Range testRecHitsSortedInPhi::unbinnedRange(RecHitsSortedInPhi const& layer,
+                                                                float phiMin,
+                                                                float phiMax) {
+  using HitWithPhi = RecHitsSortedInPhi::HitWithPhi;
+  auto low = std::lower_bound(layer.theHits.begin(), layer.theHits.end(), HitWithPhi(phiMin), [](auto a, auto b) {
+    return a.phi() < b.phi();
+  });
+  auto high = std::upper_bound(low, layer.theHits.end(), HitWithPhi(phiMax), [](auto a, auto b) {
+    return a.phi() < b.phi();
+  });
+  return RecHitsSortedInPhi::Range(low, high);
+}
+
+RecHitsSortedInPhi::DoubleRange testRecHitsSortedInPhi::unbinnedDoubleRange(RecHitsSortedInPhi const& layer,
+                                                                            float phiMin,
+                                                                            float phiMax) {
+  RecHitsSortedInPhi::Range r1, r2;
+  if (phiMin < phiMax) {
+    if (phiMin < -Geom::fpi()) {
+      r1 = unbinnedRange(layer, phiMin + Geom::ftwoPi(), Geom::fpi());
+      r2 = unbinnedRange(layer, -Geom::fpi(), phiMax);
+    } else if (phiMax > Geom::pi()) {
+      r1 = unbinnedRange(layer, phiMin, Geom::fpi());
+      r2 = unbinnedRange(layer, -Geom::fpi(), phiMax - Geom::ftwoPi());
+    } else {
+      r1 = unbinnedRange(layer, phiMin, phiMax);
+      r2 = RecHitsSortedInPhi::Range(layer.theHits.begin(), layer.theHits.begin());
+    }
+  } else {
+    r1 = unbinnedRange(layer, phiMin, Geom::fpi());
+    r2 = unbinnedRange(layer, -Geom::fpi(), phiMax);
+  }
+  auto b = layer.theHits.begin();
+  return {{int(r1.first - b), int(r1.second - b), int(r2.first - b), int(r2.second - b)}};
+}
+
+std::vector<int> testRecHitsSortedInPhi::unbinnedInnerHits(RecHitsSortedInPhi const& layer,
+                                                           RecHitsSortedInPhi::DoubleRange const& range,
+                                                           HitRZCompatibility const& checkRZ) {
+  // the same per-hit test as the kernels of the doublet search
+  constexpr float nSigmaRZ = 3.46410161514f;  // std::sqrt(12.f);
+  std::vector<int> result;
+  for (int j = 0; j < 3; j += 2) {
+    for (int i = range[j]; i < range[j + 1]; ++i) {
+      auto allowed = checkRZ.range(layer.u[i]);
+      float vErr = nSigmaRZ * layer.dv[i];
+      HitRZCompatibility::Range hitRZ(layer.v[i] - vErr, layer.v[i] + vErr);
+      if (!allowed.intersection(hitRZ).empty())
+        result.push_back(i);
+    }
+  }
+  return result;
+}
+
+std::vector<std::pair<float, float>> testRecHitsSortedInPhi::windows() const {
+  std::vector<std::pair<float, float>> result;
+  for (float w : {0.f, 1e-4f, 0.003f, 0.02f, 0.1f, 0.4f, 1.5f}) {
+    for (int i = 0; i <= 500; ++i) {
+      float c = -Geom::fpi() + i * Geom::ftwoPi() / 500;
+      float phiMin = c - w;
+      float phiMax = c + w;
+      result.emplace_back(phiMin, phiMax);
+      // the same window given across +-pi as (3,-3)
+      if (phiMin < -Geom::fpi())
+        result.emplace_back(phiMin + Geom::ftwoPi(), phiMax);
+      else if (phiMax > Geom::fpi())
+        result.emplace_back(phiMin, phiMax - Geom::ftwoPi());
+    }
+  }
+  // windows starting or ending on a hit, on a bin edge, or inside the empty bins
+  for (auto const& h : hits_) {
+    result.emplace_back(h.phi, h.phi + 0.05f);
+    result.emplace_back(h.phi - 0.05f, h.phi);
+  }
+  result.emplace_back(kEmptyMin + 0.01f, kEmptyMax - 0.01f);
+  result.emplace_back(kEmptyMin + 0.1f, kEmptyMax + 0.1f);
+  result.emplace_back(kEmptyMin - 0.1f, kEmptyMax - 0.1f);
+  result.emplace_back(Geom::fpi() - 0.01f, -Geom::fpi() + 0.01f);
+  result.emplace_back(Geom::fpi(), -Geom::fpi());
+  return result;
+}
+
+void testRecHitsSortedInPhi::checkIndex() {
+  auto layer = makeLayer(hits_, true);
+  CPPUNIT_ASSERT(layer.binBegin(0) == 0);
+  CPPUNIT_ASSERT(layer.binEnd(RecHitsSortedInPhi::nPhiBins - 1) == int(layer.size()));
+  int nEmpty = 0;
+  for (int ib = 0; ib != RecHitsSortedInPhi::nPhiBins; ++ib) {
+    CPPUNIT_ASSERT(layer.binBegin(ib) <= layer.binEnd(ib));
+    if (layer.binBegin(ib) == layer.binEnd(ib))
+      ++nEmpty;
+    for (int i = layer.binBegin(ib); i != layer.binEnd(ib); ++i) {
+      CPPUNIT_ASSERT(RecHitsSortedInPhi::phiBin(layer.phi(i)) == ib);
+      CPPUNIT_ASSERT(layer.u[i] >= layer.binUMin[ib] && layer.u[i] <= layer.binUMax[ib]);
+      CPPUNIT_ASSERT(layer.v[i] >= layer.binVMin[ib] && layer.v[i] <= layer.binVMax[ib]);
+      CPPUNIT_ASSERT(layer.dv[i] <= layer.binDVMax[ib]);
+    }
+  }
+  CPPUNIT_ASSERT(nEmpty >= 10);
+  CPPUNIT_ASSERT(RecHitsSortedInPhi::phiBin(-Geom::fpi()) == 0);
+  CPPUNIT_ASSERT(RecHitsSortedInPhi::phiBin(Geom::fpi()) == RecHitsSortedInPhi::nPhiBins - 1);
+}
+
+void testRecHitsSortedInPhi::checkUnsafeRange() {
+  auto layer = makeLayer(hits_, true);
+  for (auto const& [phiMin, phiMax] : windows()) {
+    if (phiMin < -Geom::fpi() || phiMax > Geom::fpi())
+      continue;
+    auto range = layer.unsafeRange(phiMin, phiMax);
+    auto expected = unbinnedRange(layer, phiMin, phiMax);
+    if (phiMin > phiMax) {
+      // not a valid argument, but the range must still be empty
+      CPPUNIT_ASSERT(range.first == range.second);
+      continue;
+    }
+    CPPUNIT_ASSERT(range.first == expected.first);
+    CPPUNIT_ASSERT(range.second == expected.second);
+  }
+}
+
+void testRecHitsSortedInPhi::checkDoubleRange() {
+  auto layer = makeLayer(hits_, true);
+  int nWrapped = 0;
+  for (auto const& [phiMin, phiMax] : windows()) {
+    auto range = layer.doubleRange(phiMin, phiMax);
+    CPPUNIT_ASSERT(range == unbinnedDoubleRange(layer, phiMin, phiMax));
+    if (range[0] != range[1] && range[2] != range[3])
+      ++nWrapped;
+  }
+  CPPUNIT_ASSERT(nWrapped > 0);
+}
+
+void testRecHitsSortedInPhi::checkDoublets(RecHitsSortedInPhi const& layer,
+                                           std::vector<HitRZCompatibility const*> const& checks) const {
+  std::vector<int> innerHits;
+  for (auto const& [phiMin, phiMax] : windows()) {
+    auto range = layer.doubleRange(phiMin, phiMax);
+    auto unbinned = unbinnedDoubleRange(layer, phiMin, phiMax);
+    for (auto const* checkRZ : checks) {
+      innerHits.clear();
+      HitPairGeneratorFromLayerPair::compatibleInnerHits(layer, range, *checkRZ, innerHits);
+      CPPUNIT_ASSERT(innerHits == unbinnedInnerHits(layer, unbinned, *checkRZ));
+    }
+  }
+}
+
+void testRecHitsSortedInPhi::checkZDoublets() {
+  auto layer = makeLayer(hits_, true);
+  using Point = HitRZConstraint::Point;
+  // from a narrow to a wide z window at the layer, with and without tolerance, also outside of the layer
+  HitZCheck narrow(HitRZConstraint(Point(0.f, -0.1f), 0.f, Point(0.f, 0.1f), 0.f));
+  HitZCheck forward(HitRZConstraint(Point(0.f, 2.f), 3.f, Point(0.f, 3.f), 3.5f), HitZCheck::Margin(0.05f, 0.05f));
+  HitZCheck backward(HitRZConstraint(Point(0.f, -15.f), -1.f, Point(0.f, -5.f), -0.5f));
+  HitZCheck wide(HitRZConstraint(Point(0.f, -15.f), -10.f, Point(0.f, 15.f), 10.f));
+  HitZCheck outside(HitRZConstraint(Point(0.f, 40.f), 0.f, Point(0.f, 50.f), 0.f));
+  checkDoublets(layer, {&narrow, &forward, &backward, &wide, &outside});
+
+  // the bin rejection must not lose hits whose error alone makes them compatible
+  auto large = hits_;
+  for (auto& h : large)
+    h.dv *= 100.f;
+  checkDoublets(makeLayer(large, true), {&narrow, &forward, &backward});
+}
+
+void testRecHitsSortedInPhi::checkRDoublets() {
+  // a forward layer (u=z, v=r): no bin is rejected for the r check
+  auto hits = hits_;
+  for (auto& h : hits) {
+    h.v = h.u;
+    h.u = 30.f + 0.01f * h.v;
+  }
+  auto layer = makeLayer(hits, false);
+  using Point = HitRZConstraint::Point;
+  HitRCheck cone(HitRZConstraint(Point(0.f, -1.f), 6.f, Point(0.f, 1.f), 7.f));
+  checkDoublets(layer, {&cone});
+}
+
+void testRecHitsSortedInPhi::checkEmptyLayer() {
+  auto layer = makeLayer({}, true);
+  using Point = HitRZConstraint::Point;
+  HitZCheck wide(HitRZConstraint(Point(0.f, -15.f), -10.f, Point(0.f, 15.f), 10.f));
+  for (auto const& [phiMin, phiMax] : windows()) {
+    auto range = layer.doubleRange(phiMin, phiMax);
+    CPPUNIT_ASSERT(range[0] == range[1] && range[2] == range[3]);
+  }
+  checkDoublets(layer, {&wide});
+}
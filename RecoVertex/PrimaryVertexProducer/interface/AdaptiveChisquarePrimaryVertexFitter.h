@@ -5,6 +5,10 @@
 
   Description: simultaneous chisquared fit of primary vertices 
 
+ The linearized track parameters are kept in a structure of arrays.
+ Without the multi-vertex option all clusters of the event are still fitted
+ in one pass, each vertex owning a contiguous slice of the track arrays.
+
 */
 #include <vector>
 
@@ -49,36 +53,57 @@ protected:
     }
   };
 
+  // linearized track information, structure of arrays parallel to the list of input tracks
   struct TrackInfo {
-    double S11, S22, S12;  // inverse of the covariance (sub-)matrix
-    Error3 C;              // H^T S H
-    double g[3];
-    double H1[3], H2[3];
-    double b1, b2;
-    double zpca, dzError;
+    std::vector<double> S11, S22, S12;                  // inverse of the covariance (sub-)matrix
+    std::vector<double> C00, C01, C02, C11, C12, C22;  // H^T S H (symmetric)
+    std::vector<double> g0, g1, g2;
+    std::vector<double> H1x, H1y;  // H1[2] = 0
+    std::vector<double> H2x, H2y;  // H2[2] = -1
+    std::vector<double> b1, b2;
+    std::vector<double> zpca, dzError;
+
+    unsigned int size() const { return zpca.size(); }
+    void clear() { resize(0); }
+    void resize(unsigned int n) {
+      for (auto v : {&S11, &S22, &S12, &C00, &C01, &C02, &C11, &C12, &C22, &g0})
+        v->resize(n);
+      for (auto v : {&g1, &g2, &H1x, &H1y, &H2x, &H2y, &b1, &b2, &zpca, &dzError})
+        v->resize(n);
+    }
+  };
+
+  // per-vertex result of an update step
+  struct VertexUpdate {
+    double rho;         // sum of track weights
+    double dx, dy, dz;  // absolute position change
   };
 
   std::vector<TransientVertex> vertices(const std::vector<reco::TransientTrack> &,
                                         const std::vector<TransientVertex> &,
                                         const reco::BeamSpot &,
                                         const bool);
-  TransientVertex refit(const TransientVertex &, const reco::BeamSpot &, const bool);
-  double track_in_vertex_chsq(const TrackInfo &, const double, const double, const double);
-  void fill_trackinfo(const std::vector<reco::TransientTrack> &, const reco::BeamSpot &);
+  std::vector<TransientVertex> refit_all(const std::vector<TransientVertex> &, const reco::BeamSpot &, const bool);
+  double track_in_vertex_chsq(const unsigned int, const double, const double, const double) const;
+  void fill_trackinfo(const std::vector<reco::TransientTrack> &, const reco::BeamSpot &, const unsigned int first = 0);
   void fill_weights(const reco::BeamSpot &, const double beta = 1.);
+  void fill_weights_exclusive(const unsigned int, const double beta = 1.);
   TransientVertex get_TransientVertex(const unsigned int,
                                       const std::vector<std::pair<unsigned int, float>> &,
                                       const std::vector<reco::TransientTrack> &,
+                                      const unsigned int,
                                       const float,
                                       const reco::BeamSpot &);
   Error3 get_inverse_beam_covariance(const reco::BeamSpot &);
+  void beam_constraint(const reco::BeamSpot &, float beam_weight, Error3 &S0, double c_beam[3]);
+  VertexUpdate update_vertex(const unsigned int, const Error3 &S0, const double c_beam[3], const bool fill_covariances);
   double update(const reco::BeamSpot &, float beam_weight, const bool fill_covariances = false);
   void make_vtx_trk_map(const double);
   bool clean();
   void remove_vertex(unsigned int);
 
   // track information
-  std::vector<TrackInfo> trackinfo_;
+  TrackInfo trackinfo_;
 
   // vertex lists:
   std::vector<double> xv_;
@@ -266,6 +266,11 @@ public:
       const std::vector<reco::TransientTrack> &tracks) const override;
 
   std::vector<TransientVertex> vertices(const std::vector<reco::TransientTrack> &tracks) const override;
+  std::vector<TransientVertex> vertices_no_blocks(const std::vector<reco::TransientTrack> &tracks) const;
+  std::vector<TransientVertex> vertices_in_blocks(const std::vector<reco::TransientTrack> &tracks) const;
+  std::vector<TransientVertex> fill_vertices(double beta, double rho0, track_t &tracks, vertex_t &vertices) const;
+
+  double anneal(track_t &tks, vertex_t &y, double &rho0) const;
 
   track_t fill(const std::vector<reco::TransientTrack> &tracks) const;
 
@@ -319,6 +324,10 @@ private:
 
   double sel_zrange_;
   const double zrange_min_ = 0.1;  // smallest z-range to be included in a tracks cluster list
+
+  bool runInBlocks_;
+  unsigned int block_size_;
+  double overlap_frac_;
 };
 
 //#ifndef DAClusterizerInZT_vect_h
@@ -18,13 +18,14 @@ AdaptiveChisquarePrimaryVertexFitter::AdaptiveChisquarePrimaryVertexFitter(const
 #endif
 }
 
-double AdaptiveChisquarePrimaryVertexFitter::track_in_vertex_chsq(const TrackInfo &ti,
+double AdaptiveChisquarePrimaryVertexFitter::track_in_vertex_chsq(const unsigned int i,
                                                                   const double xvtx,
                                                                   const double yvtx,
-                                                                  const double zvtx) {
-  double F1 = ti.b1 + xvtx * ti.H1[0] + yvtx * ti.H1[1];         // using H1[2]=0
-  double F2 = ti.b2 + xvtx * ti.H2[0] + yvtx * ti.H2[1] - zvtx;  // using H2[2]=-1
-  double chsq = F1 * F1 * ti.S11 + F2 * F2 * ti.S22 + 2. * F1 * F2 * ti.S12;
+                                                                  const double zvtx) const {
+  const auto &ti = trackinfo_;
+  double F1 = ti.b1[i] + xvtx * ti.H1x[i] + yvtx * ti.H1y[i];         // using H1[2]=0
+  double F2 = ti.b2[i] + xvtx * ti.H2x[i] + yvtx * ti.H2y[i] - zvtx;  // using H2[2]=-1
+  double chsq = F1 * F1 * ti.S11[i] + F2 * F2 * ti.S22[i] + 2. * F1 * F2 * ti.S12[i];
 #ifdef PVTX_DEBUG
   assert((chsq >= 0) && " negative chi**2");
 #endif
@@ -32,14 +33,16 @@ double AdaptiveChisquarePrimaryVertexFitter::track_in_vertex_chsq(const TrackInf
 }
 
 void AdaptiveChisquarePrimaryVertexFitter::fill_trackinfo(const std::vector<reco::TransientTrack> &tracks,
-                                                          const reco::BeamSpot &beamSpot) {
-  /* fill track information used during fits into arrays, parallell to the list of input tracks */
+                                                          const reco::BeamSpot &beamSpot,
+                                                          const unsigned int first) {
+  /* fill track information used during fits into arrays, parallell to the list of input tracks,
+     starting at index first (the arrays are truncated/extended as needed) */
 
-  trackinfo_.clear();
-  trackinfo_.reserve(tracks.size());
+  auto &ti = trackinfo_;
+  ti.resize(first + tracks.size());
 
+  unsigned int i = first;
   for (auto &trk : tracks) {
-    TrackInfo ti;
     // F1,F2 are the perigee parameters (3,4)
     const auto tspca = trk.stateAtBeamLine().trackStateAtPCA();  // freeTrajectoryState
     const auto tspca_pe = PerigeeConversions::ftsToPerigeeError(tspca);
@@ -54,39 +57,57 @@ void AdaptiveChisquarePrimaryVertexFitter::fill_trackinfo(const std::vector<reco
     double cov12 = tspca_pe.covarianceMatrix()(3, 4);
 
     // S = cov^{-1}
+    double S11, S22, S12;
     double DetV = cov11 * cov22 - cov12 * cov12;
     if (fabs(DetV) < 1.e-16) {
       edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter")
           << "Warning, det(V) almost vanishes : " << DetV << " !! This should not happen!" << std::endl;
-      ti.S11 = 0;
-      ti.S22 = 0;
-      ti.S12 = 0;
+      S11 = 0;
+      S22 = 0;
+      S12 = 0;
     } else {
-      ti.S11 = cov22 / DetV;
-      ti.S22 = cov11 / DetV;
-      ti.S12 = -cov12 / DetV;
+      S11 = cov22 / DetV;
+      S22 = cov11 / DetV;
+      S12 = -cov12 / DetV;
     }
-    ti.b1 = tspca.position().x() * sin_phi - tspca.position().y() * cos_phi;
-    ti.H1[0] = -sin_phi;
-    ti.H1[1] = cos_phi;
-    ti.H1[2] = 0;
-    ti.b2 = tspca.position().z() - (tspca.position().x() * cos_phi + tspca.position().y() * sin_phi) * tan_lambda;
-    ti.H2[0] = cos_phi * tan_lambda;
-    ti.H2[1] = sin_phi * tan_lambda;
-    ti.H2[2] = -1.;
-
+    const double b1 = tspca.position().x() * sin_phi - tspca.position().y() * cos_phi;
+    const double H1[3] = {-sin_phi, cos_phi, 0};
+    const double b2 =
+        tspca.position().z() - (tspca.position().x() * cos_phi + tspca.position().y() * sin_phi) * tan_lambda;
+    const double H2[3] = {cos_phi * tan_lambda, sin_phi * tan_lambda, -1.};
+
+    double g[3];
+    double C[3][3];
     for (int k = 0; k < 3; k++) {
-      double SH1k = (ti.S11 * ti.H1[k] + ti.S12 * ti.H2[k]);
-      double SH2k = (ti.S12 * ti.H1[k] + ti.S22 * ti.H2[k]);
-      ti.g[k] = ti.b1 * SH1k + ti.b2 * SH2k;
+      double SH1k = (S11 * H1[k] + S12 * H2[k]);
+      double SH2k = (S12 * H1[k] + S22 * H2[k]);
+      g[k] = b1 * SH1k + b2 * SH2k;
       for (int l = 0; l < 3; l++) {
-        ti.C(l, k) = ti.H1[l] * SH1k + ti.H2[l] * SH2k;
+        C[l][k] = H1[l] * SH1k + H2[l] * SH2k;
       }
     }
 
-    ti.zpca = tspca.position().z();
-    ti.dzError = trk.track().dzError();
-    trackinfo_.push_back(ti);
+    ti.S11[i] = S11;
+    ti.S22[i] = S22;
+    ti.S12[i] = S12;
+    ti.C00[i] = C[0][0];
+    ti.C01[i] = C[0][1];
+    ti.C02[i] = C[0][2];
+    ti.C11[i] = C[1][1];
+    ti.C12[i] = C[1][2];
+    ti.C22[i] = C[2][2];
+    ti.g0[i] = g[0];
+    ti.g1[i] = g[1];
+    ti.g2[i] = g[2];
+    ti.H1x[i] = H1[0];
+    ti.H1y[i] = H1[1];
+    ti.H2x[i] = H2[0];
+    ti.H2y[i] = H2[1];
+    ti.b1[i] = b1;
+    ti.b2[i] = b2;
+    ti.zpca[i] = tspca.position().z();
+    ti.dzError[i] = trk.track().dzError();
+    i++;
   }
 }
 
@@ -124,10 +145,10 @@ void AdaptiveChisquarePrimaryVertexFitter::make_vtx_trk_map(double zrange_scale)
   for (unsigned int k = 0; k < nv; k++) {
     tkfirstv_.emplace_back(tkmap_.size());
     for (unsigned int i = 0; i < nt; i++) {
-      auto &ti = trackinfo_[i];
-      const double zrange = zrange_scale * ti.dzError;
-      if (std::abs(zv_[k] - ti.zpca) < z_cutoff_) {
-        const double dztrk = ti.b2 + xv_[k] * ti.H2[0] + yv_[k] * ti.H2[1] - zv_[k];
+      const auto &ti = trackinfo_;
+      const double zrange = zrange_scale * ti.dzError[i];
+      if (std::abs(zv_[k] - ti.zpca[i]) < z_cutoff_) {
+        const double dztrk = ti.b2[i] + xv_[k] * ti.H2x[i] + yv_[k] * ti.H2y[i] - zv_[k];
         if (std::abs(dztrk) < zrange) {
           tkmap_.emplace_back(i);
           tkweight_.emplace_back(0.);
@@ -152,7 +173,7 @@ void AdaptiveChisquarePrimaryVertexFitter::fill_weights(const reco::BeamSpot &be
   for (unsigned int k = 0; k < nv; k++) {
     for (unsigned int j = tkfirstv_[k]; j < tkfirstv_[k + 1]; j++) {
       const unsigned int i = tkmap_[j];
-      double arg = beta_over_2 * track_in_vertex_chsq(trackinfo_[i], xv_[k], yv_[k], zv_[k]);
+      double arg = beta_over_2 * track_in_vertex_chsq(i, xv_[k], yv_[k], zv_[k]);
       if (arg < argmax) {
         const double e = vdt::fast_exp(-arg);
         tkweight_[j] = e;  // must later be normalized by the proper Z_track[i]
@@ -174,6 +195,27 @@ void AdaptiveChisquarePrimaryVertexFitter::fill_weights(const reco::BeamSpot &be
   }
 }
 
+void AdaptiveChisquarePrimaryVertexFitter::fill_weights_exclusive(const unsigned int k, double beta) {
+  // single-vertex version for a vertex that owns the contiguous track slice tkfirstv_[k] .. tkfirstv_[k+1]-1
+  // (identity track map): the partition function of each track has a single term, the loop is vectorizable
+  const double beta_over_2 = 0.5 * beta;
+  const double argmax = beta_over_2 * chi_cutoff_ * chi_cutoff_ * 5;
+  const double Z_cutoff = vdt::fast_exp(-beta_over_2 * chi_cutoff_ * chi_cutoff_);
+
+  const auto &ti = trackinfo_;
+  const double xv = xv_[k];
+  const double yv = yv_[k];
+  const double zv = zv_[k];
+  const unsigned int jend = tkfirstv_[k + 1];
+  for (unsigned int i = tkfirstv_[k]; i < jend; i++) {
+    const double F1 = ti.b1[i] + xv * ti.H1x[i] + yv * ti.H1y[i];
+    const double F2 = ti.b2[i] + xv * ti.H2x[i] + yv * ti.H2y[i] - zv;
+    const double arg = beta_over_2 * (F1 * F1 * ti.S11[i] + F2 * F2 * ti.S22[i] + 2. * F1 * F2 * ti.S12[i]);
+    const double e = (arg < argmax) ? vdt::fast_exp(-arg) : 0.;
+    tkweight_[i] = e / (Z_cutoff + e);
+  }
+}
+
 bool AdaptiveChisquarePrimaryVertexFitter::clean() {
   /* in multi-vertex fitting, nearby vertices can fall on top of each other, 
      even when the initial seeds don't, some kind of duplicate removal is required
@@ -243,82 +285,110 @@ void AdaptiveChisquarePrimaryVertexFitter::remove_vertex(unsigned int k) {
   tkfirstv_.erase(tkfirstv_.begin() + k);
 }
 
-double AdaptiveChisquarePrimaryVertexFitter::update(const reco::BeamSpot &beamspot,
-                                                    const float beam_weight,
-                                                    const bool fill_covariances) {
-  double rho_vtx = 0;
-  double delta_z = 0;
-  double delta_x = 0;
-  double delta_y = 0;
-  unsigned const int nt = trackinfo_.size();
-  unsigned const int nv = xv_.size();
-  if (fill_covariances) {
-    covv_.clear();
-  }
-
+void AdaptiveChisquarePrimaryVertexFitter::beam_constraint(const reco::BeamSpot &beamspot,
+                                                           const float beam_weight,
+                                                           Error3 &S0,
+                                                           double c_beam[3]) {
   // initial value for S, 0 or inverse of the beamspot covariance matrix
-  Error3 S0;
-  double c_beam[3] = {0, 0, 0};
+  S0 = Error3();
+  c_beam[0] = c_beam[1] = c_beam[2] = 0;
   if (beam_weight > 0) {
     S0 = get_inverse_beam_covariance(beamspot);
     for (unsigned int j = 0; j < 3; j++) {
       c_beam[j] = -(S0(j, 0) * beamspot.x0() + S0(j, 1) * beamspot.y0() + S0(j, 2) * beamspot.z0());
     }
   }
+}
 
-  for (unsigned int k = 0; k < nv; k++) {
-    rho_vtx = 0;
-    Error3 S(S0);
-    // sum track contributions
-    double c[3] = {c_beam[0], c_beam[1], c_beam[2]};
-    for (unsigned int j = tkfirstv_[k]; j < tkfirstv_[k + 1]; j++) {
-      const unsigned int i = tkmap_[j];
-      const auto w = tkweight_[j];
-      rho_vtx += w;
-      S += w * trackinfo_[i].C;
-      for (unsigned int l = 0; l < 3; l++) {
-        c[l] += w * trackinfo_[i].g[l];
-      }
-    }
+AdaptiveChisquarePrimaryVertexFitter::VertexUpdate AdaptiveChisquarePrimaryVertexFitter::update_vertex(
+    const unsigned int k, const Error3 &S0, const double c_beam[3], const bool fill_covariances) {
+  const auto &ti = trackinfo_;
+  double rho_vtx = 0;
+  // sum track contributions
+  double s00 = S0(0, 0), s01 = S0(0, 1), s02 = S0(0, 2), s11 = S0(1, 1), s12 = S0(1, 2), s22 = S0(2, 2);
+  double c0 = c_beam[0], c1 = c_beam[1], c2 = c_beam[2];
+  for (unsigned int j = tkfirstv_[k]; j < tkfirstv_[k + 1]; j++) {
+    const unsigned int i = tkmap_[j];
+    const auto w = tkweight_[j];
+    rho_vtx += w;
+    s00 += w * ti.C00[i];
+    s01 += w * ti.C01[i];
+    s02 += w * ti.C02[i];
+    s11 += w * ti.C11[i];
+    s12 += w * ti.C12[i];
+    s22 += w * ti.C22[i];
+    c0 += w * ti.g0[i];
+    c1 += w * ti.g1[i];
+    c2 += w * ti.g2[i];
+  }
+
+  Error3 S;
+  S(0, 0) = s00;
+  S(1, 1) = s11;
+  S(2, 2) = s22;
+  S(0, 1) = S(1, 0) = s01;
+  S(0, 2) = S(2, 0) = s02;
+  S(1, 2) = S(2, 1) = s12;
+  const double c[3] = {c0, c1, c2};
 
 #ifdef PVTX_DEBUG
-    if ((fabs(S(1, 2) - S(2, 1)) > 1e-3) || (fabs(S(0, 2) - S(2, 0)) > 1e-3) || (fabs(S(0, 1) - S(1, 0)) > 1e-3) ||
-        (S(0, 0) <= 0) || (S(0, 0) <= 0) || (S(0, 0) <= 0)) {
-      edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter") << "update()  bad S-matrix   S=" << std::endl
-                                                              << S << std::endl;
-      edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter")
-          << "n-vertex = " << nv << "  n-track = " << nt << std::endl;
-    }
+  if ((fabs(S(1, 2) - S(2, 1)) > 1e-3) || (fabs(S(0, 2) - S(2, 0)) > 1e-3) || (fabs(S(0, 1) - S(1, 0)) > 1e-3) ||
+      (S(0, 0) <= 0) || (S(0, 0) <= 0) || (S(0, 0) <= 0)) {
+    edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter") << "update()  bad S-matrix   S=" << std::endl
+                                                            << S << std::endl;
+    edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter")
+        << "vertex = " << k << "  n-track = " << tkfirstv_[k + 1] - tkfirstv_[k] << std::endl;
+  }
 #endif
 
-    const auto xold = xv_[k];
-    const auto yold = yv_[k];
-    const auto zold = zv_[k];
+  const auto xold = xv_[k];
+  const auto yold = yv_[k];
+  const auto zold = zv_[k];
 
-    if (S.Invert()) {
-      xv_[k] = -(S(0, 0) * c[0] + S(0, 1) * c[1] + S(0, 2) * c[2]);
-      yv_[k] = -(S(1, 0) * c[0] + S(1, 1) * c[1] + S(1, 2) * c[2]);
-      zv_[k] = -(S(2, 0) * c[0] + S(2, 1) * c[1] + S(2, 2) * c[2]);
-      if (fill_covariances) {
-        covv_.emplace_back(S);
-      }
-    } else {
-      edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter") << "update()   Matrix inversion failed" << S << std::endl;
-      if (fill_covariances) {
-        Error3 covv_dummy;
-        covv_dummy(0, 0) = 100.;
-        covv_dummy(1, 1) = 100.;
-        covv_dummy(2, 2) = 100.;
-        covv_.emplace_back(covv_dummy);
-      }
+  if (S.Invert()) {
+    xv_[k] = -(S(0, 0) * c[0] + S(0, 1) * c[1] + S(0, 2) * c[2]);
+    yv_[k] = -(S(1, 0) * c[0] + S(1, 1) * c[1] + S(1, 2) * c[2]);
+    zv_[k] = -(S(2, 0) * c[0] + S(2, 1) * c[1] + S(2, 2) * c[2]);
+    if (fill_covariances) {
+      covv_[k] = S;
     }
-
-    if ((nt > 1) && (rho_vtx > 1.0)) {
-      delta_x = std::max(delta_x, std::abs(xv_[k] - xold));
-      delta_y = std::max(delta_y, std::abs(yv_[k] - yold));
-      delta_z = std::max(delta_z, std::abs(zv_[k] - zold));
+  } else {
+    edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter") << "update()   Matrix inversion failed" << S << std::endl;
+    if (fill_covariances) {
+      Error3 covv_dummy;
+      covv_dummy(0, 0) = 100.;
+      covv_dummy(1, 1) = 100.;
+      covv_dummy(2, 2) = 100.;
+      covv_[k] = covv_dummy;
     }
+  }
 
+  return {rho_vtx, std::abs(xv_[k] - xold), std::abs(yv_[k] - yold), std::abs(zv_[k] - zold)};
+}
+
+double AdaptiveChisquarePrimaryVertexFitter::update(const reco::BeamSpot &beamspot,
+                                                    const float beam_weight,
+                                                    const bool fill_covariances) {
+  double delta_z = 0;
+  double delta_x = 0;
+  double delta_y = 0;
+  unsigned const int nt = trackinfo_.size();
+  unsigned const int nv = xv_.size();
+  if (fill_covariances) {
+    covv_.resize(nv);
+  }
+
+  Error3 S0;
+  double c_beam[3];
+  beam_constraint(beamspot, beam_weight, S0, c_beam);
+
+  for (unsigned int k = 0; k < nv; k++) {
+    const auto u = update_vertex(k, S0, c_beam, fill_covariances);
+    if ((nt > 1) && (u.rho > 1.0)) {
+      delta_x = std::max(delta_x, u.dx);
+      delta_y = std::max(delta_y, u.dy);
+      delta_z = std::max(delta_z, u.dz);
+    }
   }  // vertex loop
 
   return std::max(delta_z, std::max(delta_x, delta_y));
@@ -344,8 +414,10 @@ TransientVertex AdaptiveChisquarePrimaryVertexFitter::get_TransientVertex(
     const unsigned int k,
     const std::vector<std::pair<unsigned int, float>> &vertex_track_weights,
     const std::vector<reco::TransientTrack> &tracks,
+    const unsigned int first,
     const float beam_weight,
     const reco::BeamSpot &beamspot) {
+  // track indices in vertex_track_weights refer to the track information, tracks[i - first] is the i-th track
   const GlobalPoint pos(xv_[k], yv_[k], zv_[k]);
   const GlobalError posError(
       covv_[k](0, 0), covv_[k](1, 0), covv_[k](1, 1), covv_[k](2, 0), covv_[k](2, 1), covv_[k](2, 2));
@@ -368,10 +440,10 @@ TransientVertex AdaptiveChisquarePrimaryVertexFitter::get_TransientVertex(
     const unsigned int i = tk.first;
     const float track_weight = tk.second;
     if (track_weight >= min_trackweight_) {
-      vertex_tracks.emplace_back(tracks[i]);
-      trkWeightMap[tracks[i]] = track_weight;
+      vertex_tracks.emplace_back(tracks[i - first]);
+      trkWeightMap[tracks[i - first]] = track_weight;
       vtx_ndof += 2 * track_weight;
-      chi2 += track_weight * track_in_vertex_chsq(trackinfo_[i], xv_[k], yv_[k], zv_[k]);
+      chi2 += track_weight * track_in_vertex_chsq(i, xv_[k], yv_[k], zv_[k]);
     }
   }
 
@@ -465,61 +537,94 @@ std::vector<TransientVertex> AdaptiveChisquarePrimaryVertexFitter::vertices(
         vertex_tracks_weights.emplace_back(tkmap_[j], tkweight_[j]);
       }
     }
-    pvs.emplace_back(get_TransientVertex(k, vertex_tracks_weights, tracks, beam_weight, beamspot));
+    pvs.emplace_back(get_TransientVertex(k, vertex_tracks_weights, tracks, 0, beam_weight, beamspot));
   }
 
   return pvs;
 }
 
-TransientVertex AdaptiveChisquarePrimaryVertexFitter::refit(const TransientVertex &cluster,
-                                                            const reco::BeamSpot &beamspot,
-                                                            const bool useBeamConstraint) {
-  // fit a single vertex using all tracks in the tracklist
-  const unsigned int nt = cluster.originalTracks().size();
+std::vector<TransientVertex> AdaptiveChisquarePrimaryVertexFitter::refit_all(
+    const std::vector<TransientVertex> &clusters, const reco::BeamSpot &beamspot, const bool useBeamConstraint) {
+  // fit each cluster as a single vertex using all tracks in its tracklist
+  // all clusters are fitted in one pass: the tracks of cluster k are linearized once into the
+  // contiguous slice tkfirstv_[k] .. tkfirstv_[k+1]-1 of the track arrays (identity track map),
+  // and every vertex iterates until its own convergence
   const int max_iterations = 50;
 
-  // initialize, vectors with size=1 here to avoid code duplication from the multivertex case in update()
-  const double zclu = cluster.position().z();
-  xv_ = {beamspot.x(zclu)};
-  yv_ = {beamspot.y(zclu)};
-  zv_ = {zclu};
-  tkfirstv_ = {0, nt};
+  xv_.clear();
+  yv_.clear();
+  zv_.clear();
+  tkfirstv_.clear();
   covv_.clear();
+  trackinfo_.clear();
 
-  fill_trackinfo(cluster.originalTracks(), beamspot);
+  std::vector<const TransientVertex *> fitted;
+  fitted.reserve(clusters.size());
+  tkfirstv_.emplace_back(0);
+  for (auto &cluster : clusters) {
+    if (cluster.originalTracks().size() > (useBeamConstraint ? 0 : 1)) {
+      const double zclu = cluster.position().z();
+      xv_.emplace_back(beamspot.x(zclu));
+      yv_.emplace_back(beamspot.y(zclu));
+      zv_.emplace_back(zclu);
+      fill_trackinfo(cluster.originalTracks(), beamspot, tkfirstv_.back());
+      tkfirstv_.emplace_back(trackinfo_.size());
+      fitted.emplace_back(&cluster);
+    }
+  }
+
+  const unsigned int nv = xv_.size();
+  const unsigned int nt = trackinfo_.size();
   tkweight_.assign(nt, 0.);
-  tkmap_.clear();
-  tkmap_.reserve(nt);
+  tkmap_.resize(nt);
   for (unsigned int i = 0; i < nt; i++) {
-    tkmap_.emplace_back(i);  // trivial map for single vertex fits
+    tkmap_[i] = i;  // trivial map for single vertex fits
   }
+  covv_.resize(nv);
 
   float beam_weight = useBeamConstraint ? 1. : 0.;
+  Error3 S0;
+  double c_beam[3];
+  beam_constraint(beamspot, beam_weight, S0, c_beam);
 
-  double delta = 0;
-  unsigned int nit = 0;
-  while ((nit == 0) || ((delta > 0.0001) && (nit < max_iterations))) {
-    fill_weights(beamspot);
-    delta = update(beamspot, beam_weight, false);
-    nit++;
-  }
+  for (unsigned int k = 0; k < nv; k++) {
+    const unsigned int ntk = tkfirstv_[k + 1] - tkfirstv_[k];
+    double delta = 0;
+    unsigned int nit = 0;
+    while ((nit == 0) || ((delta > 0.0001) && (nit < max_iterations))) {
+      fill_weights_exclusive(k);
+      const auto u = update_vertex(k, S0, c_beam, false);
+      delta = ((ntk > 1) && (u.rho > 1.0)) ? std::max(u.dz, std::max(u.dx, u.dy)) : 0;
+      nit++;
+    }
 
-  if ((nit >= max_iterations) && (delta > 0.1)) {
-    edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter")
-        << "single vertex fit, iteration limit reached " << nit << "  last delta = " << delta << std::endl
-        << "    nt = " << cluster.originalTracks().size() << std::endl;
-  }
+    if ((nit >= max_iterations) && (delta > 0.1)) {
+      edm::LogWarning("AdaptiveChisquarePrimaryVertexFitter")
+          << "single vertex fit, iteration limit reached " << nit << "  last delta = " << delta << std::endl
+          << "    nt = " << ntk << std::endl;
+    }
 
-  // fill the covariance matrices
-  update(beamspot, beam_weight, true);
+    // fill the covariance matrix
+    update_vertex(k, S0, c_beam, true);
+  }
 
-  // put the result into a transient vertex
-  std::vector<std::pair<unsigned int, float>> vertex_track_weights;
-  for (unsigned int i = 0; i < nt; i++) {
-    vertex_track_weights.emplace_back(i, tkweight_[i]);
+  // put the results into transient vertices
+  std::vector<TransientVertex> pvs;
+  pvs.reserve(nv);
+  for (unsigned int k = 0; k < nv; k++) {
+    std::vector<std::pair<unsigned int, float>> vertex_track_weights;
+    vertex_track_weights.reserve(tkfirstv_[k + 1] - tkfirstv_[k]);
+    for (unsigned int i = tkfirstv_[k]; i < tkfirstv_[k + 1]; i++) {
+      vertex_track_weights.emplace_back(i, tkweight_[i]);
+    }
+    auto pv =
+        get_TransientVertex(k, vertex_track_weights, fitted[k]->originalTracks(), tkfirstv_[k], beam_weight, beamspot);
+    if (pv.isValid()) {
+      pvs.emplace_back(pv);
+    }
   }
 
-  return get_TransientVertex(0, vertex_track_weights, cluster.originalTracks(), beam_weight, beamspot);
+  return pvs;
 }
 
 //
@@ -531,17 +636,7 @@ std::vector<TransientVertex> AdaptiveChisquarePrimaryVertexFitter::fit(const std
     return vertices(tracks, clusters, beamspot, useBeamConstraint);
 
   } else {
-    // fit the clusters one-by-one using the tracklist of the clusters (ignores the "tracks" argument)
-    std::vector<TransientVertex> pvs;
-    pvs.reserve(clusters.size());
-    for (auto &cluster : clusters) {
-      if (cluster.originalTracks().size() > (useBeamConstraint ? 0 : 1)) {
-        auto pv = refit(cluster, beamspot, useBeamConstraint);
-        if (pv.isValid()) {
-          pvs.emplace_back(pv);
-        }
-      }
-    }
-    return pvs;
+    // fit the clusters independently using the tracklist of the clusters (ignores the "tracks" argument)
+    return refit_all(clusters, beamspot, useBeamConstraint);
   }
 }
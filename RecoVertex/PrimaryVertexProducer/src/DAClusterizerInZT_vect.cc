@@ -11,6 +11,8 @@
 #include "FWCore/Utilities/interface/isFinite.h"
 #include "vdt/vdtMath.h"
 
+#include "oneapi/tbb/parallel_for.h"
+
 using namespace std;
 
 //#define DEBUG
@@ -48,6 +50,9 @@ DAClusterizerInZT_vect::DAClusterizerInZT_vect(const edm::ParameterSet& conf) {
   convergence_mode_ = conf.getParameter<int>("convergence_mode");
   delta_lowT_ = conf.getParameter<double>("delta_lowT");
   delta_highT_ = conf.getParameter<double>("delta_highT");
+  runInBlocks_ = conf.getParameter<bool>("runInBlocks");
+  block_size_ = conf.getParameter<unsigned int>("block_size");
+  overlap_frac_ = conf.getParameter<double>("overlap_frac");
 
 #ifdef DEBUG
   std::cout << "DAClusterizerInZT_vect: mintrkweight = " << mintrkweight_ << std::endl;
@@ -68,6 +73,9 @@ DAClusterizerInZT_vect::DAClusterizerInZT_vect(const edm::ParameterSet& conf) {
   std::cout << "DAClusterizerinZT_vect: convergence mode = " << convergence_mode_ << std::endl;
   std::cout << "DAClusterizerinZT_vect: delta_highT = " << delta_highT_ << std::endl;
   std::cout << "DAClusterizerinZT_vect: delta_lowT = " << delta_lowT_ << std::endl;
+  std::cout << "DAClusterizerinZT_vect: run in blocks = " << runInBlocks_ << std::endl;
+  std::cout << "DAClusterizerinZT_vect: block_size = " << block_size_ << std::endl;
+  std::cout << "DAClusterizerinZT_vect: overlap_fraction = " << overlap_frac_ << std::endl;
   std::cout << "DAClusterizerinZT_vect: DEBUGLEVEL " << DEBUGLEVEL << std::endl;
 #endif
 
@@ -1111,18 +1119,27 @@ bool DAClusterizerInZT_vect::split(const double beta, track_t& tks, vertex_t& y,
   return split;
 }
 
-vector<TransientVertex> DAClusterizerInZT_vect::vertices(const vector<reco::TransientTrack>& tracks) const {
+vector<TransientVertex> DAClusterizerInZT_vect::vertices_no_blocks(const vector<reco::TransientTrack>& tracks) const {
   track_t&& tks = fill(tracks);
   vector<TransientVertex> clusters;
   if (tks.getSize() == 0)
     return clusters;
   tks.extractRaw();
 
-  unsigned int nt = tks.getSize();
   double rho0 = 0.0;  // start with no outlier rejection
 
   vertex_t y;  // the vertex prototypes
 
+  double beta = anneal(tks, y, rho0);
+
+  // assign tracks and fill into transient vertices
+  return fill_vertices(beta, rho0, tks, y);
+}
+
+double DAClusterizerInZT_vect::anneal(track_t& tks, vertex_t& y, double& rho0) const {
+  // deterministic annealing of the tracks tks into the vertex prototypes y, returns the final beta
+  const unsigned int nt = tks.getSize();
+
   // initialize:single vertex at infinite temperature
   y.addItem(0, 0, 1.0);
   clear_vtx_range(tks, y);
@@ -1299,7 +1316,102 @@ vector<TransientVertex> DAClusterizerInZT_vect::vertices(const vector<reco::Tran
   while (merge(y, tks, betadummy))
     ;
 
+  return beta;
+}
+
+vector<TransientVertex> DAClusterizerInZT_vect::vertices_in_blocks(const vector<reco::TransientTrack>& tracks) const {
+  vector<reco::TransientTrack> sorted_tracks(tracks);
+  std::sort(sorted_tracks.begin(),
+            sorted_tracks.end(),
+            [](const reco::TransientTrack& a, const reco::TransientTrack& b) -> bool {
+              return (a.stateAtBeamLine().trackStateAtPCA()).position().z() <
+                     (b.stateAtBeamLine().trackStateAtPCA()).position().z();
+            });
+
+  unsigned int nBlocks = (unsigned int)std::floor(sorted_tracks.size() / (block_size_ * (1 - overlap_frac_)));
+  if (nBlocks < 1) {
+    nBlocks = 1;
+    edm::LogWarning("DAClusterizerinZT_vect")
+        << "Warning nBlocks was 0 with ntracks = " << sorted_tracks.size() << " block_size = " << block_size_
+        << " and overlap fraction = " << overlap_frac_ << ". Setting nBlocks = 1";
+  }
+
+  // the blocks are annealed independently of each other, in parallel
+  vector<vertex_t> block_vertices(nBlocks);
+  vector<double> block_beta(nBlocks, 0.);
+  vector<unsigned int> block_nt(nBlocks, 0);
+  tbb::parallel_for(0U, nBlocks, [&](unsigned int block) {
+    unsigned int begin = (unsigned int)(block * block_size_ * (1 - overlap_frac_));
+    unsigned int end = (unsigned int)std::min(begin + block_size_, (unsigned int)sorted_tracks.size());
+    if (begin >= end) {
+      return;
+    }
+    vector<reco::TransientTrack> block_tracks(sorted_tracks.begin() + begin, sorted_tracks.begin() + end);
+
+#ifdef DEBUG
+    std::cout << "Running vertices_in_blocks on" << std::endl;
+    std::cout << "- block no." << block << " on " << nBlocks << " blocks " << std::endl;
+    std::cout << "- block track size: " << block_tracks.size() << " - block size: " << block_size_ << std::endl;
+#endif
+    track_t&& tks = fill(block_tracks);
+    if (tks.getSize() == 0) {
+      return;
+    }
+    tks.extractRaw();
+
+    double rho0 = 0.0;  // start with no outlier rejection
+    block_beta[block] = anneal(tks, block_vertices[block], rho0);
+    block_nt[block] = tks.getSize();
+  });
+
+  // collect the prototypes of all blocks, the vertex "masses" are normalized to the full track list
+  track_t&& tks = fill(tracks);
+  vector<TransientVertex> clusters;
+  const unsigned int nt = tks.getSize();
+  if (nt == 0)
+    return clusters;
+  tks.extractRaw();
+
+  unsigned int nt_blocks = 0;
+  double beta = 0;
+  for (unsigned int block = 0; block < nBlocks; block++) {
+    nt_blocks += block_nt[block];
+    beta = std::max(beta, block_beta[block]);
+  }
+
+  vertex_t y;
+  for (unsigned int block = 0; block < nBlocks; block++) {
+    const auto& yb = block_vertices[block];
+    for (unsigned int k = 0; k < yb.getSize(); k++) {
+      if ((yb.rho_vec[k] > 0) && !edm::isNotFinite(yb.rho_vec[k]) && !edm::isNotFinite(yb.zvtx_vec[k])) {
+        y.addItem(yb.zvtx_vec[k], yb.tvtx_vec[k], yb.rho_vec[k] * block_nt[block] / nt_blocks);
+      }
+    }
+  }
+  if (y.getSize() == 0)
+    return clusters;
+
+  // merge prototypes found twice in the overlap of adjacent blocks
+  zorder(y);
+  clear_vtx_range(tks, y);
+  set_vtx_range(beta, tks, y);
+  double betadummy = 1;
+  while (merge(y, tks, betadummy))
+    ;
+
+  double rho0 = (dzCutOff_ > 0) ? 1. / nt : 0.;
+
+  // assign tracks and fill into transient vertices
+  return fill_vertices(beta, rho0, tks, y);
+}
+
+vector<TransientVertex> DAClusterizerInZT_vect::fill_vertices(double beta,
+                                                              double rho0,
+                                                              track_t& tks,
+                                                              vertex_t& y) const {
   // select significant tracks and use a TransientVertex as a container
+  vector<TransientVertex> clusters;
+  const unsigned int nt = tks.getSize();
   zorder(y);
   set_vtx_range(beta, tks, y);
   const unsigned int nv = y.getSize();
@@ -1353,6 +1465,13 @@ vector<TransientVertex> DAClusterizerInZT_vect::vertices(const vector<reco::Tran
   return clusters;
 }
 
+vector<TransientVertex> DAClusterizerInZT_vect::vertices(const vector<reco::TransientTrack>& tracks) const {
+  if (runInBlocks_ and (block_size_ < tracks.size()))  //doesn't bother if low number of tracks
+    return vertices_in_blocks(tracks);
+  else
+    return vertices_no_blocks(tracks);
+}
+
 vector<vector<reco::TransientTrack> > DAClusterizerInZT_vect::clusterize(
     const vector<reco::TransientTrack>& tracks) const {
   vector<vector<reco::TransientTrack> > clusters;
@@ -9,9 +9,23 @@ public:
   using pointer = typename std::allocator_traits<std::allocator<T>>::pointer;
   using size_type = typename Base::size_type;
 
+  // Per-thread free list of single-object blocks: states are created and released in bursts
+  // during propagation and fitting, so several of them are typically alive at the same time.
+  // The cached blocks are released at thread exit.
   struct Cache {
-    pointer cache = nullptr;
-    bool gard = false;
+    static constexpr unsigned int capacity = 32;
+    pointer blocks[capacity];
+    unsigned int size = 0;
+
+    Cache() = default;
+    Cache(Cache const &) = delete;
+    Cache &operator=(Cache const &) = delete;
+    ~Cache() {
+      std::allocator<T> allocator;
+      for (unsigned int i = 0; i < size; ++i)
+        allocator.deallocate(blocks[i], 1);
+      size = 0;
+    }
   };
 
   static Cache &cache() {
@@ -26,16 +40,15 @@ public:
 
   pointer allocate(size_type n) {
     Cache &c = cache();
-    if (!c.gard)
-      c.cache = std::allocator<T>::allocate(n);
-    c.gard = false;
-    return c.cache;
+    if (n == 1 && c.size > 0)
+      return c.blocks[--c.size];
+    return std::allocator<T>::allocate(n);
   }
 
   void deallocate(pointer p, size_type n) {
     Cache &c = cache();
-    if (p == c.cache)
-      c.gard = true;
+    if (n == 1 && c.size < Cache::capacity)
+      c.blocks[c.size++] = p;
     else
       std::allocator<T>::deallocate(p, n);
   }
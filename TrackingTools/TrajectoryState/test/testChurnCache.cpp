@@ -0,0 +1,94 @@
+#include "TrackingTools/TrajectoryState/interface/ChurnAllocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <set>
+#include <thread>
+#include <vector>
+
+// count the blocks allocated with the global operator new, to check that the cached ones are reused and released
+namespace {
+  std::atomic<long> live = 0;
+}
+
+void *operator new(std::size_t n) {
+  void *p = std::malloc(n);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  ++live;
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  if (p == nullptr)
+    return;
+  --live;
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept { operator delete(p); }
+
+struct State {
+  explicit State(double v) {
+    for (auto &x : par)
+      x = v;
+  }
+  double par[15];
+};
+
+using PS = std::shared_ptr<State>;
+
+int main() {
+  bool ok = true;
+  const long before = live;
+
+  std::thread thread([&ok] {
+    std::vector<PS> states;
+    states.reserve(64);
+
+    // several states alive at the same time on one thread
+    std::set<State *> addresses;
+    for (int i = 0; i < 5; ++i) {
+      states.push_back(std::allocate_shared<State>(churn_allocator<State>(), i));
+      addresses.insert(states.back().get());
+    }
+    states.clear();
+
+    // once released, their blocks are reused without new allocations
+    const long cached = live;
+    for (int i = 0; i < 5; ++i) {
+      states.push_back(std::allocate_shared<State>(churn_allocator<State>(), i));
+      if (addresses.count(states.back().get()) == 0) {
+        std::cerr << "error: a cached block was not reused" << std::endl;
+        ok = false;
+      }
+    }
+    if (live != cached) {
+      std::cerr << "error: " << live - cached << " blocks allocated instead of reusing the cached ones" << std::endl;
+      ok = false;
+    }
+    states.clear();
+
+    // more states than the capacity of the cache: the blocks in excess are freed when released
+    for (int i = 0; i < 40; ++i)
+      states.push_back(std::allocate_shared<State>(churn_allocator<State>(), i));
+    const long all = live;
+    states.clear();
+    if (all - live != 40 - 32) {
+      std::cerr << "error: " << all - live << " blocks freed instead of " << 40 - 32 << std::endl;
+      ok = false;
+    }
+  });
+  thread.join();
+
+  // the blocks cached by the thread are released when it exits
+  if (live != before) {
+    std::cerr << "error: " << live - before << " blocks still allocated after the end of the thread" << std::endl;
+    ok = false;
+  }
+
+  return ok ? 0 : 1;
+}